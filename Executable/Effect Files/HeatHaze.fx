@@ -8,6 +8,7 @@ cbuffer cbPerObject
 {
 	float4x4 Orthogonal;
 	float time;
+	float2 perturbanceScale;	// Screen size over perturbance tile size
 };
 
 cbuffer cbFixed 
@@ -59,7 +60,7 @@ VS_OUT HazeVS(VS_IN vIn)
 
 float4 HazePS(VS_OUT pIn) : SV_Target 
 {
-	float4 distortion = perturbanceTexture.Sample(NoiseSample, pIn.texCoord + cos(time * 3.14159265358979323846f));
+	float4 distortion = perturbanceTexture.Sample(NoiseSample, (pIn.texCoord + cos(time * 3.14159265358979323846f)) * perturbanceScale);
 	distortion = normalize(distortion) * distortionFactor;
 	
 	float4 refract = screenTexture.Sample(SceneSample, pIn.texCoord + distortion.xy * 0.5f);
@@ -37,6 +37,15 @@ cbuffer cbHeatHaze
 	float hazeRange = 500.0f;	
 };
 
+// Unpacks compact vertices, set by the application
+cbuffer cbCompactGrid
+{
+	uint  gridWidth;
+	float heightMin;
+	float heightRange;
+	uint  vertexBase;	// Base vertex of the draw, which SV_VertexID leaves out
+};
+
 SamplerState TriLinearSample
 {
 	Filter = MIN_MAG_MIP_LINEAR;
@@ -56,14 +65,27 @@ cbuffer TextureColours
 	float4 lava		= {1.0f,  0.2f,  0.0f,  1.0f};
 };
 
+// The terrain's vertices come from three streams, the fixed grid position and
+// texture coordinates, the animated height and normal, and the material
 struct VS_IN
 {
-	float3 posL		: POSITION;
-	float3 normalL	: NORMAL;
+	float2 posXZ	: POSITION;
 	float2 texC		: TEXCOORD;
+	float  height	: HEIGHT;
+	float3 normalL	: NORMAL;
 	uint   type     : TYPE;
 };
 
+// Compact vertices hold only a quantized height, an octahedral normal and the
+// material, the grid position comes from the vertex ID
+struct VS_COMPACT_IN
+{
+	float  height	: HEIGHT;
+	float2 normalL	: NORMAL;
+	uint   type		: TYPE;
+	uint   vertexID	: SV_VertexID;
+};
+
 struct VS_OUT
 {
 	float4 posH			: SV_POSITION;
@@ -75,20 +97,21 @@ struct VS_OUT
 	float3 cameraView	: VIEW;
 };
  
-VS_OUT VS(VS_IN vIn)
+// Lights, fogs and hazes a vertex given in local space
+VS_OUT shadeVertex(float3 posL, float3 normalL, float2 texC, uint type)
 {
 	VS_OUT vOut;
 	
 	// Transform to world space space
-	vOut.normalW = mul(vIn.normalL, World);
+	vOut.normalW = mul(normalL, World);
 
 	// Transform to homogeneous clip space
-	vOut.posH = mul(float4(vIn.posL, 1.0f), Wvp);
+	vOut.posH = mul(float4(posL, 1.0f), Wvp);
 
-	vOut.texC = vIn.texC;
+	vOut.texC = texC;
 
 	// Fog
-	float3 posW	= mul(vIn.posL, World);
+	float3 posW	= mul(posL, World);
 	float d = distance(posW, cameraPos);
 	vOut.fogLerp = saturate((d - fogStart) / fogRange);
 
@@ -96,14 +119,12 @@ VS_OUT VS(VS_IN vIn)
 	vOut.hazeLerp = saturate((d - hazeStart) / hazeRange);
 
 	[branch]
-	if (vIn.type == LAVA)
+	if (type == LAVA)
 	{
 		vOut.hazeLerp = saturate(vOut.hazeLerp + 0.5f);
 	}
 	
-	vOut.type = vIn.type;
-
-	
+	vOut.type = type;
 
 	// Find the camera view vector
 	vOut.cameraView = normalize(cameraPos - posW);
@@ -111,6 +132,32 @@ VS_OUT VS(VS_IN vIn)
 	return vOut;
 }
 
+VS_OUT VS(VS_IN vIn)
+{
+	float3 posL = float3(vIn.posXZ.x, vIn.height, vIn.posXZ.y);
+	return shadeVertex(posL, vIn.normalL, vIn.texC, vIn.type);
+}
+
+// Undoes the octahedral encoding of a normal with y as its pole
+float3 decodeOctahedral(float2 e)
+{
+	float3 n = float3(e.x, 1.0f - abs(e.x) - abs(e.y), e.y);
+	if (n.y < 0.0f)
+	{
+		n.xz = (1.0f - abs(n.zx)) * (n.xz >= 0.0f ? 1.0f : -1.0f);
+	}
+	return normalize(n);
+}
+
+VS_OUT CompactVS(VS_COMPACT_IN vIn)
+{
+	// Vertex (i, j) of the grid sits at (i, height, j)
+	uint vertex = vertexBase + vIn.vertexID;
+	float2 posXZ = float2(vertex / gridWidth, vertex % gridWidth);
+	float3 posL = float3(posXZ.x, heightMin + vIn.height * heightRange, posXZ.y);
+	return shadeVertex(posL, decodeOctahedral(vIn.normalL), posXZ / 128.0f, vIn.type);
+}
+
 float4 PS(VS_OUT pIn) : SV_Target
 {
 	float4 colour = rock * turbulence(float3(pIn.texC.x, pIn.texC.y, 0)*2, 10);
@@ -140,3 +187,13 @@ technique10 TexTech
         SetPixelShader( CompileShader( ps_4_0, PS() ) );
     }
 }
+
+technique10 CompactTexTech
+{
+    pass P0
+    {
+		SetVertexShader( CompileShader( vs_4_0, CompactVS() ) );
+        SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_4_0, PS() ) );
+    }
+}
@@ -0,0 +1,842 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Heightfield
+	Brief		Definition of Heightfield Class
+*/
+
+#include <cmath>
+#include <cstring>
+
+#include "Geometry/Heightfield.hpp"
+#include "Geometry/HeightfieldFile.hpp"
+#include "Utilities/NoiseField.hpp"
+#include "Utilities/SimplexNoiseGenerator.hpp"
+
+namespace
+{
+	// The value D3DX_PI has, so results match the Direct3D build
+	const float PI = 3.141592654f;
+
+	// The mounds stacked to make the mountain
+	const int MOUNDS = 30;
+
+	// Height of the noise layer's ridges and depth of a lava flow's channel
+	const float NOISE_HEIGHT = 35.0f;
+	const float LAVA_FLOW_DEPTH = 15.0f;
+
+	// Work done by each slice of a stage run a slice at a time
+	const int SLICE_ROWS = 32;
+	const int SLICE_COLUMNS = 32;
+	const int SLICE_NOISE_TILES = 2;
+	const int SLICE_FLOW_STEPS = 256;
+}
+
+/*
+	Name		Heightfield::Heightfield
+	Syntax		Heightfield()
+	Brief		Heightfield constructor
+*/
+Heightfield::Heightfield()
+: size_(0),
+  craterX_(0),
+  craterZ_(0),
+  craterRadius_(0),
+  peakHeight_(0),
+  seed_(Random::DEFAULT_SEED),
+  generation_(0),
+  random_(Random::DEFAULT_SEED),
+  noiseCache_(&ownNoiseCache_)
+{
+
+}
+
+/*
+	Name		Heightfield::initialise
+	Syntax		Heightfield::initialise(int size)
+	Param		int size - The number of vertices along each side
+	Brief		Creates a flat, all rock heightfield
+*/
+void Heightfield::initialise(int size)
+{
+	size_ = size > 0 ? size : 0;
+	heights_.assign(size_ * size_, 0.0f);
+	types_.assign(size_ * size_, ROCK);
+	lavaPoints_.clear();
+	dirtyRegions_.clear();
+	noise_.reset();
+
+	craterX_ = craterZ_ = craterRadius_ = peakHeight_ = 0.0f;
+	random_.setSeed(seed_, generation_);
+}
+
+/*
+	Name		Heightfield::reset
+	Syntax		Heightfield::reset()
+	Brief		Flattens the heightfield ready to generate a new volcano. Each reset
+				draws from the seed's next stream, so a new volcano is built but the
+				sequence of volcanoes is the same every run.
+*/
+void Heightfield::reset()
+{
+	++generation_;
+	initialise(size_);
+}
+
+/*
+	Name		Heightfield::load
+	Syntax		Heightfield::load(const HeightfieldFile& file)
+	Param		const HeightfieldFile& file - An open baked volcano
+	Brief		Takes the completed volcano in the file instead of generating it. The
+				seed is the file's, so resets go on to the volcanoes that follow it.
+*/
+void Heightfield::load(const HeightfieldFile& file)
+{
+	setSeed(file.getSeed());
+	initialise(file.getSize());
+
+	int count = size_ * size_;
+	memcpy(&heights_[0], file.getHeights(), count * sizeof(float));
+	memcpy(&types_[0], file.getTypes(), count * sizeof(unsigned int));
+	for (int i = 0; i < count; ++i)
+	{
+		if (types_[i] == LAVA)
+			addLavaPoint(i);
+	}
+
+	craterX_ = file.getCraterX();
+	craterZ_ = file.getCraterZ();
+	craterRadius_ = file.getCraterRadius();
+	peakHeight_ = file.getPeakHeight();
+
+	addDirtyRegion(0, size_ - 1, 0, size_ - 1);
+}
+
+/*
+	Name		Heightfield::setSeed
+	Syntax		Heightfield::setSeed(unsigned int seed, unsigned int stream)
+	Param		unsigned int seed - The seed for the random mountain, lava flows and emitters
+	Param		unsigned int stream - The seed's stream to draw from, the number of resets
+				since the seed was set
+	Brief		Sets the seed used from the next generation stage on
+*/
+void Heightfield::setSeed(unsigned int seed, unsigned int stream)
+{
+	seed_ = seed;
+	generation_ = stream;
+	random_.setSeed(seed_, generation_);
+}
+
+/*
+	Name		Heightfield::setNoiseCache
+	Syntax		Heightfield::setNoiseCache(SimplexNoise::NoiseFieldCache* cache)
+	Param		SimplexNoise::NoiseFieldCache* cache - Cache to share with other
+				heightfields, or 0 to go back to this heightfield's own
+	Brief		Lets heightfields generated side by side build the noise layer once
+*/
+void Heightfield::setNoiseCache(SimplexNoise::NoiseFieldCache* cache)
+{
+	noiseCache_ = cache ? cache : &ownNoiseCache_;
+}
+
+/*
+	Name		Heightfield::getHeightBounds
+	Syntax		Heightfield::getHeightBounds(int size, float& minHeight, float& maxHeight)
+	Param		int size - The number of vertices along each side
+	Param		float& minHeight - Receives the lowest height a volcano of this size
+				can reach, whatever its seed
+	Param		float& maxHeight - Receives the highest
+	Brief		Mounds and the crater grow with the size, so the range does too. The
+				bounds assume every mound is as big as it can be and centred on the
+				same vertex, and every lava flow cuts through the crater's centre, so
+				they are well outside any real volcano.
+*/
+void Heightfield::getHeightBounds(int size, float& minHeight, float& maxHeight)
+{
+	// A mound adds up to a quarter of its radius, the noise layer up to its
+	// height and never takes any away
+	float maxRadius = (float)(size/6 + size/18);
+	maxHeight = MOUNDS * maxRadius / 4.0f + NOISE_HEIGHT;
+
+	// The crater takes up to its radius and each flow up to 1.8 of its depth
+	minHeight = -(size / 12.0f) - LAVA_FLOWS * 1.8f * LAVA_FLOW_DEPTH;
+}
+
+/*
+	Name		Heightfield::generate
+	Syntax		Heightfield::generate(WorkerPool* pool)
+	Param		WorkerPool* pool - Pool to generate the noise layer on, or 0 to run serially
+	Brief		Runs every generation stage, leaving a completed volcano. With a pool
+				the noise layer is fetched alongside the mountain.
+*/
+void Heightfield::generate(WorkerPool* pool)
+{
+	TaskGraph graph(pool);
+	addStages(graph);
+	graph.runAll();
+}
+
+/*
+	Name		Heightfield::addStages
+	Syntax		Heightfield::addStages(TaskGraph& graph)
+	Param		TaskGraph& graph - The graph to add the generation stages to. Its pool
+				is used for the noise layer.
+	Return		Stages - The nodes added
+	Brief		Adds every generation stage to the graph, each declaring what it reads
+				and writes. The noise layer is fetched as soon as the graph starts
+				it and added once the crater has been cut, so the volcano is the
+				same as when the stages run one after another.
+*/
+Heightfield::Stages Heightfield::addStages(TaskGraph& graph)
+{
+	Stages stages;
+	stages.mountain = addStage(graph, HEIGHTFIELD_STAGE_MOUNTAIN);
+	stages.noiseField = addStage(graph, HEIGHTFIELD_STAGE_NOISE_FIELD);
+	stages.crater = addStage(graph, HEIGHTFIELD_STAGE_CRATER);
+	stages.noiseLayer = addStage(graph, HEIGHTFIELD_STAGE_NOISE_LAYER);
+	for (int i = 0; i < LAVA_FLOWS; ++i)
+	{
+		stages.lavaFlows[i] = addStage(graph, HEIGHTFIELD_STAGE_LAVA_FLOW);
+	}
+	return stages;
+}
+
+/*
+	Name		Heightfield::addStage
+	Syntax		Heightfield::addStage(TaskGraph& graph, HeightfieldStage stage)
+	Param		TaskGraph& graph - The graph to add the stage to
+	Param		HeightfieldStage stage - The stage
+	Return		TaskGraph::Node - The node added
+	Brief		Adds one generation stage to the graph, so owners can add nodes of
+				their own between the stages. Stages must be added in the order
+				addStages adds them. The mountain and lava flows stop at their next
+				yield if the graph is cancelled while they run.
+*/
+TaskGraph::Node Heightfield::addStage(TaskGraph& graph, HeightfieldStage stage)
+{
+	WorkerPool* pool = graph.getPool();
+	const std::atomic<bool>* isCancelled = &graph.getCancelled();
+
+	switch (stage)
+	{
+	case HEIGHTFIELD_STAGE_MOUNTAIN:
+		return graph.addNode("mountain", HEIGHTFIELD_HEIGHTS | HEIGHTFIELD_RANDOM,
+			HEIGHTFIELD_HEIGHTS | HEIGHTFIELD_RANDOM | HEIGHTFIELD_DIRTY_REGIONS,
+			[this, isCancelled] { generateMountainTask().run(*isCancelled); });
+	case HEIGHTFIELD_STAGE_NOISE_FIELD:
+		return graph.addNode("noise field", 0, HEIGHTFIELD_NOISE,
+			[this, pool] { prepareNoise(pool); });
+	case HEIGHTFIELD_STAGE_CRATER:
+		return graph.addNode("crater", HEIGHTFIELD_HEIGHTS,
+			HEIGHTFIELD_HEIGHTS | HEIGHTFIELD_TYPES | HEIGHTFIELD_CRATER | HEIGHTFIELD_DIRTY_REGIONS,
+			[this] { generateCrater(); });
+	case HEIGHTFIELD_STAGE_NOISE_LAYER:
+		return graph.addNode("noise layer", HEIGHTFIELD_HEIGHTS | HEIGHTFIELD_NOISE,
+			HEIGHTFIELD_HEIGHTS | HEIGHTFIELD_NOISE | HEIGHTFIELD_DIRTY_REGIONS,
+			[this] { applyNoise(); });
+	case HEIGHTFIELD_STAGE_LAVA_FLOW:
+	default:
+		return graph.addNode("lava flow",
+			HEIGHTFIELD_HEIGHTS | HEIGHTFIELD_TYPES | HEIGHTFIELD_CRATER | HEIGHTFIELD_RANDOM,
+			HEIGHTFIELD_HEIGHTS | HEIGHTFIELD_TYPES | HEIGHTFIELD_RANDOM | HEIGHTFIELD_DIRTY_REGIONS,
+			[this, isCancelled] { generateLavaFlowTask().run(*isCancelled); });
+	}
+}
+
+/*
+	Name		Heightfield::sliceStage
+	Syntax		Heightfield::sliceStage(HeightfieldStage stage)
+	Param		HeightfieldStage stage - The stage
+	Return		SliceScheduler::Slice - The stage in a form that does a bounded part of
+				its work each call: a band of a mound's columns, a band of rows, a few
+				noise tiles or a stretch of a lava flow
+	Brief		Lets a caller run a stage across many frames on its own thread. The
+				slices must be run in the order the stages are built, like the nodes
+				addStage adds, and the volcano is the same as when each stage runs
+				at once.
+*/
+SliceScheduler::Slice Heightfield::sliceStage(HeightfieldStage stage)
+{
+	switch (stage)
+	{
+	case HEIGHTFIELD_STAGE_MOUNTAIN:
+		return StageTask::toSlice(generateMountainTask());
+	case HEIGHTFIELD_STAGE_NOISE_FIELD:
+		{
+			std::shared_ptr<NoiseTiles> tiles(new NoiseTiles);
+			tiles->next = -1;
+			return [this, tiles]() -> float
+			{
+				return sliceNoiseField(*tiles);
+			};
+		}
+	case HEIGHTFIELD_STAGE_CRATER:
+		{
+			// The whole heightfield is searched for the peak before the crater is
+			// cut, a band of columns at a time
+			int row = 0;
+			int column = -1;
+			return [this, row, column]() mutable -> float
+			{
+				if (row == 0)
+					craterX_ = craterZ_ = peakHeight_ = 0.0f;
+
+				if (row < size_)
+				{
+					int last = (row + SLICE_ROWS < size_) ? row + SLICE_ROWS - 1 : size_ - 1;
+					findPeak(row, last);
+					row = last + 1;
+					return 0.5f * row / size_;
+				}
+
+				HeightfieldRegion region = getCraterRegion();
+				if (column < 0)
+				{
+					addDirtyRegion(region.rowMin, region.rowMax, region.columnMin, region.columnMax);
+					column = region.columnMin;
+				}
+
+				carveCrater(column, column + SLICE_COLUMNS - 1);
+				column += SLICE_COLUMNS;
+				if (column <= region.columnMax)
+					return 0.5f + 0.5f * (column - region.columnMin) / (region.columnMax - region.columnMin + 1);
+
+				return 1.0f;
+			};
+		}
+	case HEIGHTFIELD_STAGE_NOISE_LAYER:
+		{
+			int row = 1;
+			return [this, row]() mutable -> float
+			{
+				if (!noise_)
+					return 1.0f;
+
+				if (row == 1)
+					addDirtyRegion(1, size_ - 2, 1, size_ - 2);
+
+				int last = (row + SLICE_ROWS < size_ - 1) ? row + SLICE_ROWS - 1 : size_ - 2;
+				applyNoiseRows(row, last);
+				row = last + 1;
+				if (row < size_ - 1)
+					return (float)(row - 1) / (size_ - 2);
+
+				noise_.reset();
+				return 1.0f;
+			};
+		}
+	case HEIGHTFIELD_STAGE_LAVA_FLOW:
+	default:
+		return StageTask::toSlice(generateLavaFlowTask());
+	}
+}
+
+/*
+	Name		Heightfield::generateMountain
+	Syntax		Heightfield::generateMountain()
+	Brief		Generates the whole mountain at once
+*/
+void Heightfield::generateMountain()
+{
+	generateMountainTask().run();
+}
+
+/*
+	Name		Heightfield::generateMountainTask
+	Syntax		Heightfield::generateMountainTask()
+	Return		StageTask - The stage, yielding after each band of a mound's columns
+	Brief		Generates a mountain by creating a number of mounds stacked
+				roughly in the centre of the heightfield
+*/
+StageTask Heightfield::generateMountainTask()
+{
+	int maxRadius = (size_/6);
+	int minRadius = (size_/18);
+	float maxDistance, minDistance;
+	float radius;
+	float moundX, moundZ;
+	float angle, distance;
+	float radiusSq, distanceSq, height, difference;
+	int xMin, xMax, zMin, zMax;
+	int i, x, z;
+
+	for (i = 0; i < MOUNDS; ++i)
+	{
+		// Mounds have a random radius between 1/5 and 1/9 of the terrain's width
+		radius = (float)(random_.nextInt(maxRadius) + minRadius);
+
+		// Each mound is generated at a random angle and distance from the centre of the terrain
+		angle = random_.nextFloat(0.0f, 2*PI);
+		// Distance from centre is randomised between radius/4 and where the edge of the mound would miss the edge of the terrain
+		maxDistance = size_/2 - radius*2;
+		minDistance = radius/4;
+		distance = random_.nextFloat(minDistance, minDistance + maxDistance);
+
+		// Set the centre of the mound
+		moundX = (float)size_/2.0f + std::cos(angle) * distance;
+		moundZ = (float)size_/2.0f + std::sin(angle) * distance;
+
+		// We use the square of the radius to avoid having to use squareroot on the distance
+		radiusSq = radius * radius;
+
+		// Boundaries for vertices in range of the centre of the mound
+		xMin = (int)(moundX - radius - 1);
+		xMax = (int)(moundX + radius + 1);
+		if (xMin < 0)
+			xMin = 0;
+		if (xMax >= size_)
+			xMax = size_ - 1;
+
+		zMin = (int)(moundZ - radius - 1);
+		zMax = (int)(moundZ + radius + 1);
+		if (zMin < 0)
+			zMin = 0;
+		if (zMax >= size_)
+			zMax = size_ - 1;
+
+		addDirtyRegion(zMin, zMax, xMin, xMax);
+
+		// Calculate height for each vertex in the mound - negative value are outside of the mound's radius
+		for (x = xMin; x <= xMax; ++x)
+		{
+			for(z = zMin; z <= zMax; ++z)
+			{
+				distanceSq = (moundX - x) * (moundX - x) + (moundZ - z) * (moundZ - z);
+				// Use the distance from the centre to determine the height
+				difference = radiusSq - distanceSq;
+
+				// Ignore if negative
+				if (difference > 0)
+				{
+					// Use the squareroot and dividing factor to create smoother terrain.
+					height = (radius - std::sqrt(distanceSq))/4;
+					// Add the height to the vertex.
+					heights_[x + (z*size_)] += height;
+				}
+			}
+
+			if ((x - xMin + 1) % SLICE_COLUMNS == 0 || x == xMax)
+				co_yield (i + (float)(x - xMin + 1) / (xMax - xMin + 1)) / MOUNDS;
+		}
+	}
+}
+
+/*
+	Name		Heightfield::generateCrater
+	Syntax		Heightfield::generateCrater()
+	Brief		Generates a crater at the heightest point in the heightfield
+*/
+void Heightfield::generateCrater()
+{
+	craterX_ = craterZ_ = peakHeight_ = 0.0f;
+	findPeak(0, size_ - 1);
+
+	HeightfieldRegion region = getCraterRegion();
+	addDirtyRegion(region.rowMin, region.rowMax, region.columnMin, region.columnMax);
+	carveCrater(region.columnMin, region.columnMax);
+}
+
+/*
+	Name		Heightfield::findPeak
+	Syntax		Heightfield::findPeak(int rowMin, int rowMax)
+	Param		int rowMin, rowMax - The first and last rows to search
+	Brief		Moves the crater's centre to the highest point in the rows if it is
+				higher than the peak found so far
+*/
+void Heightfield::findPeak(int rowMin, int rowMax)
+{
+	// find the highest point on the terrain and centre the crate on it
+	for (int i = rowMin * size_; i < (rowMax + 1) * size_; i++)
+	{
+		if (heights_[i] > peakHeight_)
+		{
+			peakHeight_ = heights_[i];
+			craterX_ = (float)(i%size_);
+			craterZ_ = (float)(i/size_);
+		}
+	}
+}
+
+/*
+	Name		Heightfield::getCraterRegion
+	Syntax		Heightfield::getCraterRegion()
+	Return		HeightfieldRegion - The vertices in range of the crater around the
+				peak found
+*/
+HeightfieldRegion Heightfield::getCraterRegion() const
+{
+	float radius = (float)(size_/12.0f);
+
+	// Boundaries for vertices in range of the centre of the mound
+	HeightfieldRegion region;
+	region.columnMin = (int)(craterX_ - radius - 1);
+	region.columnMax = (int)(craterX_ + radius + 1);
+	if (region.columnMin < 0)
+		region.columnMin = 0;
+	if (region.columnMax >= size_)
+		region.columnMax = size_ - 1;
+
+	region.rowMin = (int)(craterZ_ - radius - 1);
+	region.rowMax = (int)(craterZ_ + radius + 1);
+	if (region.rowMin < 0)
+		region.rowMin = 0;
+	if (region.rowMax >= size_)
+		region.rowMax = size_ - 1;
+
+	return region;
+}
+
+/*
+	Name		Heightfield::carveCrater
+	Syntax		Heightfield::carveCrater(int columnMin, int columnMax)
+	Param		int columnMin, columnMax - The columns to cut, clipped to the crater
+	Brief		Cuts the crater around the peak found, filling its centre with lava
+*/
+void Heightfield::carveCrater(int columnMin, int columnMax)
+{
+	craterRadius_ = (float)(size_/12.0f);
+
+	// We use the square of the radius to avoid having to use squareroot on the distance
+	float radiusSq = craterRadius_ * craterRadius_;
+	float distanceSq;
+	float height;
+
+	HeightfieldRegion region = getCraterRegion();
+	int xMin = columnMin > region.columnMin ? columnMin : region.columnMin;
+	int xMax = columnMax < region.columnMax ? columnMax : region.columnMax;
+
+	for (int x = xMin; x <= xMax; ++x)
+	{
+		for(int z = region.rowMin; z <= region.rowMax; ++z)
+		{
+			distanceSq = ( craterX_ - x ) * ( craterX_ - x ) + ( craterZ_ - z ) * ( craterZ_ - z );
+			// Use the distance from the centre to determine the heights
+			height = radiusSq - distanceSq;
+
+			// Ignore if negative
+			if (height > 0)
+			{
+				// Subtract the squareroot of the height from the vertex to create a crater
+				heights_[x + (z*size_)] -= std::sqrt(height);
+
+				if (height > 625)
+				{
+					types_[x + (z*size_)] = LAVA;
+					addLavaPoint(x + (z*size_));
+				}
+			}
+		}
+	}
+}
+
+/*
+	Name		Heightfield::generateNoise
+	Syntax		Heightfield::generateNoise(WorkerPool* pool)
+	Param		WorkerPool* pool - Pool to generate the field on, or 0 to run serially
+	Brief		Adds ridged multifractal noise to the interior of the heightfield
+*/
+void Heightfield::generateNoise(WorkerPool* pool)
+{
+	prepareNoise(pool);
+	applyNoise();
+}
+
+/*
+	Name		Heightfield::prepareNoise
+	Syntax		Heightfield::prepareNoise(WorkerPool* pool)
+	Param		WorkerPool* pool - Pool to generate the field on, or 0 to run serially
+	Brief		Fetches the ridged multifractal noise layer without changing the
+				heightfield. The field does not depend on the random mountain or
+				crater, so it is generated once per size and taken from the cache
+				after a reset.
+*/
+void Heightfield::prepareNoise(WorkerPool* pool)
+{
+	SimplexNoise::FieldDesc desc = getNoiseDesc();
+	if (desc.rows <= 0)
+		return;
+
+	noise_ = noiseCache_->get(SimplexNoise::getDefaultGenerator(), desc, pool);
+}
+
+/*
+	Name		Heightfield::getNoiseDesc
+	Syntax		Heightfield::getNoiseDesc()
+	Return		SimplexNoise::FieldDesc - The noise layer, covering the interior of the
+				heightfield
+*/
+SimplexNoise::FieldDesc Heightfield::getNoiseDesc() const
+{
+	SimplexNoise::FieldDesc desc;
+	desc.type = SimplexNoise::FRACTAL_RIDGED_MULTIFRACTAL;
+	desc.octaves = 10;
+	desc.lacunarity = 1.5f;
+	desc.gain = 0.5f;
+	desc.offset = 1.0f;
+	desc.scale = NOISE_HEIGHT;
+	desc.originX = 1.0f / 128.0f;
+	desc.originY = 1.0f / 128.0f;
+	desc.stepX = 1.0f / 128.0f;
+	desc.stepY = 1.0f / 128.0f;
+	desc.rows = size_ - 2;
+	desc.columns = size_ - 2;
+	return desc;
+}
+
+/*
+	Name		Heightfield::sliceNoiseField
+	Syntax		Heightfield::sliceNoiseField(NoiseTiles& tiles)
+	Param		NoiseTiles& tiles - The noise layer so far
+	Return		float - How much of the layer has been fetched, 1 once it has
+	Brief		Takes the noise layer from the cache, or generates a few more of its
+				tiles and caches it once they are all done
+*/
+float Heightfield::sliceNoiseField(NoiseTiles& tiles)
+{
+	const SimplexNoise::Generator& generator = SimplexNoise::getDefaultGenerator();
+
+	if (tiles.next < 0)
+	{
+		tiles.desc = getNoiseDesc();
+		if (tiles.desc.rows <= 0)
+			return 1.0f;
+
+		noise_ = noiseCache_->find(generator, tiles.desc);
+		if (noise_)
+			return 1.0f;
+
+		// Only reserved, as filling the whole field at once would take as long
+		// as several slices
+		int tileSize = SimplexNoise::FIELD_TILE_SIZE;
+		tiles.field.reset(new std::vector<float>);
+		tiles.field->reserve(tiles.desc.rows * tiles.desc.columns);
+		tiles.columns = (tiles.desc.columns + tileSize - 1) / tileSize;
+		tiles.count = ((tiles.desc.rows + tileSize - 1) / tileSize) * tiles.columns;
+		tiles.next = 0;
+	}
+
+	int end = (tiles.next + SLICE_NOISE_TILES < tiles.count) ? tiles.next + SLICE_NOISE_TILES : tiles.count;
+	for (; tiles.next < end; ++tiles.next)
+	{
+		// The field grows by a row of tiles as each row is started
+		int tileRow = tiles.next / tiles.columns;
+		if (tiles.next % tiles.columns == 0)
+		{
+			int rows = (tileRow + 1) * SimplexNoise::FIELD_TILE_SIZE;
+			tiles.field->resize((rows < tiles.desc.rows ? rows : tiles.desc.rows) * tiles.desc.columns);
+		}
+
+		SimplexNoise::generateFieldTile(generator, tiles.desc, tileRow, tiles.next % tiles.columns,
+			&(*tiles.field)[0]);
+	}
+
+	if (tiles.next < tiles.count)
+		return (float)tiles.next / tiles.count;
+
+	noise_ = noiseCache_->insert(generator, tiles.desc, tiles.field);
+	tiles.field.reset();
+	return 1.0f;
+}
+
+/*
+	Name		Heightfield::applyNoise
+	Syntax		Heightfield::applyNoise()
+	Brief		Adds the noise layer fetched by prepareNoise to the interior of the
+				heightfield
+*/
+void Heightfield::applyNoise()
+{
+	if (!noise_)
+		return;
+
+	addDirtyRegion(1, size_ - 2, 1, size_ - 2);
+	applyNoiseRows(1, size_ - 2);
+	noise_.reset();
+}
+
+/*
+	Name		Heightfield::applyNoiseRows
+	Syntax		Heightfield::applyNoiseRows(int rowMin, int rowMax)
+	Param		int rowMin, rowMax - The first and last interior rows to add the noise
+				layer to
+*/
+void Heightfield::applyNoiseRows(int rowMin, int rowMax)
+{
+	int columns = size_ - 2;
+	for (int i = rowMin; i <= rowMax; ++i)
+	{
+		const float* row = &(*noise_)[(i - 1) * columns];
+		float* heights = &heights_[i * size_ + 1];
+		for (int j = 0; j < columns; ++j)
+		{
+			heights[j] += row[j];
+		}
+	}
+}
+
+/*
+	Name		Heightfield::generateLavaFlow
+	Syntax		Heightfield::generateLavaFlow()
+	Brief		Generates a whole lava flow at once
+*/
+void Heightfield::generateLavaFlow()
+{
+	generateLavaFlowTask().run();
+}
+
+/*
+	Name		Heightfield::generateLavaFlowTask
+	Syntax		Heightfield::generateLavaFlowTask()
+	Return		StageTask - The stage, yielding after each stretch of the flow. How
+				far it has to go is only estimated.
+	Brief		Generates a lava flow from the crater to the edge of the heightfield
+*/
+StageTask Heightfield::generateLavaFlowTask()
+{
+	// Pick random angle and position lava flow from the edge of the crater flowing outwards at that angle
+	float angle = random_.nextFloat(0.0f, 2*PI);
+	float startX = craterX_ + std::cos(angle) * (craterRadius_ - 25.0f);
+	float startZ = craterZ_ + std::sin(angle) * (craterRadius_ - 25.0f);
+	float destinationX = craterX_ + std::cos(angle) * (craterRadius_ + 50.0f);
+	float destinationZ = craterZ_ + std::sin(angle) * (craterRadius_ + 50.0f);
+
+	// Horizontal direction of the flow, normalised
+	float directionX = destinationX - startX;
+	float directionZ = destinationZ - startZ;
+	float length = std::sqrt(directionX * directionX + directionZ * directionZ);
+	if (length > 0.0f)
+	{
+		directionX /= length;
+		directionZ /= length;
+	}
+
+	// The horizontal vector perpendicular to the direction of the lava flow
+	float acrossFlowX = -directionZ;
+	float acrossFlowZ = directionX;
+
+	float flowX = startX;
+	float flowZ = startZ;
+	int acrossX, acrossZ;
+	int count = 0;
+	float halfWidth = 10.0f;
+	float depth = LAVA_FLOW_DEPTH;
+	float curve = 25.0f;
+
+	// Steps to the edge ignoring the curve, only used to report progress. Each
+	// step moves about a tenth of a vertex.
+	float edgeX = directionX >= 0.0f ? (size_ - 1) - startX : startX - 1;
+	float edgeZ = directionZ >= 0.0f ? (size_ - 1) - startZ : startZ - 1;
+	float toEdgeX = std::fabs(directionX) > 0.0f ? edgeX / std::fabs(directionX) : edgeZ;
+	float toEdgeZ = std::fabs(directionZ) > 0.0f ? edgeZ / std::fabs(directionZ) : edgeX;
+	float toEdge = toEdgeX < toEdgeZ ? toEdgeX : toEdgeZ;
+	int expected = toEdge > 0.0f ? (int)(toEdge * 10.0f) + 1 : 1;
+
+	std::vector<char> changed(heights_.size(), 0);
+	float depthChange;
+	int index;
+
+	// Bounds of the vertices the flow has carved
+	int xMin = size_, xMax = -1;
+	int zMin = size_, zMax = -1;
+	while (flowX >= 1 && flowX < (size_-1) && flowZ >= 1 && flowZ < (size_-1))
+	{
+		// Sets depths for all vectors across the width of the lava flow
+		for (int j = (int)(-halfWidth); j < (int)halfWidth; j++)
+		{
+			// Cosine curve used to generate depths across the lava flow - This creates a deep v-shaped curve
+			depthChange = depth * (std::cos(PI * (float)j/halfWidth) + 0.8f);
+
+			acrossX = (int)(flowX - (acrossFlowX * halfWidth) + (acrossFlowX * j));
+			acrossZ = (int)(flowZ - (acrossFlowZ * halfWidth) + (acrossFlowZ * j));
+
+			if (acrossX >= 0 && acrossX < size_ && acrossZ >= 0 && acrossZ < size_)
+			{
+				index = acrossX + acrossZ * size_;
+				if (!changed[index])
+				{
+					heights_[index] -= depthChange;
+					if (j > (-halfWidth+5) && j < (halfWidth-5))
+					{
+						types_[index] = LAVA;
+						addLavaPoint(index);
+					}
+					changed[index] = 1;
+
+					if (acrossX < xMin)
+						xMin = acrossX;
+					if (acrossX > xMax)
+						xMax = acrossX;
+					if (acrossZ < zMin)
+						zMin = acrossZ;
+					if (acrossZ > zMax)
+						zMax = acrossZ;
+				}
+			}
+		}
+
+		// Follow a sine wave pattern along the direction vector
+		flowZ += directionZ/10 + std::sin(count/(curve*10))/20;
+		flowX += directionX/10 + std::sin(count/(curve*10))/20;
+		count++;
+
+		if (count % SLICE_FLOW_STEPS == 0)
+			co_yield (count < expected) ? (float)count / expected : 0.99f;
+	}
+
+	if (xMax >= 0)
+		addDirtyRegion(zMin, zMax, xMin, xMax);
+}
+
+/*
+	Name		Heightfield::pickLavaPoints
+	Syntax		Heightfield::pickLavaPoints(int count)
+	Param		int count - The number of points wanted
+	Return		std::vector<HeightfieldPoint> - count randomly chosen lava points, or
+				none if there is no lava yet
+*/
+std::vector<HeightfieldPoint> Heightfield::pickLavaPoints(int count)
+{
+	std::vector<HeightfieldPoint> points;
+	if (lavaPoints_.empty())
+		return points;
+
+	for (int i = 0; i < count; ++i)
+	{
+		points.push_back(lavaPoints_[random_.nextInt((int)lavaPoints_.size())]);
+	}
+	return points;
+}
+
+/*
+	Name		Heightfield::addLavaPoint
+	Syntax		Heightfield::addLavaPoint(int index)
+	Param		int index - The vertex that has become lava
+	Brief		Records the vertex's position at its current height
+*/
+void Heightfield::addLavaPoint(int index)
+{
+	HeightfieldPoint point;
+	point.x = (float)(index / size_);
+	point.y = heights_[index];
+	point.z = (float)(index % size_);
+	lavaPoints_.push_back(point);
+}
+
+/*
+	Name		Heightfield::addDirtyRegion
+	Syntax		Heightfield::addDirtyRegion(int rowMin, int rowMax, int columnMin, int columnMax)
+	Param		int rowMin, rowMax - The first and last rows changed
+	Param		int columnMin, columnMax - The first and last columns changed
+	Brief		Records a rectangle a stage has changed heights or materials in
+*/
+void Heightfield::addDirtyRegion(int rowMin, int rowMax, int columnMin, int columnMax)
+{
+	HeightfieldRegion region;
+	region.rowMin = rowMin;
+	region.rowMax = rowMax;
+	region.columnMin = columnMin;
+	region.columnMax = columnMax;
+	dirtyRegions_.push_back(region);
+}
@@ -0,0 +1,201 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Heightfield
+	Brief		Declaration of Heightfield Class, the volcano generation behind Terrain.
+				It only holds heights and materials, with no Direct3D dependency, so
+				volcanoes can be generated headless.
+*/
+
+#ifndef HEIGHTFIELD_H
+#define HEIGHTFIELD_H
+
+#include <memory>
+#include <vector>
+
+#include "Utilities/NoiseFieldCache.hpp"
+#include "Utilities/Random.hpp"
+#include "Utilities/SliceScheduler.hpp"
+#include "Utilities/StageTask.hpp"
+#include "Utilities/TaskGraph.hpp"
+
+class HeightfieldFile;
+
+enum TerrainType
+{
+	ROCK,
+	LAVA,
+};
+
+/*
+	Name		HeightfieldResource
+	Brief		The parts of a heightfield its generation stages read and write, as
+				TaskGraph resource bits. Owners adding their own nodes to the graph
+				use the bits from HEIGHTFIELD_FIRST_FREE_RESOURCE up.
+*/
+enum HeightfieldResource
+{
+	HEIGHTFIELD_HEIGHTS = 1,
+	HEIGHTFIELD_TYPES = 2,				// With the lava points
+	HEIGHTFIELD_CRATER = 4,
+	HEIGHTFIELD_NOISE = 8,				// The noise layer waiting to be added
+	HEIGHTFIELD_RANDOM = 16,
+	HEIGHTFIELD_DIRTY_REGIONS = 32,
+	HEIGHTFIELD_FIRST_FREE_RESOURCE = 64
+};
+
+/*
+	Name		HeightfieldStage
+	Brief		The generation stages, in the order a volcano is built
+*/
+enum HeightfieldStage
+{
+	HEIGHTFIELD_STAGE_MOUNTAIN,
+	HEIGHTFIELD_STAGE_NOISE_FIELD,		// Only fetches the noise layer
+	HEIGHTFIELD_STAGE_CRATER,
+	HEIGHTFIELD_STAGE_NOISE_LAYER,
+	HEIGHTFIELD_STAGE_LAVA_FLOW
+};
+
+/*
+	Name		HeightfieldPoint
+	Brief		A position in the heightfield's local space. x is the row, z the column
+				and y the height when the point was generated.
+*/
+struct HeightfieldPoint
+{
+	float x;
+	float y;
+	float z;
+};
+
+/*
+	Name		HeightfieldRegion
+	Brief		An inclusive rectangle of rows and columns changed by a generation stage
+*/
+struct HeightfieldRegion
+{
+	int rowMin;
+	int rowMax;
+	int columnMin;
+	int columnMax;
+};
+
+class Heightfield
+{
+public:
+	// The number of lava flows a completed volcano has
+	static const int LAVA_FLOWS = 4;
+
+	/*
+		Name		Stages
+		Brief		The nodes addStages adds to a graph, in the order a volcano is
+					built. The noise field only fetches the noise layer, so it does
+					not depend on the mountain.
+	*/
+	struct Stages
+	{
+		TaskGraph::Node mountain;
+		TaskGraph::Node noiseField;
+		TaskGraph::Node crater;
+		TaskGraph::Node noiseLayer;
+		TaskGraph::Node lavaFlows[LAVA_FLOWS];
+	};
+
+	Heightfield();
+
+	void initialise(int size);
+	void reset();
+	void load(const HeightfieldFile& file);
+	void generate(WorkerPool* pool = 0);
+	Stages addStages(TaskGraph& graph);
+	TaskGraph::Node addStage(TaskGraph& graph, HeightfieldStage stage);
+	SliceScheduler::Slice sliceStage(HeightfieldStage stage);
+
+	void generateMountain();
+	void generateCrater();
+	void generateNoise(WorkerPool* pool = 0);
+	void prepareNoise(WorkerPool* pool = 0);
+	void applyNoise();
+	void generateLavaFlow();
+	StageTask generateMountainTask();
+	StageTask generateLavaFlowTask();
+
+	std::vector<HeightfieldPoint> pickLavaPoints(int count);
+
+	void setNoiseCache(SimplexNoise::NoiseFieldCache* cache);
+
+	static void getHeightBounds(int size, float& minHeight, float& maxHeight);
+
+	void setSeed(unsigned int seed, unsigned int stream = 0);
+	unsigned int getSeed() const { return seed_; };
+	unsigned int getStream() const { return generation_; };
+
+	int getSize() const { return size_; };
+	const float* getHeights() const { return heights_.empty() ? 0 : &heights_[0]; };
+	const unsigned int* getTypes() const { return types_.empty() ? 0 : &types_[0]; };
+	const std::vector<HeightfieldPoint>& getLavaPoints() const { return lavaPoints_; };
+
+	float getCraterX() const { return craterX_; };
+	float getCraterZ() const { return craterZ_; };
+	float getCraterRadius() const { return craterRadius_; };
+	float getPeakHeight() const { return peakHeight_; };
+
+	// The regions changed by the stages run since the last clearDirtyRegions
+	const std::vector<HeightfieldRegion>& getDirtyRegions() const { return dirtyRegions_; };
+	void clearDirtyRegions() { dirtyRegions_.clear(); };
+
+private:
+	/*
+		Name		NoiseTiles
+		Brief		The noise layer part way through being generated a few tiles at
+					a time, when it is not in the cache
+	*/
+	struct NoiseTiles
+	{
+		SimplexNoise::FieldDesc desc;
+		std::shared_ptr<std::vector<float> > field;
+		int next;							// -1 until the cache has been checked
+		int count;
+		int columns;						// Tiles across the field
+	};
+
+	SimplexNoise::FieldDesc getNoiseDesc() const;
+	float sliceNoiseField(NoiseTiles& tiles);
+	void findPeak(int rowMin, int rowMax);
+	HeightfieldRegion getCraterRegion() const;
+	void carveCrater(int columnMin, int columnMax);
+	void applyNoiseRows(int rowMin, int rowMax);
+	void addLavaPoint(int index);
+	void addDirtyRegion(int rowMin, int rowMax, int columnMin, int columnMax);
+
+	int size_;
+
+	// size_ * size_ heights and TerrainTypes, index = row * size_ + column
+	std::vector<float> heights_;
+	std::vector<unsigned int> types_;
+	std::vector<HeightfieldPoint> lavaPoints_;
+	std::vector<HeightfieldRegion> dirtyRegions_;
+
+	// Fetched by prepareNoise, released once applyNoise has added it
+	SimplexNoise::FieldPtr noise_;
+
+	float craterX_;
+	float craterZ_;
+	float craterRadius_;
+	float peakHeight_;
+
+	// Every random choice is drawn from stream generation_ of seed_
+	unsigned int seed_;
+	unsigned int generation_;
+	Random random_;
+
+	// The noise layer only depends on the size, so it is reused across resets.
+	// noiseCache_ is ownNoiseCache_ unless a shared cache has been set.
+	SimplexNoise::NoiseFieldCache ownNoiseCache_;
+	SimplexNoise::NoiseFieldCache* noiseCache_;
+};
+
+#endif // HEIGHTFIELD_H
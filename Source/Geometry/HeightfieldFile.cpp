@@ -0,0 +1,252 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Heightfield File
+	Brief		Definition of HeightfieldFile Class
+*/
+
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Geometry/HeightfieldFile.hpp"
+
+namespace
+{
+	const char MAGIC[4] = {'M', 'V', 'H', 'F'};
+
+	unsigned long long align(unsigned long long offset)
+	{
+		return (offset + HEIGHTFIELD_FILE_ALIGNMENT - 1) / HEIGHTFIELD_FILE_ALIGNMENT * HEIGHTFIELD_FILE_ALIGNMENT;
+	}
+
+	bool writePadded(FILE* file, const void* data, size_t bytes, unsigned long long end)
+	{
+		if (bytes > 0 && fwrite(data, 1, bytes, file) != bytes)
+			return false;
+
+		static const char zeros[HEIGHTFIELD_FILE_ALIGNMENT] = {0};
+		long position = ftell(file);
+		if (position < 0)
+			return false;
+		size_t padding = (size_t)(end - (unsigned long long)position);
+		return padding == 0 || fwrite(zeros, 1, padding, file) == padding;
+	}
+}
+
+/*
+	Name		HeightfieldFile::HeightfieldFile
+	Syntax		HeightfieldFile()
+	Brief		HeightfieldFile constructor
+*/
+HeightfieldFile::HeightfieldFile()
+: header_(0),
+  heights_(0),
+  types_(0),
+  emitters_(0),
+  view_(0),
+  viewSize_(0),
+  file_(0),
+  mapping_(0)
+{
+
+}
+
+/*
+	Name		HeightfieldFile::~HeightfieldFile
+	Syntax		~HeightfieldFile()
+	Brief		HeightfieldFile destructor, unmaps the file
+*/
+HeightfieldFile::~HeightfieldFile()
+{
+	close();
+}
+
+/*
+	Name		HeightfieldFile::save
+	Syntax		HeightfieldFile::save(const char* fileName, const Heightfield& heightfield,
+									  const std::vector<HeightfieldEmitter>& emitters)
+	Param		const char* fileName - The file to write
+	Param		const Heightfield& heightfield - The volcano to save
+	Param		const std::vector<HeightfieldEmitter>& emitters - Its particle emitters
+	Return		bool - False if the file could not be written
+*/
+bool HeightfieldFile::save(const char* fileName, const Heightfield& heightfield,
+						   const std::vector<HeightfieldEmitter>& emitters)
+{
+	unsigned long long points = (unsigned long long)heightfield.getSize() * heightfield.getSize();
+
+	HeightfieldFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = HEIGHTFIELD_FILE_VERSION;
+	header.headerSize = sizeof(HeightfieldFileHeader);
+	header.size = (unsigned int)heightfield.getSize();
+	header.seed = heightfield.getSeed();
+	header.emitterCount = (unsigned int)emitters.size();
+	header.craterX = heightfield.getCraterX();
+	header.craterZ = heightfield.getCraterZ();
+	header.craterRadius = heightfield.getCraterRadius();
+	header.peakHeight = heightfield.getPeakHeight();
+	header.heightsOffset = align(sizeof(HeightfieldFileHeader));
+	header.typesOffset = align(header.heightsOffset + points * sizeof(float));
+	header.emittersOffset = align(header.typesOffset + points * sizeof(unsigned int));
+	header.fileSize = align(header.emittersOffset + emitters.size() * sizeof(HeightfieldEmitter));
+
+	FILE* file = fopen(fileName, "wb");
+	if (!file)
+		return false;
+
+	bool written = writePadded(file, &header, sizeof(header), header.heightsOffset) &&
+				   writePadded(file, heightfield.getHeights(), (size_t)(points * sizeof(float)), header.typesOffset) &&
+				   writePadded(file, heightfield.getTypes(), (size_t)(points * sizeof(unsigned int)), header.emittersOffset) &&
+				   writePadded(file, emitters.empty() ? 0 : &emitters[0], emitters.size() * sizeof(HeightfieldEmitter), header.fileSize);
+
+	return fclose(file) == 0 && written;
+}
+
+/*
+	Name		HeightfieldFile::open
+	Syntax		HeightfieldFile::open(const char* fileName)
+	Param		const char* fileName - The file to map
+	Return		bool - False if the file could not be mapped or is not a heightfield
+				file this version can read
+	Brief		Maps the file read only. Its pages are only read from disk as the
+				planes are used.
+*/
+bool HeightfieldFile::open(const char* fileName)
+{
+	close();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	file_ = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(HeightfieldFileHeader))
+	{
+		close();
+		return false;
+	}
+	viewSize_ = (unsigned long long)size.QuadPart;
+
+	mapping_ = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+	if (mapping_)
+		view_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+#else
+	int file = ::open(fileName, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size < (off_t)sizeof(HeightfieldFileHeader))
+	{
+		::close(file);
+		return false;
+	}
+	viewSize_ = (unsigned long long)status.st_size;
+
+	// The mapping keeps the file open
+	view_ = mmap(0, (size_t)viewSize_, PROT_READ, MAP_PRIVATE, file, 0);
+	if (view_ == MAP_FAILED)
+		view_ = 0;
+	::close(file);
+#endif
+
+	if (!view_)
+	{
+		close();
+		return false;
+	}
+
+	header_ = (const HeightfieldFileHeader*)view_;
+	if (!validate(viewSize_))
+	{
+		close();
+		return false;
+	}
+
+	const char* base = (const char*)view_;
+	heights_ = (const float*)(base + header_->heightsOffset);
+	types_ = (const unsigned int*)(base + header_->typesOffset);
+	emitters_ = (const HeightfieldEmitter*)(base + header_->emittersOffset);
+	return true;
+}
+
+/*
+	Name		HeightfieldFile::close
+	Syntax		HeightfieldFile::close()
+	Brief		Unmaps the file. The plane pointers are invalid afterwards.
+*/
+void HeightfieldFile::close()
+{
+#if defined(_WIN32)
+	if (view_)
+		UnmapViewOfFile(view_);
+	if (mapping_)
+		CloseHandle(mapping_);
+	if (file_)
+		CloseHandle(file_);
+#else
+	if (view_)
+		munmap(view_, (size_t)viewSize_);
+#endif
+
+	view_ = 0;
+	viewSize_ = 0;
+	mapping_ = 0;
+	file_ = 0;
+	header_ = 0;
+	heights_ = 0;
+	types_ = 0;
+	emitters_ = 0;
+}
+
+/*
+	Name		HeightfieldFile::validate
+	Syntax		HeightfieldFile::validate(unsigned long long fileSize)
+	Param		unsigned long long fileSize - The size of the mapped file
+	Return		bool - True if the header is this version's and every plane it
+				describes is aligned and lies inside the file
+*/
+bool HeightfieldFile::validate(unsigned long long fileSize) const
+{
+	if (memcmp(header_->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+		header_->version != HEIGHTFIELD_FILE_VERSION ||
+		header_->headerSize != sizeof(HeightfieldFileHeader) ||
+		header_->fileSize > fileSize)
+		return false;
+
+	// Larger grids than this would not fit in memory anyway, and it keeps the
+	// sizes below from overflowing
+	if (header_->size < 2 || header_->size > 65536 || header_->emitterCount > 65536)
+		return false;
+
+	unsigned long long points = (unsigned long long)header_->size * header_->size;
+	unsigned long long planes[3][2] = {
+		{header_->heightsOffset, points * sizeof(float)},
+		{header_->typesOffset, points * sizeof(unsigned int)},
+		{header_->emittersOffset, header_->emitterCount * sizeof(HeightfieldEmitter)}};
+
+	for (int i = 0; i < 3; ++i)
+	{
+		if (planes[i][0] % HEIGHTFIELD_FILE_ALIGNMENT != 0 ||
+			planes[i][0] < sizeof(HeightfieldFileHeader) ||
+			planes[i][0] > header_->fileSize ||
+			planes[i][1] > header_->fileSize - planes[i][0])
+			return false;
+	}
+	return true;
+}
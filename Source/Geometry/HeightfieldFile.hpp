@@ -0,0 +1,109 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Heightfield File
+	Brief		Declaration of HeightfieldFile Class, a baked volcano saved as a binary
+				file that is memory mapped rather than read. The header is followed by
+				the height plane, the material plane and the emitter list, each
+				starting on a HEIGHTFIELD_FILE_ALIGNMENT boundary, so once the header
+				is checked the planes are used where they lie in the mapping.
+
+				Files are little endian, as every platform Mordor builds for is.
+*/
+
+#ifndef HEIGHTFIELDFILE_H
+#define HEIGHTFIELDFILE_H
+
+#include <vector>
+
+#include "Geometry/Heightfield.hpp"
+
+enum HeightfieldEmitterType
+{
+	EMITTER_ASH,
+	EMITTER_FIRE,
+	EMITTER_SMOKE,
+};
+
+/*
+	Name		HeightfieldEmitter
+	Brief		A particle emitter in the heightfield's local space
+*/
+struct HeightfieldEmitter
+{
+	unsigned int type;
+	HeightfieldPoint position;
+};
+
+/*
+	Name		HeightfieldFileHeader
+	Brief		The start of a heightfield file. Offsets are from the start of the file.
+*/
+struct HeightfieldFileHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned int headerSize;
+	unsigned int size;				// Vertices along each side
+	unsigned int seed;
+	unsigned int emitterCount;
+	float craterX;
+	float craterZ;
+	float craterRadius;
+	float peakHeight;
+	unsigned long long heightsOffset;	// size * size floats
+	unsigned long long typesOffset;		// size * size TerrainTypes as unsigned ints
+	unsigned long long emittersOffset;	// emitterCount HeightfieldEmitters
+	unsigned long long fileSize;
+};
+
+// Planes start on page boundaries so each maps in whole pages of its own
+const unsigned int HEIGHTFIELD_FILE_ALIGNMENT = 4096;
+const unsigned int HEIGHTFIELD_FILE_VERSION = 1;
+
+class HeightfieldFile
+{
+public:
+	HeightfieldFile();
+	~HeightfieldFile();
+
+	static bool save(const char* fileName, const Heightfield& heightfield,
+					 const std::vector<HeightfieldEmitter>& emitters);
+
+	bool open(const char* fileName);
+	void close();
+	bool isOpen() const { return header_ != 0; };
+
+	int getSize() const { return (int)header_->size; };
+	unsigned int getSeed() const { return header_->seed; };
+	float getCraterX() const { return header_->craterX; };
+	float getCraterZ() const { return header_->craterZ; };
+	float getCraterRadius() const { return header_->craterRadius; };
+	float getPeakHeight() const { return header_->peakHeight; };
+	const float* getHeights() const { return heights_; };
+	const unsigned int* getTypes() const { return types_; };
+	const HeightfieldEmitter* getEmitters() const { return emitters_; };
+	int getNumEmitters() const { return (int)header_->emitterCount; };
+
+private:
+	// Not copyable, it owns the mapping
+	HeightfieldFile(const HeightfieldFile&);
+	HeightfieldFile& operator=(const HeightfieldFile&);
+
+	bool validate(unsigned long long fileSize) const;
+
+	const HeightfieldFileHeader* header_;
+	const float* heights_;
+	const unsigned int* types_;
+	const HeightfieldEmitter* emitters_;
+
+	// Platform handles for the mapping
+	void* view_;
+	unsigned long long viewSize_;
+	void* file_;
+	void* mapping_;
+};
+
+#endif // HEIGHTFIELDFILE_H
@@ -7,40 +7,119 @@
 	Brief		Definition of Terrain Class
 */
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include <fstream>
 #include "Geometry\Terrain.hpp"
+#include "Geometry\TerrainIndices.hpp"
 #include "Graphics\Vertex.hpp"
 #include "Utilities\SimplexNoise.hpp"
+#include "Utilities\VertexCache.hpp"
+#include "Utilities\WorkerPool.hpp"
 #include "Scene\Scene.hpp"
 #include "Global\Global.hpp"
 
+namespace
+{
+	// A vertex this close to its final height is snapped to it and stops moving
+	const float HEIGHT_EPSILON = 0.01f;
+
+	/*
+		Name		GenerationStep
+		Brief		How long the animated generation waits after a step for the
+					vertices to settle, and how fast they move meanwhile
+	*/
+	struct GenerationStep
+	{
+		float settleTime;
+		float speed;
+	};
+
+	// The mountain, the crater, the noise layer, which settles slowly, and each
+	// lava flow
+	const GenerationStep GENERATION_STEPS[TerrainGeneration::STEP_COMPLETE] =
+	{
+		{15.0f, 1.0f}, {5.0f, 1.0f}, {10.0f, 0.4f}, {5.0f, 1.0f}, {5.0f, 1.0f}, {5.0f, 1.0f}, {10.0f, 1.0f}
+	};
+
+	// Rows of normals calculated by each job
+	const int NORMAL_BLOCK_ROWS = 16;
+
+	// Milliseconds a frame spends generating when there are no workers to
+	// generate on
+	const float DEFAULT_GENERATION_BUDGET = 4.0f;
+
+	/*
+		Name		encodeOctahedral
+		Syntax		encodeOctahedral(const D3DXVECTOR3& normal, short encoded[2])
+		Param		const D3DXVECTOR3& normal - A unit normal, or zero for none
+		Param		short encoded[2] - Receives the x and z of the normal projected onto
+					an octahedron with y as its pole, unfolded into a square
+	*/
+	void encodeOctahedral(const D3DXVECTOR3& normal, short encoded[2])
+	{
+		float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+		float x = 0.0f;
+		float z = 0.0f;
+		if (length > 0.0f)
+		{
+			x = normal.x / length;
+			z = normal.z / length;
+		}
+
+		// The lower half is folded out over the corners of the square
+		if (normal.y < 0.0f)
+		{
+			float foldedX = (1.0f - std::fabs(z)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float foldedZ = (1.0f - std::fabs(x)) * (z >= 0.0f ? 1.0f : -1.0f);
+			x = foldedX;
+			z = foldedZ;
+		}
+
+		encoded[0] = (short)std::floor(x * 32767.0f + 0.5f);
+		encoded[1] = (short)std::floor(z * 32767.0f + 0.5f);
+	}
+}
+
 /*
 	Name		Terrain::Terrain
 	Syntax		Terrain()
 	Brief		Terrain constructor
 */
 Terrain::Terrain() 
-: currentGenStage_(GEN_FLAT),
-  age_(5.0f),
+: age_(5.0f),
   scale_(1,1,1), 
   theta_(0,0,0), 
   pos_(0,0,0), 
   verticesNo_(0), 
   facesNo_(0), 
-  vertices_(0), 
-  heightMap_(0), 
+  vertexFormat_(TERRAIN_VERTEX_FULL), 
+  staticVertices_(0), 
+  dynamicVertices_(0), 
+  types_(0), 
+  compactVertices_(0), 
+  compactHeightMin_(0.0f),
+  compactHeightRange_(1.0f),
   indices_(0), 
   d3dDevice_(0), 
-  vertexBuffer_(0), 
+  staticBuffer_(0), 
+  dynamicBuffer_(0), 
+  typeBuffer_(0), 
+  compactBuffer_(0), 
   indexBuffer_(0), 
+  quadtree_(0), 
+  uploadedBytes_(0),
+  frameUploadedBytes_(0),
   width_(0), 
   height_(0), 
-  craterX_(0),
-  craterZ_(0),
-  craterRadius_(0),
   isComplete_(false),
   ashEmitter_(0,0,0),
+  generation_(0),
+  seed_(Random::DEFAULT_SEED),
+  stream_(0),
+  generationBudget_(WorkerPool::instance()->getNumThreads() > 1 ? 0.0f : DEFAULT_GENERATION_BUDGET),
+  nextStep_(0),
   heightMapRV_(0)
 {
 
@@ -53,46 +132,113 @@ Terrain::Terrain()
 */
 Terrain::~Terrain()
 {
-	if (vertices_)
+	if (staticVertices_)
 	{
-		delete vertices_;
-		vertices_ = 0;
+		delete [] staticVertices_;
+		staticVertices_ = 0;
 	}
-	if (heightMap_)
+	if (dynamicVertices_)
 	{
-		delete heightMap_;
-		heightMap_ = 0;
+		delete [] dynamicVertices_;
+		dynamicVertices_ = 0;
+	}
+	if (types_)
+	{
+		delete [] types_;
+		types_ = 0;
+	}
+	if (compactVertices_)
+	{
+		delete [] compactVertices_;
+		compactVertices_ = 0;
 	}
 	if (indices_)
 	{
-		delete indices_;
+		delete [] indices_;
 		indices_ = 0;
 	}
-	if (vertexBuffer_)
+	if (staticBuffer_)
+	{
+		staticBuffer_->Release();
+		staticBuffer_ = 0;
+	}
+	if (dynamicBuffer_)
+	{
+		dynamicBuffer_->Release();
+		dynamicBuffer_ = 0;
+	}
+	if (typeBuffer_)
 	{
-		vertexBuffer_->Release();
-		vertexBuffer_ = 0;
+		typeBuffer_->Release();
+		typeBuffer_ = 0;
+	}
+	if (compactBuffer_)
+	{
+		compactBuffer_->Release();
+		compactBuffer_ = 0;
 	}
 	if (indexBuffer_)
 	{
 		indexBuffer_->Release();
 		indexBuffer_ = 0;
 	}
+	if (quadtree_)
+	{
+		delete quadtree_;
+		quadtree_ = 0;
+	}
+
+	// Each waits for its running stages as it is deleted
+	if (generation_)
+	{
+		generation_->cancel();
+		delete generation_;
+		generation_ = 0;
+	}
+	for (size_t i = 0; i < retired_.size(); ++i)
+	{
+		delete retired_[i];
+	}
+	retired_.clear();
 }
 
 /*
 	Name		Terrain::initialise
-	Syntax		Terrain::initialise(ID3D10Device* device, int gridSize)
+	Syntax		Terrain::initialise(ID3D10Device* device, int gridSize, TerrainVertexFormat format,
+							bool chunked)
 	Param		ID3D10Device* device - Pointer to the Direct3D device
 	Param		int gridSize - The number of vertices wide to set the terrain grid at
+	Param		TerrainVertexFormat format - How to store the vertices on the GPU
+	Param		bool chunked - Draw the terrain in chunks of varying detail. Needs a
+				gridSize of TerrainQuadtree::CHUNK_QUADS times a power of two.
 	Brief		Initialises the vertex and index buffers
 */
-void Terrain::initialise(ID3D10Device* device, int gridSize)
+void Terrain::initialise(ID3D10Device* device, int gridSize, TerrainVertexFormat format, bool chunked)
 {
 	d3dDevice_ = device;
+	vertexFormat_ = format;
 
 	width_ = height_ = gridSize + 1;
 
+	// The quantized range grows with the volcano, and takes in the dropped edges
+	float maxHeight;
+	Heightfield::getHeightBounds(width_, compactHeightMin_, maxHeight);
+	if (compactHeightMin_ > -100.0f)
+		compactHeightMin_ = -100.0f;
+	compactHeightRange_ = maxHeight - compactHeightMin_;
+
+	if (chunked)
+	{
+		if (TerrainQuadtree::canChunk(gridSize))
+		{
+			quadtree_ = new TerrainQuadtree();
+		}
+		else
+		{
+			MessageBox(0, "Terrain grid size cannot be chunked, drawing it whole", "Error", MB_OK);
+		}
+	}
+
 	if (createTerrain())
 	{
 		createBuffers();
@@ -100,20 +246,99 @@ void Terrain::initialise(ID3D10Device* device, int gridSize)
 	setTrans();
 }
 
+/*
+	Name		Terrain::initialise
+	Syntax		Terrain::initialise(ID3D10Device* device, const char* fileName, TerrainVertexFormat format,
+							bool chunked)
+	Param		ID3D10Device* device - Pointer to the Direct3D device
+	Param		const char* fileName - A volcano baked with save
+	Param		TerrainVertexFormat format - How to store the vertices on the GPU
+	Param		bool chunked - Draw the terrain in chunks of varying detail
+	Return		bool - False if the file could not be opened, leaving the terrain
+				uninitialised
+	Brief		Initialises the terrain as the completed volcano in the file, with no
+				generation
+*/
+bool Terrain::initialise(ID3D10Device* device, const char* fileName, TerrainVertexFormat format, bool chunked)
+{
+	HeightfieldFile file;
+	if (!file.open(fileName))
+	{
+		MessageBox(0, "Open terrain file - Failed", "Error", MB_OK);
+		return false;
+	}
+
+	initialise(device, file.getSize() - 1, format, chunked);
+	if (!dynamicVertices_)
+		return false;
+
+	// The file's seed is kept so a reset generates from it
+	seed_ = file.getSeed();
+	stream_ = 0;
+	generation_->load(file);
+	target_ = generation_->getPublished();
+	completeGeneration();
+
+	return true;
+}
+
+/*
+	Name		Terrain::save
+	Syntax		Terrain::save(const char* fileName)
+	Param		const char* fileName - The file to write
+	Return		bool - False if the volcano is not complete or the file could not
+				be written
+	Brief		Bakes the completed volcano and its emitters to a file initialise can
+				load
+*/
+bool Terrain::save(const char* fileName) const
+{
+	if (!isComplete_ || !generation_->isIdle())
+		return false;
+
+	return HeightfieldFile::save(fileName, generation_->getHeightfield(), emitters_);
+}
+
 /*
 	Name		Terrain::render
-	Syntax		Terrain::render()
-	Brief		Renders the terrain
+	Syntax		Terrain::render(const D3DXVECTOR3& cameraPos)
+	Param		const D3DXVECTOR3& cameraPos - The camera's position in the world
+	Brief		Sets the terrain's vertex buffers and, when chunked, chooses the chunks
+				to draw from the camera and the scene's world view projection matrix.
+				The index buffers are set with each of the draws from getDraws.
 */
-void Terrain::render()
+void Terrain::render(const D3DXVECTOR3& cameraPos)
 {
+	if (quadtree_)
+	{
+		D3DXMATRIX invWorld;
+		D3DXMatrixInverse(&invWorld, 0, &world_);
+		D3DXVECTOR3 localCamera;
+		D3DXVec3TransformCoord(&localCamera, &cameraPos, &invWorld);
+
+		// Pixels covered by one unit one unit in front of the camera
+		float pixelsPerUnit = Scene::instance()->getProjection()._11 * Scene::instance()->getWidth() * 0.5f;
+
+		quadtree_->select(localCamera, Scene::instance()->getWVP(), pixelsPerUnit);
+	}
+
 	// Set the type of primitive to triangle list
 	d3dDevice_->IASetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-	UINT stride = sizeof(Vertex);
-    UINT offset = 0;
-    d3dDevice_->IASetVertexBuffers(0, 1, &vertexBuffer_, &stride, &offset);
-	d3dDevice_->IASetIndexBuffer(indexBuffer_, DXGI_FORMAT_R32_UINT, 0);
+	if (vertexFormat_ == TERRAIN_VERTEX_COMPACT)
+	{
+		UINT stride = sizeof(TerrainCompactVertex);
+		UINT offset = 0;
+		d3dDevice_->IASetVertexBuffers(0, 1, &compactBuffer_, &stride, &offset);
+	}
+	else
+	{
+		// One stream each for the grid, the animated heights and normals, and the materials
+		ID3D10Buffer* buffers[3] = {staticBuffer_, dynamicBuffer_, typeBuffer_};
+		UINT strides[3] = {sizeof(TerrainStaticVertex), sizeof(TerrainDynamicVertex), sizeof(unsigned int)};
+		UINT offsets[3] = {0, 0, 0};
+		d3dDevice_->IASetVertexBuffers(0, 3, buffers, strides, offsets);
+	}
 
 	return;
 }
@@ -132,31 +357,52 @@ bool Terrain::createTerrain()
 	// Calculate the number of vertices in the terrain mesh
 	verticesNo_ = width_ * height_;
 
-	// Initialise final heights
-	if (!heightMap_)
-	{
-		heightMap_ = new float[verticesNo_];
-		for (unsigned int v = 0; v < verticesNo_; ++v)
-		{
-			heightMap_[v] = 0.0f;
-		}
-	}
+	// Generate the final heights
+	createGeneration();
+	isMoving_.assign(verticesNo_, 0);
 
 	// Three vertices for each face
 	facesNo_ = (width_-1) * (height_-1) * 2;
 
-	vertices_ = new Vertex[verticesNo_];
-	if (!vertices_)
+	dynamicVertices_ = new TerrainDynamicVertex[verticesNo_];
+	types_ = new unsigned int[verticesNo_];
+	if (!dynamicVertices_ || !types_)
 	{
 		return false;
 	}
 
-	indices_ = new DWORD[facesNo_ * 3];
+	// The compact format rebuilds the grid positions in the vertex shader
+	if (vertexFormat_ == TERRAIN_VERTEX_COMPACT)
+	{
+		compactVertices_ = new TerrainCompactVertex[verticesNo_];
+		if (!compactVertices_)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		staticVertices_ = new TerrainStaticVertex[verticesNo_];
+		if (!staticVertices_)
+		{
+			return false;
+		}
+	}
+
+	indices_ = new WORD[facesNo_ * 3];
 	if (!indices_)
 	{
 		return false;
 	}
 
+	// Rows of quads in each band whose vertices 16-bit indices can reach
+	int bandRows = TerrainIndices::SHORT_INDEX_VERTICES / width_ - 1;
+	if (bandRows < 1)
+	{
+		MessageBox(0, "Terrain grid too wide for 16-bit indices", "Error", MB_OK);
+		return false;
+	}
+
 	// Load the vertex array with the terrain data
 	float du = 1.0f / 128.0f;
 	float dv = 1.0f / 128.0f;
@@ -166,59 +412,60 @@ bool Terrain::createTerrain()
 		for (j = 0; j < width_; ++j)
 		{
 			index = i * width_ + j;
-			vertices_[index].pos = D3DXVECTOR3((float)i, 0.0f, (float)j);
-			
-			vertices_[index].normal = D3DXVECTOR3(0.0f, 0.0f, 0.0f);
-			vertices_[index].texC.x = i * du;
-			vertices_[index].texC.y = j * dv;
-			vertices_[index].type = ROCK;
+			if (staticVertices_)
+			{
+				staticVertices_[index].posXZ = D3DXVECTOR2((float)i, (float)j);
+				staticVertices_[index].texC.x = i * du;
+				staticVertices_[index].texC.y = j * dv;
+			}
+
+			dynamicVertices_[index].height = 0.0f;
+			dynamicVertices_[index].normal = D3DXVECTOR3(0.0f, 0.0f, 0.0f);
+			types_[index] = ROCK;
 		}
 	}
 
 	// Drop edges of terrain 
 	for (i = 0; i < width_; i++)
 	{
-		vertices_[i].pos.y = -100.0f;
+		dynamicVertices_[i].height = -100.0f;
 		index = (width_-1) * width_ + i;
-		vertices_[index].pos.y = -100.0f;
+		dynamicVertices_[index].height = -100.0f;
 	}
 
 	for (j = 0; j < height_; j++)
 	{
 		index = j * width_;
-		vertices_[index].pos.y = -100.0f;
+		dynamicVertices_[index].height = -100.0f;
 		index = j * width_ + height_-1;
-		vertices_[index].pos.y = -100.0f;
+		dynamicVertices_[index].height = -100.0f;
 	}
 
-	int k = 0;
-	for (i = 0; i < width_ - 1; ++i)
+	// Each band is triangulated with indices from its first vertex, which
+	// is passed as the base vertex, and ordered for the vertex cache
+	std::vector<unsigned int> band;
+	TerrainDraw draw;
+	draw.indexBuffer = 0;
+	draw.indexFormat = DXGI_FORMAT_R16_UINT;
+	draws_.clear();
+
+	UINT k = 0;
+	for (i = 0; i < height_ - 1; i += bandRows)
 	{
-		for (j = 0; j < height_ - 1; ++j)
-		{
-			if (((i % 2 == 0) && (j % 2 == 0)) ||
-				((i % 2 != 0) && (j % 2 != 0)))
+		int rows = std::min((int)(height_ - 1 - i), bandRows);
 
-			{
-				indices_[k]   = i		* height_ + (j + 1);
-				indices_[k+1] = (i + 1) * height_ + (j + 1);
-				indices_[k+2] = i		* height_ + j;
+		band.clear();
+		TerrainIndices::buildGrid(band, i, rows, width_ - 1, 1, width_);
+		VertexCache::optimise(&band[0], (int)band.size());
 
-				indices_[k+3] = i		* height_ + j;
-				indices_[k+4] = (i + 1) * height_ + (j + 1);
-				indices_[k+5] = (i + 1) * height_ + j;
-			}
-			else
-			{
-				indices_[k]   = i		* height_ + j;
-				indices_[k+1] = i		* height_ + (j + 1);
-				indices_[k+2] = (i + 1) * height_ + j;
+		draw.indexCount = (UINT)band.size();
+		draw.startIndex = k;
+		draw.baseVertex = i * width_;
+		draws_.push_back(draw);
 
-				indices_[k+3] = i		* height_ + (j + 1);
-				indices_[k+4] = (i + 1) * height_ + (j + 1);
-				indices_[k+5] = (i + 1) * height_ + j;
-			}
-			k += 6; // next quad
+		for (j = 0; j < band.size(); ++j)
+		{
+			indices_[k++] = (WORD)band[j];
 		}
 	}
 	return true;
@@ -232,80 +479,179 @@ bool Terrain::createTerrain()
 void Terrain::createBuffers()
 {
 	D3D10_BUFFER_DESC vbd;
-	vbd.Usage = D3D10_USAGE_DYNAMIC;
-	vbd.ByteWidth = sizeof(Vertex) * verticesNo_;
 	vbd.BindFlags = D3D10_BIND_VERTEX_BUFFER;
-	vbd.CPUAccessFlags = D3D10_CPU_ACCESS_WRITE;
+	vbd.CPUAccessFlags = 0;
 	vbd.MiscFlags = 0;
 	D3D10_SUBRESOURCE_DATA vinitData;
-	vinitData.pSysMem = vertices_;
-	d3dDevice_->CreateBuffer(&vbd, &vinitData, &vertexBuffer_);
+
+	if (vertexFormat_ == TERRAIN_VERTEX_COMPACT)
+	{
+		packVertices(0, height_ - 1);
+
+		// Default usage so changed rows can be updated without rewriting the whole buffer
+		vbd.Usage = D3D10_USAGE_DEFAULT;
+		vbd.ByteWidth = sizeof(TerrainCompactVertex) * verticesNo_;
+		vinitData.pSysMem = compactVertices_;
+		d3dDevice_->CreateBuffer(&vbd, &vinitData, &compactBuffer_);
+	}
+	else
+	{
+		// The grid positions and texture coordinates never change
+		vbd.Usage = D3D10_USAGE_IMMUTABLE;
+		vbd.ByteWidth = sizeof(TerrainStaticVertex) * verticesNo_;
+		vinitData.pSysMem = staticVertices_;
+		d3dDevice_->CreateBuffer(&vbd, &vinitData, &staticBuffer_);
+
+		// Default usage so changed rows of heights, normals and materials can be
+		// updated without rewriting the whole buffer
+		vbd.Usage = D3D10_USAGE_DEFAULT;
+		vbd.ByteWidth = sizeof(TerrainDynamicVertex) * verticesNo_;
+		vinitData.pSysMem = dynamicVertices_;
+		d3dDevice_->CreateBuffer(&vbd, &vinitData, &dynamicBuffer_);
+
+		vbd.ByteWidth = sizeof(unsigned int) * verticesNo_;
+		vinitData.pSysMem = types_;
+		d3dDevice_->CreateBuffer(&vbd, &vinitData, &typeBuffer_);
+	}
+
+	// Chunks draw from their own index lists, the whole terrain's are only
+	// needed if they could not be created
+	if (quadtree_)
+	{
+		if (quadtree_->initialise(d3dDevice_, width_ - 1))
+		{
+			quadtree_->updateBounds(dynamicVertices_, 0, height_ - 1);
+			return;
+		}
+
+		delete quadtree_;
+		quadtree_ = 0;
+	}
 
 	D3D10_BUFFER_DESC ibd;
 	ibd.Usage = D3D10_USAGE_IMMUTABLE;
-	ibd.ByteWidth = sizeof(DWORD) * facesNo_ * 3;
+	ibd.ByteWidth = sizeof(WORD) * facesNo_ * 3;
 	ibd.BindFlags = D3D10_BIND_INDEX_BUFFER;
 	ibd.CPUAccessFlags = 0;
 	ibd.MiscFlags = 0;
 	D3D10_SUBRESOURCE_DATA iinitData;
 	iinitData.pSysMem = indices_;
 	d3dDevice_->CreateBuffer(&ibd, &iinitData, &indexBuffer_);
+
+	for (size_t i = 0; i < draws_.size(); ++i)
+	{
+		draws_[i].indexBuffer = indexBuffer_;
+	}
 }
 
 /*
 	Name		Terrain::calculateNormals
 	Syntax		Terrain::calculateNormals()
-	Param		Vertex* vertices - Array of vertices for the terrain
-	Param		DWORD* indices - Array of indices for the terrain
-	Brief		Calculates the normal for each vertex and applies bump mapping to these normals
-				using simplex noise
+	Brief		Calculates the normal for every vertex
 */
 void Terrain::calculateNormals()
+{
+	HeightfieldRegion region;
+	region.rowMin = 0;
+	region.rowMax = (int)width_ - 1;
+	region.columnMin = 0;
+	region.columnMax = (int)height_ - 1;
+	calculateNormals(region);
+}
+
+/*
+	Name		Terrain::calculateNormals
+	Syntax		Terrain::calculateNormals(const HeightfieldRegion& region)
+	Param		const HeightfieldRegion& region - The vertices to recalculate normals for
+	Brief		Calculates the normal for each vertex in the region and applies bump mapping
+				to these normals using the analytic gradient of simplex noise
+*/
+void Terrain::calculateNormals(const HeightfieldRegion& region)
 {
 	// Estimate normals for interior nodes using central difference
 	float invTwoDX = 1.0f / 2.0f;
 	float invTwoDZ = 1.0f / 2.0f;
-	float t, b, l, r;
-	float noiseCoefx, noiseCoefy, noiseCoefz;
 	float factor = 0.2f;
-	
-	for(UINT i = 2; i < width_ - 1; ++i)
-	{
-		for(UINT j = 2; j < height_ - 1; ++j)
-		{
-			t = vertices_[(i - 1) * height_ + j].pos.y;
-			b = vertices_[(i + 1) * height_ + j].pos.y;
-			l = vertices_[i * height_ + j - 1].pos.y;
-			r = vertices_[i * height_ + j + 1].pos.y;
 
-			D3DXVECTOR3 tanZ(0.0f, (t - b) * invTwoDZ, 1.0f);
-			D3DXVECTOR3 tanX(1.0f, (r - l) * invTwoDX, 0.0f);
+	// Scales the noise gradient so the bumps are about as strong as when three
+	// swizzled noise values were added to the normal
+	float bumpScale = 0.25f;
+
+	// Only interior nodes have normals estimated
+	int rowMin = region.rowMin > 2 ? region.rowMin : 2;
+	int rowMax = region.rowMax < (int)width_ - 2 ? region.rowMax : (int)width_ - 2;
+	int columnMin = region.columnMin > 2 ? region.columnMin : 2;
+	int columnMax = region.columnMax < (int)height_ - 2 ? region.columnMax : (int)height_ - 2;
+	if (rowMin > rowMax || columnMin > columnMax)
+		return;
+
+	// Blocks of rows are spread over the worker pool. Each vertex's normal only
+	// reads heights, so the blocks are independent.
+	int rowLength = columnMax - columnMin + 1;
+	int blocks = (rowMax - rowMin) / NORMAL_BLOCK_ROWS + 1;
+	WorkerPool::instance()->parallelFor(blocks, [&](int block)
+	{
+		float t, b, l, r;
 
-			D3DXVECTOR3 n;
-			D3DXVec3Cross(&n, &tanZ, &tanX);
-			D3DXVec3Normalize(&n, &n);
+		// Bump mapping noise and its gradient are evaluated a row at a time through
+		// the batch noise functions
+		std::vector<float> noiseX, noiseY, noiseZ, noiseValue, noiseDX, noiseDY, noiseDZ;
+		if (isComplete_)
+		{
+			noiseX.resize(rowLength);
+			noiseY.resize(rowLength);
+			noiseZ.resize(rowLength);
+			noiseValue.resize(rowLength);
+			noiseDX.resize(rowLength);
+			noiseDY.resize(rowLength);
+			noiseDZ.resize(rowLength);
+		}
 
+		int blockMin = rowMin + block * NORMAL_BLOCK_ROWS;
+		int blockMax = blockMin + NORMAL_BLOCK_ROWS - 1 < rowMax ? blockMin + NORMAL_BLOCK_ROWS - 1 : rowMax;
+		for(int i = blockMin; i <= blockMax; ++i)
+		{
 			if (isComplete_)
 			{
-				noiseCoefx = (float)SimplexNoise::noise(	factor * vertices_[i * height_ + j].pos.x, 
-													factor * vertices_[i * height_ + j].pos.y,
-													factor * vertices_[i * height_ + j].pos.z);
-				noiseCoefy = (float)SimplexNoise::noise(	factor * vertices_[i * height_ + j].pos.y, 
-													factor * vertices_[i * height_ + j].pos.z,
-													factor * vertices_[i * height_ + j].pos.x);
-				noiseCoefz = (float)SimplexNoise::noise( factor * vertices_[i * height_ + j].pos.z, 
-													factor * vertices_[i * height_ + j].pos.x,
-													factor * vertices_[i * height_ + j].pos.y);
-				n.x += noiseCoefx; 
-				n.y += noiseCoefy; 
-				n.z += noiseCoefz; 
-   
-				D3DXVec3Normalize(&n, &n);
+				for (int n = 0; n < rowLength; ++n)
+				{
+					// The grid position of vertex (i, j) is (i, height, j)
+					noiseX[n] = factor * i;
+					noiseY[n] = factor * dynamicVertices_[i * height_ + n + columnMin].height;
+					noiseZ[n] = factor * (n + columnMin);
+				}
+				SimplexNoise::noise3Derivative(&noiseX[0], &noiseY[0], &noiseZ[0], &noiseValue[0],
+					&noiseDX[0], &noiseDY[0], &noiseDZ[0], rowLength);
 			}
+
+			for(int j = columnMin; j <= columnMax; ++j)
+			{
+				t = dynamicVertices_[(i - 1) * height_ + j].height;
+				b = dynamicVertices_[(i + 1) * height_ + j].height;
+				l = dynamicVertices_[i * height_ + j - 1].height;
+				r = dynamicVertices_[i * height_ + j + 1].height;
+
+				D3DXVECTOR3 tanZ(0.0f, (t - b) * invTwoDZ, 1.0f);
+				D3DXVECTOR3 tanX(1.0f, (r - l) * invTwoDX, 0.0f);
+
+				D3DXVECTOR3 n;
+				D3DXVec3Cross(&n, &tanZ, &tanX);
+				D3DXVec3Normalize(&n, &n);
+
+				if (isComplete_)
+				{
+					// Tilt the normal against the part of the gradient in the surface plane
+					D3DXVECTOR3 gradient(noiseDX[j - columnMin], noiseDY[j - columnMin], noiseDZ[j - columnMin]);
+					gradient -= n * D3DXVec3Dot(&gradient, &n);
+					n -= gradient * bumpScale;
+   
+					D3DXVec3Normalize(&n, &n);
+				}
 			
-			vertices_[i * height_ + j].normal = n;
+				dynamicVertices_[i * height_ + j].normal = n;
+			}
 		}
-	}
+	});
 }
 
 /*
@@ -319,88 +665,73 @@ void Terrain::update(float deltaTime)
 	if (age_ > 0)
 		age_ -= deltaTime;
 
-	switch (currentGenStage_)
+	// Generations replaced by a reset are deleted once nothing of theirs is
+	// running, whether or not the current one has finished
+	for (size_t i = 0; i < retired_.size(); )
 	{
-	case GEN_FLAT:
-		if (age_ <= 0)
-		{
-			generateMountain();
-			age_ = 15;
-			currentGenStage_ = GEN_MOUNTAIN;
-		}
-		break;
-	case GEN_MOUNTAIN:
-		if (age_ <= 0)
-		{
-			generateCrater();
-			age_ = 5;
-			currentGenStage_ = GEN_CRATER;
-		}
-		else
-		{
-			updateVertices(deltaTime);
-		}
-		break;
-	case GEN_CRATER:
-		if (age_ <= 0)
+		if (retired_[i]->isIdle())
 		{
-			generateNoise();
-			age_ = 50;
-			currentGenStage_ = GEN_NOISE;
+			delete retired_[i];
+			retired_.erase(retired_.begin() + i);
 		}
 		else
 		{
-			updateVertices(deltaTime);
-		}
-		break;
-	case GEN_NOISE:
-		if (age_ <= 40 && age_ > 30)
-		{
-			generateLavaFlow();
-			age_ = 30.0f;
+			++i;
 		}
-		else if (age_ <= 25 && age_ > 20)
-		{
-			generateLavaFlow();
-			age_ = 20.0f;
-		}
-		else if (age_ <= 15 && age_ > 10)
-		{
-			generateLavaFlow();
-			age_ = 10.0f;
-		}
-		else if (age_ <= 5 && age_ > 0)
-		{
-			generateLavaFlow();
-			age_ = 10.0f;
-			currentGenStage_ = GEN_LAVA_FLOWS;
-		}
-		else
+	}
+
+	if (!isComplete_)
+	{
+		// The noise layer does not depend on the mountain, so it is fetched in
+		// the background while the terrain is still flat
+		if (nextStep_ == 0)
+			generation_->prefetch();
+
+		// Without a pool the stages started only move on here
+		generation_->update(generationBudget_);
+
+		// Take the latest snapshot. Steps skipped since the last one taken hand
+		// over their changed regions with it.
+		HeightfieldSnapshotPtr published = generation_->getPublished();
+		if (published && published != target_)
 		{
-			if (age_ > 40)
-				deltaTime /= 2.5f;
-			updateVertices(deltaTime);
+			target_ = published;
+			if (target_->isComplete)
+			{
+				completeGeneration();
+			}
+			else
+			{
+				addDirtyRegions();
+				emitters_ = target_->emitters;
+				transformEmitters();
+				age_ = GENERATION_STEPS[target_->step].settleTime;
+			}
 		}
-		break;
-	case GEN_LAVA_FLOWS:
-		if (age_ > 0)
+	}
+
+	if (!isComplete_)
+	{
+		// Each step starts once the one before has been taken and has waited out
+		// its settle time, or until its vertices have settled
+		int taken = target_ ? target_->step + 1 : 0;
+		if (nextStep_ == taken && (age_ <= 0 || (taken > 0 && activeRegions_.empty())))
 		{
-			updateVertices(deltaTime);
+			if (nextStep_ < TerrainGeneration::STEP_COMPLETE)
+				generation_->start(nextStep_);
+			else
+				generation_->complete();
+			++nextStep_;
 		}
-		else
+		else if (taken > 0)
 		{
-			currentGenStage_ = GEN_COMPLETE;
-			isComplete_ = true;
-			calculateNormals();
-			createHeightMap();
-			setEmitters();
+			updateVertices(deltaTime * GENERATION_STEPS[target_->step].speed);
 		}
-		break;
-	case GEN_COMPLETE:
-		break;
-	default:
-		break;
 	}
+
+	// Uploads by reset or autoComplete earlier in the frame count towards it
+	frameUploadedBytes_ = uploadedBytes_;
+	uploadedBytes_ = 0;
 }
 
 /*
@@ -418,347 +749,401 @@ void Terrain::setTrans()
 	world_ *= m;
 	D3DXMatrixTranslation(&m, pos_.x, pos_.y, pos_.z);
 	world_ *= m;
+
+	transformEmitters();
 }
 
 /*
-	Name		Terrain::generateMountain
-	Syntax		Terrain::generateMountain()
-	Brief		Generates a mountain by creating a number of mounds stacked 
-				roughly in the centre of the terrain
+	Name		Terrain::createGeneration
+	Syntax		Terrain::createGeneration()
+	Brief		Starts a new generation of the flat terrain from the seed's stream,
+				on the worker pool unless there is a generation budget. The one it
+				replaces is cancelled and kept until its running stages have
+				finished.
 */
-void Terrain::generateMountain()
+void Terrain::createGeneration()
 {
-	int num = 30;
-	int maxRadius = (width_/6);
-	int minRadius = (width_/18);
-	float maxDistance, minDistance;
-	float radius;
-	float moundX, moundZ;
-	float angle, distance;
-	float radiusSq, distanceSq, height, difference;
-	int xMin, xMax, zMin, zMax;
-	int i, x, z;
-
-	for (i = 0; i < num; ++i)
+	if (generation_)
 	{
-		// Mounds have a random radius between 1/5 and 1/9 of the terrain's width
-		radius = (float)(rand() % maxRadius  + minRadius);
-	
-		// Each mound is generated at a random angle and distance from the centre of the terrain
-		angle = (float)(rand() * (2*D3DX_PI) / RAND_MAX);	
-		// Distance from centre is randomised between radius/4 and where the edge of the mound would miss the edge of the terrain
-		maxDistance = width_/2 - radius*2;
-		minDistance = radius/4;
-		distance = (rand() * maxDistance / RAND_MAX) + minDistance;  
-		
-		// Set the centre of the mound
-		moundX = (float)width_/2.0f + cos(angle) * distance;
-		moundZ = (float)height_/2.0f + sin(angle) * distance;
-
-		// We use the square of the radius to avoid having to use squareroot on the distance 
-		radiusSq = radius * radius;
-	
-		// Boundaries for vertices in range of the centre of the mound
-		xMin = (int)(moundX - radius - 1);
-		xMax = (int)(moundX + radius + 1);
-		if (xMin < 0) 
-			xMin = 0;
-		if (xMax >= width_) 
-			xMax = width_ - 1;
-	
-		zMin = (int)(moundZ - radius - 1);
-		zMax = (int)(moundZ + radius + 1);
-		if (zMin < 0) 
-			zMin = 0;
-		if (zMax >= width_) 
-			zMax = width_ - 1;
-	
-		// Calculate height for each vertex in the mound - negative value are outside of the mound's radius
-		for (x = xMin; x <= xMax; ++x)
-		{
-			for(z = zMin; z <= zMax; ++z)
-			{
-				distanceSq = (moundX - x) * (moundX - x) + (moundZ - z) * (moundZ - z);
-				// Use the distance from the centre to determine the height
-				difference = radiusSq - distanceSq;
-			
-				// Ignore if negative
-				if (difference > 0)
-				{
-					// Use the squareroot and dividing factor to create smoother terrain.
-					height = (radius - sqrt(distanceSq))/4;
-					// Add the height to the vertex.
-					heightMap_[x + (z*height_)] += height; 
-				}	
-			}
-		}
+		generation_->cancel();
+		retired_.push_back(generation_);
 	}
+
+	generation_ = new TerrainGeneration(width_, seed_, stream_, NUM_FIRE_SYSTEMS, NUM_SMOKE_SYSTEMS,
+		&noiseCache_, generationBudget_ > 0.0f ? 0 : WorkerPool::instance());
+	target_.reset();
+	nextStep_ = 0;
 }
 
 /*
-	Name		Terrain::generateCrater
-	Syntax		Terrain::generateCrater()
-	Brief		Generates a crater at the heightest point in the terrain
+	Name		Terrain::completeGeneration
+	Syntax		Terrain::completeGeneration()
+	Brief		Completes the terrain from the complete snapshot taken, moving the
+				vertices to their final heights and creating the height map
 */
-void Terrain::generateCrater()
+void Terrain::completeGeneration()
 {
-	// find the highest point on the terrain and centre the crate on it
-	int index;
-	float h = 0;
-	for (int i = 0; i < verticesNo_; i++)
-	{
-		if (heightMap_[i] > h)
-		{
-			h = heightMap_[i];
-			index = i;
-		}
-	}
-	craterX_ = (float)(index%height_);
-	craterZ_ = (float)(index/height_);
-	craterRadius_ = (float)(width_/12.0f);
+	settleVertices();
+	activeRegions_.clear();
+	isMoving_.assign(verticesNo_, 0);
+	nextStep_ = TerrainGeneration::NUM_STEPS;
+	age_ = 0.0f;
 
-	ashEmitter_ = D3DXVECTOR3(craterX_, h + 150.0f, craterZ_);
-	D3DXVec3TransformCoord(&ashEmitter_, &ashEmitter_, &world_);
+	emitters_ = target_->emitters;
+	transformEmitters();
 
-	// We use the square of the radius to avoid having to use squareroot on the distance 
-	float radiusSq = craterRadius_ * craterRadius_;
-	float distanceSq;
-	float height;
-	
-	// Boundaries for vertices in range of the centre of the mound
-	int xMin = (int)(craterX_ - craterRadius_ - 1);
-	int xMax = (int)(craterX_ + craterRadius_ + 1);
-	if (xMin < 0) 
-		xMin = 0;
-	if (xMax >= width_) 
-		xMax = width_ - 1;
-	
-	int zMin = (int)(craterZ_ - craterRadius_ - 1);
-	int zMax = (int)(craterZ_ + craterRadius_ + 1);
-	if (zMin < 0) 
-		zMin = 0;
-	if (zMax >= width_) 
-		zMax = width_ - 1;
-
-	for (int x = xMin; x <= xMax; ++x)
-	{
-		for(int z = zMin; z <= zMax; ++z)
-		{
-			distanceSq = ( craterX_ - x ) * ( craterX_ - x ) + ( craterZ_ - z ) * ( craterZ_ - z );
-			// Use the distance from the centre to determine the heights
-			height = radiusSq - distanceSq;
-			
-			// Ignore if negative
-			if (height > 0)
-			{
-				// Subtract the squareroot of the height from the vertex to create a crater
-				heightMap_[x + (z*height_)] -= sqrt(height); 
-
-				if (height > 625)
-				{
-					vertices_[x + (z*height_)].type = LAVA;
-					D3DXVECTOR3 lavaVertex = D3DXVECTOR3(vertices_[x + (z*height_)].pos.x, heightMap_[x + (z*height_)], vertices_[x + (z*height_)].pos.z);
-					D3DXVec3TransformCoord(&lavaVertex, &lavaVertex, &world_);
-					lavaVertices_.push_back(lavaVertex);
-				}
-			}	
-		}
-	}
+	calculateNormals();
+	createHeightMap();
+	uploadVertices(0, height_ - 1);
+	uploadTypes(0, height_ - 1);
 }
 
 /*
-	Name		Terrain::generateNoise
-	Syntax		Terrain::generateNoise()
-	Brief		Generates noise
+	Name		Terrain::settleVertices
+	Syntax		Terrain::settleVertices()
+	Brief		Moves the vertices straight to their final heights and materials and
+				marks the volcano complete. The edges of the terrain stay dropped.
 */
-void Terrain::generateNoise()
+void Terrain::settleVertices()
 {
-	int index;
-	for (int i = 1; i < (height_-1); ++i)
+	const float* heights = &target_->heights[0];
+	const unsigned int* types = &target_->types[0];
+
+	for (UINT i = 1; i < height_ - 1; ++i)
 	{
-		for (int j = 1; j < (width_-1); ++j)
+		for (UINT j = 1; j < width_ - 1; ++j)
 		{
-			index = i * width_ + j;
-			heightMap_[index] += (float)SimplexNoise::ridgedMultifractal(i/128.0f, j/128.0f, 10, 1.5f, 0.5f, 1.0f) * 35.0f;
+			dynamicVertices_[i * width_ + j].height = heights[i * width_ + j];
 		}
 	}
+
+	for (DWORD i = 0; i < verticesNo_; ++i)
+	{
+		types_[i] = types[i];
+	}
+
+	isComplete_ = true;
 }
 
 /*
-	Name		Terrain::generateLavaFlow
-	Syntax		Terrain::generateLavaFlow()
-	Brief		Generates a lava flow from the crater to the edge of the terrain
+	Name		Terrain::addDirtyRegions
+	Syntax		Terrain::addDirtyRegions()
+	Brief		Takes the regions changed by the snapshot taken, copies their rock
+				and lava materials to the vertices and adds the vertices in them that
+				are away from their final heights to the active regions. Overlapping
+				regions are merged so no vertex is visited twice.
 */
-void Terrain::generateLavaFlow()
+void Terrain::addDirtyRegions()
 {
-
-	// Pick random angle and position lava flow from the edge of the crater flowing outwards at that angle
-	float angle = (float)(rand() * (2*D3DX_PI) / RAND_MAX);
-	float startX = craterX_ + cos(angle) * (craterRadius_ - 25.0f);
-	float startZ = craterZ_ + sin(angle) * (craterRadius_ - 25.0f);
-	float destinationX = craterX_ + cos(angle) * (craterRadius_ + 50.0f);
-	float destinationZ = craterZ_ + sin(angle) * (craterRadius_ + 50.0f);
-	D3DXVECTOR3 direction = D3DXVECTOR3(destinationX-startX, 0.0f, destinationZ-startZ);
-	D3DXVec3Normalize(&direction, &direction);
-
-	float flowX = startX;
-	float flowZ = startZ;
-	int acrossX, acrossZ;
-	int count = 0;
-	float halfWidth = 10.0f;
-	float depth = 15.0f;
-	float curve = 25.0f;
-
-	bool* changed = new bool[verticesNo_];
-	for (int i = 0; i < verticesNo_; i++)
+	const std::vector<HeightfieldRegion>& dirty = target_->dirtyRegions;
+	const float* heights = &target_->heights[0];
+	const unsigned int* types = &target_->types[0];
+	int lastRow = (int)height_ - 1;
+	int lastColumn = (int)width_ - 1;
+	int i, j, index;
+
+	for (size_t d = 0; d < dirty.size(); ++d)
 	{
-		changed[i] = false;
-	}
-	D3DXVECTOR3 acrossFlow;
-	float depthChange;
-	int index;
-	while (flowX >= 1 && flowX < (width_-1) && flowZ >= 1 && flowZ < (height_-1))
-	{
-		// Find the vector perpendicular to the direction of the lava flow
-		D3DXVec3Cross(&acrossFlow, &direction, &D3DXVECTOR3(0.0f, 1.0f, 0.0f));
-		D3DXVec3Normalize(&acrossFlow, &acrossFlow);
-		
-		// Sets depths for all vectors across the width of the lava flow
-		for (int j = (int)(-halfWidth); j < (int)halfWidth; j++) 
+		for (i = dirty[d].rowMin; i <= dirty[d].rowMax; ++i)
 		{
-			// Cosine curve used to generate depths across the lava flow - This creates a deep v-shaped curve
-			depthChange = depth * (cos(D3DX_PI * (float)j/halfWidth) + 0.8f);
-
-			acrossX = (int)(flowX - (acrossFlow.x * halfWidth) + (acrossFlow.x * j));
-			acrossZ = (int)(flowZ - (acrossFlow.z * halfWidth) + (acrossFlow.z * j));
-
-			if (acrossX >= 0 && acrossX < width_ && acrossZ >= 0 && acrossZ < height_)
+			for (j = dirty[d].columnMin; j <= dirty[d].columnMax; ++j)
+			{
+				types_[i * width_ + j] = types[i * width_ + j];
+			}
+		}
+		uploadTypes(dirty[d].rowMin, dirty[d].rowMax);
+
+		// The edges of the terrain stay dropped
+		TerrainRegion region;
+		int rowMin = dirty[d].rowMin > 1 ? dirty[d].rowMin : 1;
+		int rowMax = dirty[d].rowMax < lastRow - 1 ? dirty[d].rowMax : lastRow - 1;
+		int columnMin = dirty[d].columnMin > 1 ? dirty[d].columnMin : 1;
+		int columnMax = dirty[d].columnMax < lastColumn - 1 ? dirty[d].columnMax : lastColumn - 1;
+		for (i = rowMin; i <= rowMax; ++i)
+		{
+			for (j = columnMin; j <= columnMax; ++j)
 			{
-				index = acrossX + acrossZ * height_;
-				if (!changed[index])
+				index = i * width_ + j;
+				if (!isMoving_[index] && std::fabs(heights[index] - dynamicVertices_[index].height) > HEIGHT_EPSILON)
 				{
-					heightMap_[index] -= depthChange;
-					if (j > (-halfWidth+5) && j < (halfWidth-5))
-					{
-						vertices_[index].type = LAVA;
-						D3DXVECTOR3 lavaVertex = D3DXVECTOR3(vertices_[index].pos.x, heightMap_[index], vertices_[index].pos.z);
-						D3DXVec3TransformCoord(&lavaVertex, &lavaVertex, &world_);
-						lavaVertices_.push_back(lavaVertex);
-					}
-					changed[index] = true;
+					isMoving_[index] = 1;
+					region.vertices.push_back(index);
 				}
 			}
 		}
 
-		// Follow a sine wave pattern along the direction vector
-		flowZ += direction.z/10 + sin(count/(curve*10))/20;
-		flowX += direction.x/10 + sin(count/(curve*10))/20;
-		count++;
-	}
+		if (region.vertices.empty())
+			continue;
 
-	delete changed;
+		// A height changes the normals of the vertices next to it, so add a one vertex border
+		region.bounds.rowMin = dirty[d].rowMin > 0 ? dirty[d].rowMin - 1 : 0;
+		region.bounds.rowMax = dirty[d].rowMax < lastRow ? dirty[d].rowMax + 1 : lastRow;
+		region.bounds.columnMin = dirty[d].columnMin > 0 ? dirty[d].columnMin - 1 : 0;
+		region.bounds.columnMax = dirty[d].columnMax < lastColumn ? dirty[d].columnMax + 1 : lastColumn;
+
+		// Grow the region over any active region it overlaps, starting again each
+		// time as the grown region may now overlap ones already checked
+		HeightfieldRegion& bounds = region.bounds;
+		size_t a = 0;
+		while (a < activeRegions_.size())
+		{
+			const HeightfieldRegion& active = activeRegions_[a].bounds;
+			if (active.rowMin <= bounds.rowMax && active.rowMax >= bounds.rowMin &&
+				active.columnMin <= bounds.columnMax && active.columnMax >= bounds.columnMin)
+			{
+				if (active.rowMin < bounds.rowMin)
+					bounds.rowMin = active.rowMin;
+				if (active.rowMax > bounds.rowMax)
+					bounds.rowMax = active.rowMax;
+				if (active.columnMin < bounds.columnMin)
+					bounds.columnMin = active.columnMin;
+				if (active.columnMax > bounds.columnMax)
+					bounds.columnMax = active.columnMax;
+
+				const std::vector<DWORD>& moving = activeRegions_[a].vertices;
+				region.vertices.insert(region.vertices.end(), moving.begin(), moving.end());
+				activeRegions_.erase(activeRegions_.begin() + a);
+				a = 0;
+			}
+			else
+			{
+				++a;
+			}
+		}
+		activeRegions_.push_back(region);
+	}
 }
 
 /*
 	Name		Terrain::updateVertices
 	Syntax		Terrain::updateVertices(float deltaTime)
 	Param		float deltaTime - Time between frames
-	Brief		Updates the vertices, interpolating towards final heights
+	Brief		Moves the vertices in the active regions towards their final heights.
+				A vertex is snapped to its height and leaves its region once it is
+				within HEIGHT_EPSILON or too close for a step to move it, so the cost
+				follows the number of vertices still moving. Normals are recalculated
+				and rows uploaded only for regions with vertices that moved, and a
+				region is dropped once all its vertices have settled.
 */
 void Terrain::updateVertices(float deltaTime)
 {
-	int index;
+	const float* heights = &target_->heights[0];
+	DWORD index;
 	float diff = 0.0f;
-	bool changed = false;
+	float previous;
+	size_t r, v;
 	deltaTime /= 10.0f;
-	for (int i = 1; i < (height_-1); ++i)
+
+	// Nothing moves in a paused frame, and every vertex would look settled
+	if (deltaTime <= 0.0f)
+		return;
+
+	// First and last row of each region that moved
+	std::vector<std::pair<int, int> > rows;
+
+	for (r = 0; r < activeRegions_.size(); ++r)
 	{
-		for (int j = 1; j < (width_-1); ++j)
+		std::vector<DWORD>& moving = activeRegions_[r].vertices;
+
+		v = 0;
+		while (v < moving.size())
 		{
-			index = i * width_ + j;
-			diff = heightMap_[index] - vertices_[index].pos.y;
-			if (diff)
+			index = moving[v];
+			diff = heights[index] - dynamicVertices_[index].height;
+			previous = dynamicVertices_[index].height;
+			dynamicVertices_[index].height += diff * deltaTime;
+
+			if (std::fabs(diff) <= HEIGHT_EPSILON || dynamicVertices_[index].height == previous)
+			{
+				// Settled, so swap the last moving vertex into its place
+				dynamicVertices_[index].height = heights[index];
+				isMoving_[index] = 0;
+				moving[v] = moving.back();
+				moving.pop_back();
+			}
+			else
 			{
-				vertices_[index].pos.y += diff * deltaTime;
-				changed = true;
+				++v;
 			}
 		}
+
+		rows.push_back(std::make_pair(activeRegions_[r].bounds.rowMin, activeRegions_[r].bounds.rowMax));
 	}
-	
-	if (changed)
+
+	if (rows.empty())
+		return;
+
+	// Normals are recalculated once every region has moved, as a region's
+	// border may sit next to another region
+	for (r = 0; r < activeRegions_.size(); ++r)
 	{
-		calculateNormals();
+		calculateNormals(activeRegions_[r].bounds);
+	}
 
-		// Initialize the vertex buffer pointer
-		void* verts = 0;
+	// Regions whose last vertices have just settled are finished
+	r = 0;
+	while (r < activeRegions_.size())
+	{
+		if (activeRegions_[r].vertices.empty())
+			activeRegions_.erase(activeRegions_.begin() + r);
+		else
+			++r;
+	}
 
-		// Lock the vertex buffer
-		HRESULT hr = vertexBuffer_->Map(D3D10_MAP_WRITE_DISCARD, 0, (void**)&verts);
-		if(FAILED(hr))
+	// Upload each run of overlapping rows once
+	std::sort(rows.begin(), rows.end());
+	int firstRow = rows[0].first;
+	int lastRow = rows[0].second;
+	for (r = 1; r < rows.size(); ++r)
+	{
+		if (rows[r].first > lastRow + 1)
 		{
-			MessageBox(0, "Updating terrain vertices - Failed", "Error", MB_OK);
+			uploadVertices(firstRow, lastRow);
+			firstRow = rows[r].first;
 		}
+		if (rows[r].second > lastRow)
+			lastRow = rows[r].second;
+	}
+	uploadVertices(firstRow, lastRow);
+}
 
-		// Copy the data into the vertex buffer
-		memcpy(verts, (void*)vertices_, (sizeof(Vertex) * verticesNo_));
+/*
+	Name		Terrain::uploadVertices
+	Syntax		Terrain::uploadVertices(UINT firstRow, UINT lastRow)
+	Param		UINT firstRow - The first row of vertices to copy to the vertex buffer
+	Param		UINT lastRow - The last row of vertices to copy
+	Brief		Copies a span of rows of heights and normals into their vertex buffer.
+				The compact format packs and copies the rows' materials with them.
+				The bounds of the chunks holding the rows are updated to match.
+*/
+void Terrain::uploadVertices(UINT firstRow, UINT lastRow)
+{
+	if (quadtree_)
+		quadtree_->updateBounds(dynamicVertices_, firstRow, lastRow);
 
-		// Unlock the vertex buffer
-		vertexBuffer_->Unmap();
+	if (vertexFormat_ == TERRAIN_VERTEX_COMPACT)
+	{
+		packVertices(firstRow, lastRow);
+		uploadRows(compactBuffer_, compactVertices_, sizeof(TerrainCompactVertex), firstRow, lastRow);
 	}
+	else
+	{
+		uploadRows(dynamicBuffer_, dynamicVertices_, sizeof(TerrainDynamicVertex), firstRow, lastRow);
+	}
+}
+
+/*
+	Name		Terrain::uploadTypes
+	Syntax		Terrain::uploadTypes(UINT firstRow, UINT lastRow)
+	Param		UINT firstRow - The first row of materials to copy to the vertex buffer
+	Param		UINT lastRow - The last row of materials to copy
+	Brief		Copies a span of rows of materials into their vertex buffer
+*/
+void Terrain::uploadTypes(UINT firstRow, UINT lastRow)
+{
+	if (vertexFormat_ == TERRAIN_VERTEX_COMPACT)
+		uploadVertices(firstRow, lastRow);
+	else
+		uploadRows(typeBuffer_, types_, sizeof(unsigned int), firstRow, lastRow);
+}
+
+/*
+	Name		Terrain::packVertices
+	Syntax		Terrain::packVertices(UINT firstRow, UINT lastRow)
+	Param		UINT firstRow, lastRow - The span of rows to pack
+	Brief		Packs heights, normals and materials into compact vertices. The
+				compact range holds any height the terrain's size can generate, the
+				clamp only guards against rounding.
+*/
+void Terrain::packVertices(UINT firstRow, UINT lastRow)
+{
+	float heightScale = 65535.0f / compactHeightRange_;
+	float height;
+	DWORD end = (lastRow + 1) * width_;
+
+	for (DWORD index = firstRow * width_; index < end; ++index)
+	{
+		height = (dynamicVertices_[index].height - compactHeightMin_) * heightScale + 0.5f;
+		if (height < 0.0f)
+			height = 0.0f;
+		if (height > 65535.0f)
+			height = 65535.0f;
+
+		compactVertices_[index].height = (unsigned short)height;
+		encodeOctahedral(dynamicVertices_[index].normal, compactVertices_[index].normal);
+		compactVertices_[index].type = (unsigned short)types_[index];
+	}
+}
+
+/*
+	Name		Terrain::uploadRows
+	Syntax		Terrain::uploadRows(ID3D10Buffer* buffer, const void* data, UINT stride,
+									UINT firstRow, UINT lastRow)
+	Param		ID3D10Buffer* buffer - The vertex buffer to update
+	Param		const void* data - The whole stream the buffer was created from
+	Param		UINT stride - The size of one vertex in the stream
+	Param		UINT firstRow, lastRow - The span of rows to copy
+	Brief		Copies a span of whole rows into a vertex buffer. Rows are contiguous
+				in the buffer, so this is one UpdateSubresource however many rows.
+*/
+void Terrain::uploadRows(ID3D10Buffer* buffer, const void* data, UINT stride, UINT firstRow, UINT lastRow)
+{
+	D3D10_BOX box;
+	box.left = firstRow * width_ * stride;
+	box.right = (lastRow + 1) * width_ * stride;
+	box.top = 0;
+	box.bottom = 1;
+	box.front = 0;
+	box.back = 1;
+
+	d3dDevice_->UpdateSubresource(buffer, 0, &box, (const char*)data + box.left, 0, 0);
+	uploadedBytes_ += box.right - box.left;
 }
 
 /*
 	Name		Terrain::reset
 	Syntax		Terrain::reset()
-	Brief		Resets the terrain generation
+	Brief		Resets the terrain generation, starting a new volcano from the seed's
+				next stream without waiting for the old one's stages to stop
 */
 void Terrain::reset()
 {
+	++stream_;
+	createGeneration();
+
 	for (int i = 0; i < verticesNo_; ++i)
 	{
-		vertices_[i].pos.y = heightMap_[i] = 0.0f;
-		vertices_[i].type = ROCK;
+		dynamicVertices_[i].height = 0.0f;
+		types_[i] = ROCK;
 	}
 
 	int index;
 	// Drop edges of terrain 
 	for (int i = 0; i < width_; i++)
 	{
-		vertices_[i].pos.y = -100.0f;
+		dynamicVertices_[i].height = -100.0f;
 		index = (width_-1) * width_ + i;
-		vertices_[index].pos.y = -100.0f;
+		dynamicVertices_[index].height = -100.0f;
 	}
 
 	for (int j = 0; j < height_; j++)
 	{
 		index = j * width_;
-		vertices_[index].pos.y = -100.0f;
+		dynamicVertices_[index].height = -100.0f;
 		index = j * width_ + height_-1;
-		vertices_[index].pos.y = -100.0f;
+		dynamicVertices_[index].height = -100.0f;
 	}
 
-	currentGenStage_ = GEN_FLAT;
 	age_ = 5.0f;
 	clearEmitters();
 	isComplete_ = false;
 
-	calculateNormals();
-
-	// Initialize the vertex buffer pointer
-	void* verts = 0;
-
-	// Lock the vertex buffer
-	HRESULT hr = vertexBuffer_->Map(D3D10_MAP_WRITE_DISCARD, 0, (void**)&verts);
-	if(FAILED(hr))
-	{
-		MessageBox(0, "Updating terrain vertices - Failed", "Error", MB_OK);
-	}
-
-	// Copy the data into the vertex buffer
-	memcpy(verts, (void*)vertices_, (sizeof(Vertex) * verticesNo_));
+	activeRegions_.clear();
+	isMoving_.assign(verticesNo_, 0);
 
-	// Unlock the vertex buffer
-	vertexBuffer_->Unmap();
+	calculateNormals();
+	uploadVertices(0, height_ - 1);
+	uploadTypes(0, height_ - 1);
 }
 
 /*
@@ -930,75 +1315,60 @@ void Terrain::setScale(float x, float y, float z)
 }
 
 /*
-	Name		Terrain::autoComplete
-	Syntax		Terrain::autoComplete()
-	Brief		Autocompletes the terrain generation and updates all the vertices to their final positions
+	Name		Terrain::setSeed
+	Syntax		Terrain::setSeed(unsigned int seed)
+	Param		unsigned int seed - The seed for the random mountain, lava flows and emitters
+	Brief		Sets the seed the next generation draws from. Call before initialise
+				or reset to reproduce a volcano.
 */
-void Terrain::autoComplete()
+void Terrain::setSeed(unsigned int seed)
 {
-	int i;
-	if (currentGenStage_ == GEN_FLAT)
-	{
-		generateMountain();
-		currentGenStage_ = GEN_MOUNTAIN;
-	}
-	if (currentGenStage_ == GEN_MOUNTAIN)
-	{
-		generateCrater();
-		currentGenStage_ = GEN_NOISE;
-	}
-	if (currentGenStage_ == GEN_NOISE)
-	{
-		generateNoise();
-		currentGenStage_ = GEN_LAVA_FLOWS;
-		age_ = 41;
-	}
-	if (currentGenStage_ == GEN_LAVA_FLOWS)
-	{
-		int flows;
-		if (age_ > 40)
-			flows = 4;
-		else if (age_ > 25)
-			flows = 3;
-		else if (age_ >15)
-			flows = 2;
-		else
-			flows = 1;
-
-		for (i = 0; i < flows; ++i)
-		{
-			generateLavaFlow();
-		}
-		currentGenStage_ = GEN_COMPLETE;
-		isComplete_ = true;
-		createHeightMap();
-		setEmitters();
-	}
-		
-	age_ = 0.0f;
-
-	for (i = 0; i < verticesNo_; ++i)
-	{
-		vertices_[i].pos.y = heightMap_[i];
-	}
+	seed_ = seed;
+	stream_ = 0;
+}
 
-	calculateNormals();
+/*
+	Name		Terrain::setGenerationBudget
+	Syntax		Terrain::setGenerationBudget(float milliseconds)
+	Param		float milliseconds - Time each frame spends generating, in slices, on
+				the thread calling update, or 0 to generate on the worker pool
+	Brief		Sets how the next generation runs. Call before initialise or reset.
+				A budget keeps frame times flat on machines with no workers to spare.
+*/
+void Terrain::setGenerationBudget(float milliseconds)
+{
+	generationBudget_ = milliseconds > 0.0f ? milliseconds : 0.0f;
+}
 
-	// Initialize the vertex buffer pointer
-	void* verts = 0;
+/*
+	Name		Terrain::getGenerationProgress
+	Syntax		Terrain::getGenerationProgress()
+	Return		float - How much of the volcano has been generated, from 0 to 1. The
+				animated generation waits between steps for the vertices to settle.
+*/
+float Terrain::getGenerationProgress() const
+{
+	if (isComplete_)
+		return 1.0f;
 
-	// Lock the vertex buffer
-	HRESULT hr = vertexBuffer_->Map(D3D10_MAP_WRITE_DISCARD, 0, (void**)&verts);
-	if(FAILED(hr))
-	{
-		MessageBox(0, "Updating terrain vertices - Failed", "Error", MB_OK);
-	}
+	return generation_ ? generation_->getProgress() : 0.0f;
+}
 
-	// Copy the data into the vertex buffer
-	memcpy(verts, (void*)vertices_, (sizeof(Vertex) * verticesNo_));
+/*
+	Name		Terrain::autoComplete
+	Syntax		Terrain::autoComplete()
+	Brief		Starts every generation step not yet started, stages that do not depend
+				on each other at the same time, without waiting. The vertices move
+				straight to their final positions once the complete volcano is
+				published.
+*/
+void Terrain::autoComplete()
+{
+	if (isComplete_ || !generation_)
+		return;
 
-	// Unlock the vertex buffer
-	vertexBuffer_->Unmap();
+	generation_->complete();
+	nextStep_ = TerrainGeneration::NUM_STEPS;
 }
 
 /*
@@ -1012,7 +1382,7 @@ void Terrain::createHeightMap()
 	// and need to be translated to world space first before they are loaded into the
 	// texture.
 	D3D10_SUBRESOURCE_DATA initData;
-	initData.pSysMem = heightMap_;
+	initData.pSysMem = &target_->heights[0];
 	initData.SysMemPitch = width_ * sizeof(float);
 	initData.SysMemSlicePitch = height_ * sizeof(float);
 
@@ -1062,34 +1432,38 @@ void Terrain::createHeightMap()
 }
 
 /*
-	Name		Terrain::setEmitters
-	Syntax		Terrain::setEmitters()
-	Brief		Sets the fire and smoke emitters by picking random lava vertices
+	Name		Terrain::clearEmitters
+	Syntax		Terrain::clearEmitters()
+	Brief		Clears the emitters
 */
-void Terrain::setEmitters()
+void Terrain::clearEmitters()
 {
-	int i, j;
-	for (i = 0; i < NUM_FIRE_SYSTEMS; ++i)
-	{
-		j = rand() % lavaVertices_.size();
-		fireEmitters_.push_back(lavaVertices_[j]);
-	}
-
-	for (i = 0; i < NUM_SMOKE_SYSTEMS; ++i)
-	{
-		j = rand() % lavaVertices_.size();
-		smokeEmitters_.push_back(lavaVertices_[j]);
-	}
+	emitters_.clear();
+	fireEmitters_.clear();
+	smokeEmitters_.clear();
 }
 
 /*
-	Name		Terrain::clearEmitters
-	Syntax		Terrain::clearEmitters()
-	Brief		Clears the fire and smoke emitters
+	Name		Terrain::transformEmitters
+	Syntax		Terrain::transformEmitters()
+	Brief		Places the emitters in the world, so they follow the terrain as it moves
 */
-void Terrain::clearEmitters()
+void Terrain::transformEmitters()
 {
 	fireEmitters_.clear();
 	smokeEmitters_.clear();
-	lavaVertices_.clear();
+
+	D3DXVECTOR3 emitter;
+	for (size_t i = 0; i < emitters_.size(); ++i)
+	{
+		emitter = D3DXVECTOR3(emitters_[i].position.x, emitters_[i].position.y, emitters_[i].position.z);
+		D3DXVec3TransformCoord(&emitter, &emitter, &world_);
+
+		if (emitters_[i].type == EMITTER_ASH)
+			ashEmitter_ = emitter;
+		else if (emitters_[i].type == EMITTER_FIRE)
+			fireEmitters_.push_back(emitter);
+		else
+			smokeEmitters_.push_back(emitter);
+	}
 }
@@ -15,23 +15,21 @@
 #include <stdio.h>
 #include <fstream>
 #include <vector>
+#include "Geometry/Heightfield.hpp"
+#include "Geometry/HeightfieldFile.hpp"
+#include "Geometry/TerrainGeneration.hpp"
+#include "Geometry/TerrainQuadtree.hpp"
+#include "Graphics/Vertex.hpp"
 
-struct Vertex;
-
-enum TerrainGenerationStage 
-{
-	GEN_FLAT,
-	GEN_MOUNTAIN,
-	GEN_CRATER,
-	GEN_NOISE,
-	GEN_LAVA_FLOWS,
-	GEN_COMPLETE
-};
-
-enum TerrainType
+/*
+	Name		TerrainRegion
+	Brief		A region of the terrain still settling after a generation stage and the
+				vertices in it that have not reached their final heights
+*/
+struct TerrainRegion
 {
-	ROCK,
-	LAVA,
+	HeightfieldRegion bounds;
+	std::vector<DWORD> vertices;
 };
 
 class Terrain
@@ -39,11 +37,20 @@ class Terrain
 public:
 	Terrain();
 	~Terrain();
-	void initialise(ID3D10Device* device, int gridSize);
+	void initialise(ID3D10Device* device, int gridSize, TerrainVertexFormat format = TERRAIN_VERTEX_FULL,
+					bool chunked = false);
+	bool initialise(ID3D10Device* device, const char* fileName, TerrainVertexFormat format = TERRAIN_VERTEX_FULL,
+					bool chunked = false);
+	bool save(const char* fileName) const;
 	void update(float deltaTime);
-	void render(); 
+	void render(const D3DXVECTOR3& cameraPos); 
 	DWORD getNumVertices()	const { return verticesNo_; };
 	DWORD getNumIndices()	const { return facesNo_ * 3; };
+	const std::vector<TerrainDraw>& getDraws() const { return quadtree_ ? quadtree_->getDraws() : draws_; };
+	UINT getGridWidth()		const { return width_; };
+	TerrainVertexFormat getVertexFormat() const { return vertexFormat_; };
+	float getCompactHeightMin() const { return compactHeightMin_; };
+	float getCompactHeightRange() const { return compactHeightRange_; };
 	D3DXMATRIX getWorld()	const { return world_; };
 	D3DXVECTOR3 getAshEmitter() const { return ashEmitter_; };
 	D3DXVECTOR3 getFireEmitter(int i) const { return fireEmitters_[i]; };
@@ -64,24 +71,34 @@ public:
 	void increaseScaleY(float y);
 	void increaseScaleZ(float z);
 	void setScale(float x, float y, float z);
+	void setSeed(unsigned int seed);
+	unsigned int getSeed() const { return seed_; };
+	void setGenerationBudget(float milliseconds);
+	float getGenerationBudget() const { return generationBudget_; };
+	float getGenerationProgress() const;
 	bool isComplete() const { return isComplete_; };
+	UINT getUploadedBytes() const { return frameUploadedBytes_; };
 
 private:
 	bool createTerrain();
+	void createGeneration();
+	void completeGeneration();
 	void createBuffers();
 	void calculateNormals();
+	void calculateNormals(const HeightfieldRegion& region);
 	void setTrans();
-	void generateMountain();
-	void generateCrater();
-	void generateNoise();
-	void generateLavaFlow();
+	void settleVertices();
+	void addDirtyRegions();
 	void updateVertices(float deltaTime);
+	void uploadVertices(UINT firstRow, UINT lastRow);
+	void uploadTypes(UINT firstRow, UINT lastRow);
+	void uploadRows(ID3D10Buffer* buffer, const void* data, UINT stride, UINT firstRow, UINT lastRow);
+	void packVertices(UINT firstRow, UINT lastRow);
 	void createHeightMap();
-	void setEmitters();
 	void clearEmitters();
+	void transformEmitters();
 		
-	TerrainGenerationStage currentGenStage_;
-
+	// Seconds left before the next generation step
 	float age_;
 
 	D3DXMATRIX world_;
@@ -90,28 +107,72 @@ private:
 	DWORD verticesNo_;
 	DWORD facesNo_;
 
-	Vertex* vertices_;
-	float* heightMap_;
-	DWORD* indices_;
+	// The vertices are split into streams by how often they change. Heights,
+	// normals and materials are packed into compactVertices_ to upload them in
+	// the compact format, which has no static stream.
+	TerrainVertexFormat vertexFormat_;
+	TerrainStaticVertex* staticVertices_;
+	TerrainDynamicVertex* dynamicVertices_;
+	unsigned int* types_;
+	TerrainCompactVertex* compactVertices_;
+
+	// The heights compact vertices are quantized across, wide enough for any
+	// volcano of the terrain's size
+	float compactHeightMin_;
+	float compactHeightRange_;
+	WORD* indices_;
 
 	ID3D10Device* d3dDevice_;
-	ID3D10Buffer* vertexBuffer_;
+	ID3D10Buffer* staticBuffer_;
+	ID3D10Buffer* dynamicBuffer_;
+	ID3D10Buffer* typeBuffer_;
+	ID3D10Buffer* compactBuffer_;
 	ID3D10Buffer* indexBuffer_;
+
+	// Chunks the terrain is drawn in when chunked, otherwise the bands of rows
+	// in draws_, each small enough for 16-bit indices
+	TerrainQuadtree* quadtree_;
+	std::vector<TerrainDraw> draws_;
+
+	// Vertex data sent to the vertex buffers since the last update, and during it
+	UINT uploadedBytes_;
+	UINT frameUploadedBytes_;
 	
 	UINT width_;
 	UINT height_;
 
-	float craterX_;
-	float craterZ_;
-	float craterRadius_;
-
+	// Emitters in local space, and in the world for the particle systems
+	std::vector<HeightfieldEmitter> emitters_;
 	D3DXVECTOR3 ashEmitter_;
 	std::vector<D3DXVECTOR3> fireEmitters_;
 	std::vector<D3DXVECTOR3> smokeEmitters_;
-	std::vector<D3DXVECTOR3> lavaVertices_;
 
 	bool isComplete_;
 
+	// Generates the target heights and materials in the background, from the
+	// seed's stream. Generations replaced by a reset are cancelled and deleted
+	// once none of their stages is running.
+	TerrainGeneration* generation_;
+	std::vector<TerrainGeneration*> retired_;
+	SimplexNoise::NoiseFieldCache noiseCache_;
+	unsigned int seed_;
+	unsigned int stream_;
+
+	// Milliseconds a frame spends generating on the main thread, or 0 to
+	// generate on the worker pool
+	float generationBudget_;
+
+	// The latest snapshot taken, whose heights the vertices move towards, and
+	// the number of generation steps started
+	HeightfieldSnapshotPtr target_;
+	int nextStep_;
+
+	// Disjoint regions of vertices still moving towards the heightfield, each
+	// with a one vertex border for the normals its heights affect. isMoving_
+	// flags the vertices held by a region so none is held twice.
+	std::vector<TerrainRegion> activeRegions_;
+	std::vector<char> isMoving_;
+
 	ID3D10ShaderResourceView* heightMapRV_;
 };
 
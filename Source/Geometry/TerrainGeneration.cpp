@@ -0,0 +1,424 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Terrain Generation
+	Brief		Definition of TerrainGeneration Class
+*/
+
+#include "Geometry/TerrainGeneration.hpp"
+
+namespace
+{
+	// Resources of the generation's own nodes, after the heightfield's
+	const unsigned int GENERATION_EMITTERS = HEIGHTFIELD_FIRST_FREE_RESOURCE;
+	const unsigned int GENERATION_SNAPSHOT = HEIGHTFIELD_FIRST_FREE_RESOURCE << 1;
+
+	// Height of the ash emitter above the crater's peak
+	const float ASH_HEIGHT = 150.0f;
+
+	// Rows of the heightfield each slice of a publish copies
+	const int PUBLISH_SLICE_ROWS = 64;
+}
+
+/*
+	Name		TerrainGeneration::TerrainGeneration
+	Syntax		TerrainGeneration(int size, unsigned int seed, unsigned int stream, int fireEmitters,
+								  int smokeEmitters, SimplexNoise::NoiseFieldCache* noiseCache,
+								  WorkerPool* pool)
+	Param		int size - The number of vertices along each side
+	Param		unsigned int seed, stream - The seed and stream to draw from, see
+				Heightfield::setSeed
+	Param		int fireEmitters, smokeEmitters - The emitters a complete volcano has
+	Param		SimplexNoise::NoiseFieldCache* noiseCache - Cache shared with the
+				generations before and after, so the noise layer is built once
+	Param		WorkerPool* pool - Pool to run the stages on, or 0 to run them in
+				slices from update
+	Brief		Builds the graph for a flat heightfield, starting nothing. Each step's
+				stages are followed by a node publishing its snapshot.
+*/
+TerrainGeneration::TerrainGeneration(int size, unsigned int seed, unsigned int stream, int fireEmitters,
+	int smokeEmitters, SimplexNoise::NoiseFieldCache* noiseCache, WorkerPool* pool)
+: fireEmitters_(fireEmitters),
+  smokeEmitters_(smokeEmitters),
+  isCompleting_(false),
+  graph_(pool)
+{
+	heightfield_.setNoiseCache(noiseCache);
+	heightfield_.setSeed(seed, stream);
+	heightfield_.initialise(size);
+
+	addStage(HEIGHTFIELD_STAGE_MOUNTAIN);
+	steps_[STEP_MOUNTAIN] = addPublish(STEP_MOUNTAIN);
+
+	noiseField_ = addStage(HEIGHTFIELD_STAGE_NOISE_FIELD);
+
+	addStage(HEIGHTFIELD_STAGE_CRATER);
+	addNode("ash emitter", HEIGHTFIELD_CRATER, GENERATION_EMITTERS, [this] { addAshEmitter(); });
+	steps_[STEP_CRATER] = addPublish(STEP_CRATER);
+
+	addStage(HEIGHTFIELD_STAGE_NOISE_LAYER);
+	steps_[STEP_NOISE] = addPublish(STEP_NOISE);
+
+	for (int i = 0; i < Heightfield::LAVA_FLOWS; ++i)
+	{
+		addStage(HEIGHTFIELD_STAGE_LAVA_FLOW);
+		steps_[STEP_LAVA_FLOW + i] = addPublish(STEP_LAVA_FLOW + i);
+	}
+
+	addNode("emitters", HEIGHTFIELD_TYPES | HEIGHTFIELD_RANDOM, HEIGHTFIELD_RANDOM | GENERATION_EMITTERS,
+		[this] { addEmitters(); });
+	steps_[STEP_COMPLETE] = addPublish(STEP_COMPLETE);
+
+	queued_.assign(graph_.getNumNodes(), 0);
+}
+
+/*
+	Name		TerrainGeneration::load
+	Syntax		TerrainGeneration::load(const HeightfieldFile& file)
+	Param		const HeightfieldFile& file - An open baked volcano
+	Brief		Takes the completed volcano in the file instead of generating it, and
+				publishes it before returning. Emitters the file is short of are
+				picked from its lava.
+*/
+void TerrainGeneration::load(const HeightfieldFile& file)
+{
+	heightfield_.load(file);
+	emitters_.assign(file.getEmitters(), file.getEmitters() + file.getNumEmitters());
+	addEmitters();
+	publish(STEP_COMPLETE);
+}
+
+/*
+	Name		TerrainGeneration::prefetch
+	Syntax		TerrainGeneration::prefetch()
+	Brief		Starts fetching the noise layer, which does not depend on any step
+*/
+void TerrainGeneration::prefetch()
+{
+	if (graph_.getPool())
+		graph_.start(noiseField_);
+	else
+		queue(noiseField_);
+}
+
+/*
+	Name		TerrainGeneration::start
+	Syntax		TerrainGeneration::start(int step)
+	Param		int step - The step to start, with any before it not yet started
+	Brief		Starts the step without waiting. Its snapshot is published once it
+				has finished.
+*/
+void TerrainGeneration::start(int step)
+{
+	if (graph_.getPool())
+		graph_.start(steps_[step]);
+	else
+		queue(steps_[step]);
+}
+
+/*
+	Name		TerrainGeneration::complete
+	Syntax		TerrainGeneration::complete()
+	Brief		Starts every step not yet started without waiting. Only the complete
+				volcano is published from then on.
+*/
+void TerrainGeneration::complete()
+{
+	isCompleting_ = true;
+	start(STEP_COMPLETE);
+}
+
+/*
+	Name		TerrainGeneration::update
+	Syntax		TerrainGeneration::update(float budget)
+	Param		float budget - Milliseconds to spend
+	Brief		Runs slices of the stages started until the budget is used up, when
+				there is no pool. A step's snapshot is published by its last slice.
+*/
+void TerrainGeneration::update(float budget)
+{
+	if (!scheduler_.isIdle())
+		scheduler_.run(budget);
+}
+
+/*
+	Name		TerrainGeneration::cancel
+	Syntax		TerrainGeneration::cancel()
+	Brief		Stops the stages not yet running, and the mountain or a lava flow at
+				its next yield, without waiting
+*/
+void TerrainGeneration::cancel()
+{
+	graph_.cancel();
+	scheduler_.clear();
+}
+
+/*
+	Name		TerrainGeneration::getProgress
+	Syntax		TerrainGeneration::getProgress()
+	Return		float - How much of the volcano has been generated, from 0 to 1,
+				counting each node the same
+*/
+float TerrainGeneration::getProgress() const
+{
+	int count = graph_.getNumNodes();
+	float finished = 0.0f;
+	if (graph_.getPool())
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			if (graph_.isFinished(i))
+				finished += 1.0f;
+		}
+	}
+	else
+	{
+		finished = scheduler_.getNumFinished() + scheduler_.getCurrentProgress();
+	}
+
+	return finished / count;
+}
+
+/*
+	Name		TerrainGeneration::getPublished
+	Syntax		TerrainGeneration::getPublished()
+	Return		HeightfieldSnapshotPtr - The latest snapshot, or none before the first
+				step has finished
+*/
+HeightfieldSnapshotPtr TerrainGeneration::getPublished() const
+{
+	return std::atomic_load(&published_);
+}
+
+/*
+	Name		TerrainGeneration::addStage
+	Syntax		TerrainGeneration::addStage(HeightfieldStage stage)
+	Param		HeightfieldStage stage - A heightfield stage
+	Return		TaskGraph::Node - The stage's node, also kept in slices
+*/
+TaskGraph::Node TerrainGeneration::addStage(HeightfieldStage stage)
+{
+	slices_.push_back(heightfield_.sliceStage(stage));
+	return heightfield_.addStage(graph_, stage);
+}
+
+/*
+	Name		TerrainGeneration::addNode
+	Syntax		TerrainGeneration::addNode(const char* name, unsigned int reads, unsigned int writes,
+										   const std::function<void()>& action)
+	Param		const char* name - A name for the node
+	Param		unsigned int reads, writes - The resources the action reads and changes
+	Param		const std::function<void()>& action - The node's work, small enough
+				to run as a single slice
+	Return		TaskGraph::Node - The node
+*/
+TaskGraph::Node TerrainGeneration::addNode(const char* name, unsigned int reads, unsigned int writes,
+	const std::function<void()>& action)
+{
+	slices_.push_back([action]() -> float
+	{
+		action();
+		return 1.0f;
+	});
+	return graph_.addNode(name, reads, writes, action);
+}
+
+/*
+	Name		TerrainGeneration::addPublish
+	Syntax		TerrainGeneration::addPublish(int step)
+	Param		int step - The step the node finishes
+	Return		TaskGraph::Node - A node publishing the heightfield once every stage
+				added before it that changes it has finished
+*/
+TaskGraph::Node TerrainGeneration::addPublish(int step)
+{
+	std::shared_ptr<Publish> sliced(new Publish);
+	sliced->step = step;
+	sliced->row = -1;
+	slices_.push_back([this, sliced]() -> float
+	{
+		return slicePublish(*sliced);
+	});
+
+	return graph_.addNode("publish", HEIGHTFIELD_HEIGHTS | HEIGHTFIELD_TYPES | GENERATION_EMITTERS,
+		HEIGHTFIELD_DIRTY_REGIONS | GENERATION_SNAPSHOT, [this, step] { publish(step); });
+}
+
+/*
+	Name		TerrainGeneration::queue
+	Syntax		TerrainGeneration::queue(TaskGraph::Node node)
+	Param		TaskGraph::Node node - The node to run in slices
+	Brief		Queues the node after any of its dependencies not yet queued, so the
+				slices run in an order the graph allows
+*/
+void TerrainGeneration::queue(TaskGraph::Node node)
+{
+	if (queued_[node])
+		return;
+
+	const std::vector<TaskGraph::Node>& dependencies = graph_.getDependencies(node);
+	for (size_t i = 0; i < dependencies.size(); ++i)
+	{
+		queue(dependencies[i]);
+	}
+
+	queued_[node] = 1;
+	scheduler_.add(graph_.getName(node), slices_[node]);
+}
+
+/*
+	Name		TerrainGeneration::publish
+	Syntax		TerrainGeneration::publish(int step)
+	Param		int step - The step just finished
+	Brief		Copies the heightfield into a snapshot and swaps it in as the published
+				one. The regions changed are handed over with it, so they carry on
+				building up while snapshots are skipped.
+*/
+void TerrainGeneration::publish(int step)
+{
+	if (isCompleting_ && step != STEP_COMPLETE)
+		return;
+
+	std::shared_ptr<HeightfieldSnapshot> snapshot = startSnapshot(step);
+	copyRows(*snapshot, 0, heightfield_.getSize() - 1);
+	finishSnapshot(snapshot);
+}
+
+/*
+	Name		TerrainGeneration::slicePublish
+	Syntax		TerrainGeneration::slicePublish(Publish& publish)
+	Param		Publish& publish - The snapshot so far
+	Return		float - How much of the snapshot has been copied, 1 once published
+	Brief		Publishes a snapshot a band of rows at a time
+*/
+float TerrainGeneration::slicePublish(Publish& publish)
+{
+	if (publish.row < 0)
+	{
+		if (isCompleting_ && publish.step != STEP_COMPLETE)
+			return 1.0f;
+
+		publish.snapshot = startSnapshot(publish.step);
+		publish.row = 0;
+	}
+
+	int size = heightfield_.getSize();
+	int last = (publish.row + PUBLISH_SLICE_ROWS < size) ? publish.row + PUBLISH_SLICE_ROWS - 1 : size - 1;
+	copyRows(*publish.snapshot, publish.row, last);
+	publish.row = last + 1;
+	if (publish.row < size)
+		return (float)publish.row / size;
+
+	finishSnapshot(publish.snapshot);
+	publish.snapshot.reset();
+	return 1.0f;
+}
+
+/*
+	Name		TerrainGeneration::startSnapshot
+	Syntax		TerrainGeneration::startSnapshot(int step)
+	Param		int step - The step just finished
+	Return		std::shared_ptr<HeightfieldSnapshot> - An empty snapshot for the step,
+				with room for the heightfield
+*/
+std::shared_ptr<HeightfieldSnapshot> TerrainGeneration::startSnapshot(int step)
+{
+	// Always a new snapshot, as the render thread may still be reading the
+	// previous ones and use_count cannot say when it has let go
+	std::shared_ptr<HeightfieldSnapshot> snapshot(new HeightfieldSnapshot);
+
+	// Reserved rather than sized, so the memory is first touched by the copies
+	int count = heightfield_.getSize() * heightfield_.getSize();
+	snapshot->step = step;
+	snapshot->isComplete = (step == STEP_COMPLETE);
+	snapshot->heights.reserve(count);
+	snapshot->types.reserve(count);
+	return snapshot;
+}
+
+/*
+	Name		TerrainGeneration::copyRows
+	Syntax		TerrainGeneration::copyRows(HeightfieldSnapshot& snapshot, int rowMin, int rowMax)
+	Param		HeightfieldSnapshot& snapshot - A snapshot holding the rows before rowMin
+	Param		int rowMin, rowMax - The rows to add to it
+*/
+void TerrainGeneration::copyRows(HeightfieldSnapshot& snapshot, int rowMin, int rowMax)
+{
+	int size = heightfield_.getSize();
+	if (rowMin > rowMax)
+		return;
+
+	const float* heights = heightfield_.getHeights();
+	const unsigned int* types = heightfield_.getTypes();
+	snapshot.heights.insert(snapshot.heights.end(), heights + rowMin * size, heights + (rowMax + 1) * size);
+	snapshot.types.insert(snapshot.types.end(), types + rowMin * size, types + (rowMax + 1) * size);
+}
+
+/*
+	Name		TerrainGeneration::finishSnapshot
+	Syntax		TerrainGeneration::finishSnapshot(const std::shared_ptr<HeightfieldSnapshot>& snapshot)
+	Param		const std::shared_ptr<HeightfieldSnapshot>& snapshot - A snapshot holding
+				every row
+	Brief		Hands the changed regions and emitters over with the snapshot and swaps
+				it in
+*/
+void TerrainGeneration::finishSnapshot(const std::shared_ptr<HeightfieldSnapshot>& snapshot)
+{
+	snapshot->dirtyRegions = heightfield_.getDirtyRegions();
+	snapshot->emitters = emitters_;
+	heightfield_.clearDirtyRegions();
+
+	std::atomic_store(&published_, HeightfieldSnapshotPtr(snapshot));
+}
+
+/*
+	Name		TerrainGeneration::addAshEmitter
+	Syntax		TerrainGeneration::addAshEmitter()
+	Brief		Places the ash emitter above the crater
+*/
+void TerrainGeneration::addAshEmitter()
+{
+	HeightfieldEmitter ash;
+	ash.type = EMITTER_ASH;
+	ash.position.x = heightfield_.getCraterX();
+	ash.position.y = heightfield_.getPeakHeight() + ASH_HEIGHT;
+	ash.position.z = heightfield_.getCraterZ();
+	emitters_.push_back(ash);
+}
+
+/*
+	Name		TerrainGeneration::addEmitters
+	Syntax		TerrainGeneration::addEmitters()
+	Brief		Adds the fire and smoke emitters missing by picking random lava vertices
+*/
+void TerrainGeneration::addEmitters()
+{
+	int fire = fireEmitters_;
+	int smoke = smokeEmitters_;
+	for (size_t i = 0; i < emitters_.size(); ++i)
+	{
+		if (emitters_[i].type == EMITTER_FIRE)
+			--fire;
+		else if (emitters_[i].type == EMITTER_SMOKE)
+			--smoke;
+	}
+
+	std::vector<HeightfieldPoint> points = heightfield_.pickLavaPoints(fire > 0 ? fire : 0);
+	HeightfieldEmitter emitter;
+	emitter.type = EMITTER_FIRE;
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		emitter.position = points[i];
+		emitters_.push_back(emitter);
+	}
+
+	points = heightfield_.pickLavaPoints(smoke > 0 ? smoke : 0);
+	emitter.type = EMITTER_SMOKE;
+	for (size_t i = 0; i < points.size(); ++i)
+	{
+		emitter.position = points[i];
+		emitters_.push_back(emitter);
+	}
+}
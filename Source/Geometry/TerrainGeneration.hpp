@@ -0,0 +1,126 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Terrain Generation
+	Brief		Declaration of TerrainGeneration Class, which generates a volcano on the
+				worker pool into a heightfield of its own. The stages run as a task
+				graph, a step at a time. As each step finishes, a copy of the
+				heightfield is published as a snapshot by swapping a pointer, so the
+				render side takes the latest one without locking or waiting.
+
+				A new volcano is generated by a new TerrainGeneration. The old one
+				is cancelled, which skips the stages not yet running and stops the
+				mountain or a lava flow at its next yield, and can be deleted
+				without waiting once isIdle.
+
+				Given no pool, the stages are run a slice at a time by update, on
+				the thread calling it, for no longer than the time it is given.
+*/
+
+#ifndef TERRAINGENERATION_H
+#define TERRAINGENERATION_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "Geometry/Heightfield.hpp"
+#include "Geometry/HeightfieldFile.hpp"
+#include "Utilities/TaskGraph.hpp"
+
+/*
+	Name		HeightfieldSnapshot
+	Brief		The heightfield as a step left it. Never changed once published.
+*/
+struct HeightfieldSnapshot
+{
+	int step;										// The step finished
+	bool isComplete;
+	std::vector<float> heights;
+	std::vector<unsigned int> types;
+	std::vector<HeightfieldRegion> dirtyRegions;	// Changed since the last snapshot
+	std::vector<HeightfieldEmitter> emitters;		// In local space
+};
+
+typedef std::shared_ptr<const HeightfieldSnapshot> HeightfieldSnapshotPtr;
+
+class TerrainGeneration
+{
+public:
+	// The steps a volcano is generated in. A snapshot is published after each.
+	enum Step
+	{
+		STEP_MOUNTAIN,
+		STEP_CRATER,
+		STEP_NOISE,
+		STEP_LAVA_FLOW,
+		STEP_COMPLETE = STEP_LAVA_FLOW + Heightfield::LAVA_FLOWS,
+		NUM_STEPS
+	};
+
+	TerrainGeneration(int size, unsigned int seed, unsigned int stream, int fireEmitters, int smokeEmitters,
+					  SimplexNoise::NoiseFieldCache* noiseCache, WorkerPool* pool);
+
+	void load(const HeightfieldFile& file);
+	void prefetch();
+	void start(int step);
+	void complete();
+	void update(float budget);
+	void cancel();
+	bool isIdle() const { return graph_.isIdle() && scheduler_.isIdle(); };
+	float getProgress() const;
+
+	HeightfieldSnapshotPtr getPublished() const;
+	const Heightfield& getHeightfield() const { return heightfield_; };
+
+private:
+	/*
+		Name		Publish
+		Brief		A snapshot part way through being copied, when sliced
+	*/
+	struct Publish
+	{
+		int step;
+		int row;							// Next row to copy, -1 before starting
+		std::shared_ptr<HeightfieldSnapshot> snapshot;
+	};
+
+	TaskGraph::Node addStage(HeightfieldStage stage);
+	TaskGraph::Node addNode(const char* name, unsigned int reads, unsigned int writes,
+							const std::function<void()>& action);
+	TaskGraph::Node addPublish(int step);
+	void queue(TaskGraph::Node node);
+	void publish(int step);
+	float slicePublish(Publish& publish);
+	std::shared_ptr<HeightfieldSnapshot> startSnapshot(int step);
+	void copyRows(HeightfieldSnapshot& snapshot, int rowMin, int rowMax);
+	void finishSnapshot(const std::shared_ptr<HeightfieldSnapshot>& snapshot);
+	void addAshEmitter();
+	void addEmitters();
+
+	Heightfield heightfield_;
+	std::vector<HeightfieldEmitter> emitters_;
+	int fireEmitters_;
+	int smokeEmitters_;
+
+	// Intermediate snapshots are skipped once the rest of the steps are run at once
+	std::atomic<bool> isCompleting_;
+
+	// Only read and written with the atomic shared_ptr functions
+	HeightfieldSnapshotPtr published_;
+
+	TaskGraph::Node noiseField_;
+	TaskGraph::Node steps_[NUM_STEPS];
+
+	// Each node's work in slices, and the ones queued to run when there is no pool
+	std::vector<SliceScheduler::Slice> slices_;
+	std::vector<char> queued_;
+	SliceScheduler scheduler_;
+
+	// Declared last, so running stages are waited for before the rest is destroyed
+	TaskGraph graph_;
+};
+
+#endif // TERRAINGENERATION_H
@@ -0,0 +1,97 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Terrain Indices
+	Brief		Definition of the terrain triangulation functions
+*/
+
+#include <cstring>
+
+#include "Geometry/TerrainIndices.hpp"
+
+/*
+	Name		TerrainIndices::buildGrid
+	Syntax		TerrainIndices::buildGrid(std::vector<unsigned int>& indices, int firstRow, int rows,
+										  int columns, int stride, int width, int coarserEdges)
+	Param		std::vector<unsigned int>& indices - The list to append the triangles to
+	Param		int firstRow - The grid row the rectangle starts on, which picks its diagonals
+	Param		int rows, columns - The number of quads down and across the rectangle
+	Param		int stride - The number of grid vertices between the rectangle's vertices
+	Param		int width - The number of vertices along each row of the grid
+	Param		int coarserEdges - The EDGE_ flags of edges to match to half the detail
+	Brief		Appends two triangles for each quad of the rectangle, alternating the
+				diagonal from quad to quad, in rows. Indices are relative to the
+				rectangle's first vertex. Triangles folded flat along coarser edges
+				are left out.
+*/
+void TerrainIndices::buildGrid(std::vector<unsigned int>& indices, int firstRow, int rows, int columns,
+							   int stride, int width, int coarserEdges)
+{
+	int corners[6][2];
+	unsigned int triangle[3];
+
+	for (int i = 0; i < rows; ++i)
+	{
+		bool evenRow = (firstRow + i) % 2 == 0;
+		for (int j = 0; j < columns; ++j)
+		{
+			if (evenRow == (j % 2 == 0))
+			{
+				int quad[6][2] = {{i, j + 1}, {i + 1, j + 1}, {i, j},
+								  {i, j}, {i + 1, j + 1}, {i + 1, j}};
+				memcpy(corners, quad, sizeof(corners));
+			}
+			else
+			{
+				int quad[6][2] = {{i, j}, {i, j + 1}, {i + 1, j},
+								  {i, j + 1}, {i + 1, j + 1}, {i + 1, j}};
+				memcpy(corners, quad, sizeof(corners));
+			}
+
+			for (int t = 0; t < 6; t += 3)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					int row = corners[t + k][0];
+					int column = corners[t + k][1];
+
+					if ((coarserEdges & EDGE_ROW_MIN) && row == 0 && column % 2 != 0)
+						--column;
+					if ((coarserEdges & EDGE_ROW_MAX) && row == rows && column % 2 != 0)
+						--column;
+					if ((coarserEdges & EDGE_COLUMN_MIN) && column == 0 && row % 2 != 0)
+						--row;
+					if ((coarserEdges & EDGE_COLUMN_MAX) && column == columns && row % 2 != 0)
+						--row;
+
+					triangle[k] = row * stride * width + column * stride;
+				}
+
+				if (triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[0] != triangle[2])
+				{
+					indices.insert(indices.end(), triangle, triangle + 3);
+				}
+			}
+		}
+	}
+}
+
+/*
+	Name		TerrainIndices::getMaxIndex
+	Syntax		TerrainIndices::getMaxIndex(const unsigned int* indices, int indexCount)
+	Param		const unsigned int* indices - An index list
+	Param		int indexCount - The number of indices in the list
+	Return		unsigned int - The largest index in the list, 0 if it is empty
+*/
+unsigned int TerrainIndices::getMaxIndex(const unsigned int* indices, int indexCount)
+{
+	unsigned int maxIndex = 0;
+	for (int i = 0; i < indexCount; ++i)
+	{
+		if (indices[i] > maxIndex)
+			maxIndex = indices[i];
+	}
+	return maxIndex;
+}
@@ -0,0 +1,35 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Terrain Indices
+	Brief		Declaration of the terrain triangulation functions, which build index
+				lists for rectangles of the terrain grid without touching Direct3D so
+				the tools can measure them
+*/
+
+#ifndef TERRAININDICES_H
+#define TERRAININDICES_H
+
+#include <vector>
+
+namespace TerrainIndices
+{
+	// Edges of a rectangle next to one drawn at half the detail. Every other
+	// vertex along such an edge is folded onto its neighbour so they match.
+	const int EDGE_ROW_MIN = 1;
+	const int EDGE_ROW_MAX = 2;
+	const int EDGE_COLUMN_MIN = 4;
+	const int EDGE_COLUMN_MAX = 8;
+	const int EDGE_MASKS = 16;
+
+	// Most vertices a list may reach through 16-bit indices
+	const unsigned int SHORT_INDEX_VERTICES = 65536;
+
+	void buildGrid(std::vector<unsigned int>& indices, int firstRow, int rows, int columns,
+				   int stride, int width, int coarserEdges = 0);
+	unsigned int getMaxIndex(const unsigned int* indices, int indexCount);
+};
+
+#endif // TERRAININDICES_H
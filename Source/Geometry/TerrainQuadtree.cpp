@@ -0,0 +1,508 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Terrain Quadtree
+	Brief		Definition of Terrain Quadtree Class
+*/
+
+#include <algorithm>
+#include "Geometry\TerrainQuadtree.hpp"
+#include "Geometry\TerrainIndices.hpp"
+#include "Graphics\Vertex.hpp"
+#include "Utilities\VertexCache.hpp"
+
+namespace
+{
+	// The largest a chunk's triangles may be on screen, in pixels, before it is split
+	const float LOD_PIXEL_ERROR = 4.0f;
+
+	struct IsShortDraw
+	{
+		explicit IsShortDraw(ID3D10Buffer* shortIndexBuffer) : shortIndexBuffer_(shortIndexBuffer) {}
+		bool operator()(const TerrainDraw& draw) const { return draw.indexBuffer == shortIndexBuffer_; }
+		ID3D10Buffer* shortIndexBuffer_;
+	};
+}
+
+/*
+	Name		TerrainQuadtree::TerrainQuadtree
+	Syntax		TerrainQuadtree()
+	Brief		TerrainQuadtree constructor
+*/
+TerrainQuadtree::TerrainQuadtree()
+: d3dDevice_(0),
+  shortIndexBuffer_(0),
+  longIndexBuffer_(0),
+  width_(0),
+  levels_(0),
+  chunks_(0),
+  cameraPos_(0, 0, 0),
+  pixelsPerUnit_(0)
+{
+
+}
+
+/*
+	Name		TerrainQuadtree::~TerrainQuadtree
+	Syntax		~TerrainQuadtree()
+	Brief		TerrainQuadtree destructor
+*/
+TerrainQuadtree::~TerrainQuadtree()
+{
+	if (shortIndexBuffer_)
+	{
+		shortIndexBuffer_->Release();
+		shortIndexBuffer_ = 0;
+	}
+	if (longIndexBuffer_)
+	{
+		longIndexBuffer_->Release();
+		longIndexBuffer_ = 0;
+	}
+}
+
+/*
+	Name		TerrainQuadtree::canChunk
+	Syntax		TerrainQuadtree::canChunk(int gridSize)
+	Param		int gridSize - The number of quads along each side of the terrain
+	Return		bool - True if the grid is CHUNK_QUADS times a power of two across
+*/
+bool TerrainQuadtree::canChunk(int gridSize)
+{
+	if (gridSize < CHUNK_QUADS || gridSize % CHUNK_QUADS != 0)
+		return false;
+
+	int chunks = gridSize / CHUNK_QUADS;
+	return (chunks & (chunks - 1)) == 0;
+}
+
+/*
+	Name		TerrainQuadtree::initialise
+	Syntax		TerrainQuadtree::initialise(ID3D10Device* device, int gridSize)
+	Param		ID3D10Device* device - Pointer to the Direct3D device
+	Param		int gridSize - The number of quads along each side of the terrain
+	Return		bool - False if the grid cannot be chunked or the index buffer
+				could not be created
+	Brief		Builds the index lists every chunk is drawn from
+*/
+bool TerrainQuadtree::initialise(ID3D10Device* device, int gridSize)
+{
+	if (!canChunk(gridSize))
+		return false;
+
+	d3dDevice_ = device;
+	width_ = gridSize + 1;
+	chunks_ = gridSize / CHUNK_QUADS;
+	levels_ = 0;
+	while ((1 << levels_) < chunks_)
+	{
+		++levels_;
+	}
+
+	buildIndexLists();
+
+	if (!shortIndices_.empty() &&
+		!createIndexBuffer(&shortIndices_[0], sizeof(WORD) * (UINT)shortIndices_.size(), &shortIndexBuffer_))
+		return false;
+	if (!longIndices_.empty() &&
+		!createIndexBuffer(&longIndices_[0], sizeof(DWORD) * (UINT)longIndices_.size(), &longIndexBuffer_))
+		return false;
+
+	// Only needed to fill the buffers
+	std::vector<WORD>().swap(shortIndices_);
+	std::vector<DWORD>().swap(longIndices_);
+
+	minHeights_.resize(levels_ + 1);
+	maxHeights_.resize(levels_ + 1);
+	for (int depth = 0; depth <= levels_; ++depth)
+	{
+		minHeights_[depth].assign((1 << depth) * (1 << depth), 0.0f);
+		maxHeights_[depth].assign((1 << depth) * (1 << depth), 0.0f);
+	}
+	depthMap_.assign(chunks_ * chunks_, 0);
+
+	return true;
+}
+
+/*
+	Name		TerrainQuadtree::buildIndexLists
+	Syntax		TerrainQuadtree::buildIndexLists()
+	Brief		Builds an index list for every chunk stride and set of edges next to
+				larger chunks. Indices are relative to the chunk's first vertex, which
+				is passed as the base vertex, so one list serves every chunk of a size.
+*/
+void TerrainQuadtree::buildIndexLists()
+{
+	shortIndices_.clear();
+	longIndices_.clear();
+	listStarts_.assign((levels_ + 1) * TerrainIndices::EDGE_MASKS, 0);
+	listCounts_.assign((levels_ + 1) * TerrainIndices::EDGE_MASKS, 0);
+	listIsShort_.assign((levels_ + 1) * TerrainIndices::EDGE_MASKS, 0);
+
+	std::vector<unsigned int> indices;
+	for (int level = 0; level <= levels_; ++level)
+	{
+		for (int mask = 0; mask < TerrainIndices::EDGE_MASKS; ++mask)
+		{
+			int list = level * TerrainIndices::EDGE_MASKS + mask;
+
+			indices.clear();
+			TerrainIndices::buildGrid(indices, 0, CHUNK_QUADS, CHUNK_QUADS, 1 << level, width_, mask);
+			VertexCache::optimise(&indices[0], (int)indices.size());
+			listCounts_[list] = (UINT)indices.size();
+
+			if (TerrainIndices::getMaxIndex(&indices[0], (int)indices.size()) < TerrainIndices::SHORT_INDEX_VERTICES)
+			{
+				listIsShort_[list] = 1;
+				listStarts_[list] = (UINT)shortIndices_.size();
+				shortIndices_.insert(shortIndices_.end(), indices.begin(), indices.end());
+			}
+			else
+			{
+				listStarts_[list] = (UINT)longIndices_.size();
+				longIndices_.insert(longIndices_.end(), indices.begin(), indices.end());
+			}
+		}
+	}
+}
+
+/*
+	Name		TerrainQuadtree::createIndexBuffer
+	Syntax		TerrainQuadtree::createIndexBuffer(const void* indices, UINT byteWidth, ID3D10Buffer** buffer)
+	Param		const void* indices - The indices to fill the buffer with
+	Param		UINT byteWidth - The size of the indices in bytes
+	Param		ID3D10Buffer** buffer - Receives the buffer
+	Return		bool - False if the buffer could not be created
+*/
+bool TerrainQuadtree::createIndexBuffer(const void* indices, UINT byteWidth, ID3D10Buffer** buffer)
+{
+	D3D10_BUFFER_DESC ibd;
+	ibd.Usage = D3D10_USAGE_IMMUTABLE;
+	ibd.ByteWidth = byteWidth;
+	ibd.BindFlags = D3D10_BIND_INDEX_BUFFER;
+	ibd.CPUAccessFlags = 0;
+	ibd.MiscFlags = 0;
+	D3D10_SUBRESOURCE_DATA iinitData;
+	iinitData.pSysMem = indices;
+	HRESULT hr = d3dDevice_->CreateBuffer(&ibd, &iinitData, buffer);
+	if (FAILED(hr))
+	{
+		MessageBox(0, "Create terrain chunk index buffer - Failed", "Error", MB_OK);
+		return false;
+	}
+	return true;
+}
+
+/*
+	Name		TerrainQuadtree::updateBounds
+	Syntax		TerrainQuadtree::updateBounds(const TerrainDynamicVertex* vertices, int firstRow, int lastRow)
+	Param		const TerrainDynamicVertex* vertices - The terrain's heights
+	Param		int firstRow, lastRow - The rows of vertices that have changed
+	Brief		Recalculates the height range of the chunks holding the changed rows
+*/
+void TerrainQuadtree::updateBounds(const TerrainDynamicVertex* vertices, int firstRow, int lastRow)
+{
+	// Chunks share their edge vertices, so a row on an edge is in two chunks
+	int first = firstRow > 0 ? (firstRow - 1) / CHUNK_QUADS : 0;
+	int last = lastRow / CHUNK_QUADS;
+	if (last >= chunks_)
+		last = chunks_ - 1;
+
+	std::vector<float>& minHeights = minHeights_[levels_];
+	std::vector<float>& maxHeights = maxHeights_[levels_];
+	for (int row = first; row <= last; ++row)
+	{
+		for (int column = 0; column < chunks_; ++column)
+		{
+			float low = vertices[row * CHUNK_QUADS * width_ + column * CHUNK_QUADS].height;
+			float high = low;
+			for (int i = row * CHUNK_QUADS; i <= (row + 1) * CHUNK_QUADS; ++i)
+			{
+				const TerrainDynamicVertex* vertex = &vertices[i * width_ + column * CHUNK_QUADS];
+				for (int j = 0; j <= CHUNK_QUADS; ++j)
+				{
+					if (vertex[j].height < low)
+						low = vertex[j].height;
+					if (vertex[j].height > high)
+						high = vertex[j].height;
+				}
+			}
+			minHeights[row * chunks_ + column] = low;
+			maxHeights[row * chunks_ + column] = high;
+		}
+	}
+
+	// Each larger chunk covers the four below it
+	for (int depth = levels_ - 1; depth >= 0; --depth)
+	{
+		first /= 2;
+		last /= 2;
+		int across = 1 << depth;
+		const std::vector<float>& childMin = minHeights_[depth + 1];
+		const std::vector<float>& childMax = maxHeights_[depth + 1];
+		for (int row = first; row <= last; ++row)
+		{
+			for (int column = 0; column < across; ++column)
+			{
+				int child = (row * 2) * (across * 2) + column * 2;
+				int below = child + across * 2;
+				minHeights_[depth][row * across + column] = std::min(std::min(childMin[child], childMin[child + 1]),
+					std::min(childMin[below], childMin[below + 1]));
+				maxHeights_[depth][row * across + column] = std::max(std::max(childMax[child], childMax[child + 1]),
+					std::max(childMax[below], childMax[below + 1]));
+			}
+		}
+	}
+}
+
+/*
+	Name		TerrainQuadtree::select
+	Syntax		TerrainQuadtree::select(const D3DXVECTOR3& cameraPos, const D3DXMATRIX& wvp, float pixelsPerUnit)
+	Param		const D3DXVECTOR3& cameraPos - The camera in the terrain's local space
+	Param		const D3DXMATRIX& wvp - The terrain's world view projection matrix
+	Param		float pixelsPerUnit - Pixels covered by one unit one unit from the camera
+	Brief		Chooses the chunks to draw. A chunk is split while its triangles would
+				be more than LOD_PIXEL_ERROR pixels across, then chunks are split until
+				no chunk is next to one more than one level smaller, so edges only
+				ever need to match a chunk twice their size. Chunks outside the
+				frustum are kept as large as possible and not drawn.
+*/
+void TerrainQuadtree::select(const D3DXVECTOR3& cameraPos, const D3DXMATRIX& wvp, float pixelsPerUnit)
+{
+	cameraPos_ = cameraPos;
+	pixelsPerUnit_ = pixelsPerUnit;
+
+	// Planes from the combined matrix are in the terrain's local space
+	frustum_[0] = D3DXPLANE(wvp._14 + wvp._11, wvp._24 + wvp._21, wvp._34 + wvp._31, wvp._44 + wvp._41);
+	frustum_[1] = D3DXPLANE(wvp._14 - wvp._11, wvp._24 - wvp._21, wvp._34 - wvp._31, wvp._44 - wvp._41);
+	frustum_[2] = D3DXPLANE(wvp._14 + wvp._12, wvp._24 + wvp._22, wvp._34 + wvp._32, wvp._44 + wvp._42);
+	frustum_[3] = D3DXPLANE(wvp._14 - wvp._12, wvp._24 - wvp._22, wvp._34 - wvp._32, wvp._44 - wvp._42);
+	frustum_[4] = D3DXPLANE(wvp._13, wvp._23, wvp._33, wvp._43);
+	frustum_[5] = D3DXPLANE(wvp._14 - wvp._13, wvp._24 - wvp._23, wvp._34 - wvp._33, wvp._44 - wvp._43);
+
+	leaves_.clear();
+	selectChunks(0, 0, 0);
+
+	// Split chunks next to ones more than a level smaller until there are none
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		size_t i = 0;
+		while (i < leaves_.size())
+		{
+			if (needsSplit(leaves_[i]))
+			{
+				Chunk chunk = leaves_[i];
+				leaves_[i] = leaves_.back();
+				leaves_.pop_back();
+
+				int half = (1 << (levels_ - chunk.depth)) / 2;
+				addChunk(chunk.row, chunk.column, chunk.depth + 1);
+				addChunk(chunk.row, chunk.column + half, chunk.depth + 1);
+				addChunk(chunk.row + half, chunk.column, chunk.depth + 1);
+				addChunk(chunk.row + half, chunk.column + half, chunk.depth + 1);
+				changed = true;
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+
+	draws_.clear();
+	for (size_t i = 0; i < leaves_.size(); ++i)
+	{
+		if (!leaves_[i].visible)
+			continue;
+
+		int list = (levels_ - leaves_[i].depth) * TerrainIndices::EDGE_MASKS + getCoarserEdges(leaves_[i]);
+
+		TerrainDraw draw;
+		draw.indexBuffer = listIsShort_[list] ? shortIndexBuffer_ : longIndexBuffer_;
+		draw.indexFormat = listIsShort_[list] ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+		draw.indexCount = listCounts_[list];
+		draw.startIndex = listStarts_[list];
+		draw.baseVertex = leaves_[i].row * CHUNK_QUADS * width_ + leaves_[i].column * CHUNK_QUADS;
+		draws_.push_back(draw);
+	}
+
+	// Keep the draws from each index buffer together
+	std::stable_partition(draws_.begin(), draws_.end(), IsShortDraw(shortIndexBuffer_));
+}
+
+/*
+	Name		TerrainQuadtree::selectChunks
+	Syntax		TerrainQuadtree::selectChunks(int row, int column, int depth)
+	Param		int row, column - The chunk's first smallest chunk
+	Param		int depth - The chunk's depth in the quadtree
+	Brief		Splits the chunk while it is visible and its triangles are too large
+				on screen, adding the chunks it ends up as to the leaves
+*/
+void TerrainQuadtree::selectChunks(int row, int column, int depth)
+{
+	int size = 1 << (levels_ - depth);
+
+	if (depth < levels_ && isVisible(row, column, depth))
+	{
+		D3DXVECTOR3 min, max;
+		getBounds(row, column, depth, min, max);
+
+		// Distance from the camera to the nearest point of the chunk's bounds
+		D3DXVECTOR3 nearest(std::max(min.x, std::min(cameraPos_.x, max.x)),
+							std::max(min.y, std::min(cameraPos_.y, max.y)),
+							std::max(min.z, std::min(cameraPos_.z, max.z)));
+		D3DXVECTOR3 offset = nearest - cameraPos_;
+		float distance = D3DXVec3Length(&offset);
+
+		// The chunk's vertices are size units apart
+		if (size * pixelsPerUnit_ > LOD_PIXEL_ERROR * distance)
+		{
+			int half = size / 2;
+			selectChunks(row, column, depth + 1);
+			selectChunks(row, column + half, depth + 1);
+			selectChunks(row + half, column, depth + 1);
+			selectChunks(row + half, column + half, depth + 1);
+			return;
+		}
+	}
+
+	addChunk(row, column, depth);
+}
+
+/*
+	Name		TerrainQuadtree::addChunk
+	Syntax		TerrainQuadtree::addChunk(int row, int column, int depth)
+	Param		int row, column - The chunk's first smallest chunk
+	Param		int depth - The chunk's depth in the quadtree
+	Brief		Adds a chunk to the leaves and marks the area it covers with its depth
+*/
+void TerrainQuadtree::addChunk(int row, int column, int depth)
+{
+	Chunk chunk;
+	chunk.row = row;
+	chunk.column = column;
+	chunk.depth = depth;
+	chunk.visible = isVisible(row, column, depth);
+	leaves_.push_back(chunk);
+
+	int size = 1 << (levels_ - depth);
+	for (int i = row; i < row + size; ++i)
+	{
+		for (int j = column; j < column + size; ++j)
+		{
+			depthMap_[i * chunks_ + j] = depth;
+		}
+	}
+}
+
+/*
+	Name		TerrainQuadtree::isVisible
+	Syntax		TerrainQuadtree::isVisible(int row, int column, int depth)
+	Param		int row, column - The chunk's first smallest chunk
+	Param		int depth - The chunk's depth in the quadtree
+	Return		bool - False if the chunk's bounds are wholly outside the frustum
+*/
+bool TerrainQuadtree::isVisible(int row, int column, int depth) const
+{
+	D3DXVECTOR3 min, max;
+	getBounds(row, column, depth, min, max);
+
+	for (int i = 0; i < 6; ++i)
+	{
+		// The corner furthest along the plane's normal
+		D3DXVECTOR3 corner(frustum_[i].a >= 0.0f ? max.x : min.x,
+						   frustum_[i].b >= 0.0f ? max.y : min.y,
+						   frustum_[i].c >= 0.0f ? max.z : min.z);
+		if (D3DXPlaneDotCoord(&frustum_[i], &corner) < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+/*
+	Name		TerrainQuadtree::getBounds
+	Syntax		TerrainQuadtree::getBounds(int row, int column, int depth, D3DXVECTOR3& min, D3DXVECTOR3& max)
+	Param		int row, column - The chunk's first smallest chunk
+	Param		int depth - The chunk's depth in the quadtree
+	Param		D3DXVECTOR3& min, max - Receive the corners of the chunk's local bounds
+	Brief		Vertex (i, j) of the grid is at (i, height, j)
+*/
+void TerrainQuadtree::getBounds(int row, int column, int depth, D3DXVECTOR3& min, D3DXVECTOR3& max) const
+{
+	int shift = levels_ - depth;
+	int size = 1 << shift;
+	int index = (row >> shift) * (1 << depth) + (column >> shift);
+
+	min = D3DXVECTOR3((float)(row * CHUNK_QUADS), minHeights_[depth][index], (float)(column * CHUNK_QUADS));
+	max = D3DXVECTOR3((float)((row + size) * CHUNK_QUADS), maxHeights_[depth][index], (float)((column + size) * CHUNK_QUADS));
+}
+
+/*
+	Name		TerrainQuadtree::getDepth
+	Syntax		TerrainQuadtree::getDepth(int row, int column)
+	Param		int row, column - A smallest chunk
+	Return		int - The depth of the leaf covering it, or -1 if it is off the grid
+*/
+int TerrainQuadtree::getDepth(int row, int column) const
+{
+	if (row < 0 || row >= chunks_ || column < 0 || column >= chunks_)
+		return -1;
+	return depthMap_[row * chunks_ + column];
+}
+
+/*
+	Name		TerrainQuadtree::needsSplit
+	Syntax		TerrainQuadtree::needsSplit(const Chunk& chunk)
+	Param		const Chunk& chunk - A leaf
+	Return		bool - True if a leaf more than one level deeper touches its edges
+*/
+bool TerrainQuadtree::needsSplit(const Chunk& chunk) const
+{
+	int size = 1 << (levels_ - chunk.depth);
+	int deepest = chunk.depth + 1;
+
+	for (int k = 0; k < size; ++k)
+	{
+		if (getDepth(chunk.row - 1, chunk.column + k) > deepest ||
+			getDepth(chunk.row + size, chunk.column + k) > deepest ||
+			getDepth(chunk.row + k, chunk.column - 1) > deepest ||
+			getDepth(chunk.row + k, chunk.column + size) > deepest)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+	Name		TerrainQuadtree::getCoarserEdges
+	Syntax		TerrainQuadtree::getCoarserEdges(const Chunk& chunk)
+	Param		const Chunk& chunk - A leaf
+	Return		int - The EDGE_ flags of the edges next to a larger leaf. A larger leaf
+				always covers the whole of the edge.
+*/
+int TerrainQuadtree::getCoarserEdges(const Chunk& chunk) const
+{
+	int size = 1 << (levels_ - chunk.depth);
+	int mask = 0;
+	int depth;
+
+	depth = getDepth(chunk.row - 1, chunk.column);
+	if (depth >= 0 && depth < chunk.depth)
+		mask |= TerrainIndices::EDGE_ROW_MIN;
+	depth = getDepth(chunk.row + size, chunk.column);
+	if (depth >= 0 && depth < chunk.depth)
+		mask |= TerrainIndices::EDGE_ROW_MAX;
+	depth = getDepth(chunk.row, chunk.column - 1);
+	if (depth >= 0 && depth < chunk.depth)
+		mask |= TerrainIndices::EDGE_COLUMN_MIN;
+	depth = getDepth(chunk.row, chunk.column + size);
+	if (depth >= 0 && depth < chunk.depth)
+		mask |= TerrainIndices::EDGE_COLUMN_MAX;
+
+	return mask;
+}
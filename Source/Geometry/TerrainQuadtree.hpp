@@ -0,0 +1,106 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Terrain Quadtree
+	Brief		Declaration of Terrain Quadtree Class, which draws the terrain as fixed
+				size chunks in a quadtree. Each chunk is CHUNK_QUADS quads across
+				whatever its level, spreading its vertices further apart the larger it
+				is, so distant parts of the terrain are drawn with fewer triangles.
+*/
+
+#ifndef TERRAINQUADTREE_H
+#define TERRAINQUADTREE_H
+
+#include <d3dx10.h>
+#include <vector>
+
+struct TerrainDynamicVertex;
+
+/*
+	Name		TerrainDraw
+	Brief		One DrawIndexed call for part of the terrain and the index buffer it
+				draws from
+*/
+struct TerrainDraw
+{
+	ID3D10Buffer* indexBuffer;
+	DXGI_FORMAT indexFormat;
+	UINT indexCount;
+	UINT startIndex;
+	INT baseVertex;
+};
+
+class TerrainQuadtree
+{
+public:
+	// Quads along each side of every chunk
+	static const int CHUNK_QUADS = 32;
+
+	TerrainQuadtree();
+	~TerrainQuadtree();
+
+	static bool canChunk(int gridSize);
+
+	bool initialise(ID3D10Device* device, int gridSize);
+	void updateBounds(const TerrainDynamicVertex* vertices, int firstRow, int lastRow);
+	void select(const D3DXVECTOR3& cameraPos, const D3DXMATRIX& wvp, float pixelsPerUnit);
+
+	const std::vector<TerrainDraw>& getDraws() const { return draws_; };
+
+private:
+	/*
+		Name		Chunk
+		Brief		A leaf of the quadtree. Positions and sizes are counted in the
+					smallest chunks, depth 0 is the root.
+	*/
+	struct Chunk
+	{
+		int row;
+		int column;
+		int depth;
+		bool visible;
+	};
+
+	void buildIndexLists();
+	bool createIndexBuffer(const void* indices, UINT byteWidth, ID3D10Buffer** buffer);
+	void selectChunks(int row, int column, int depth);
+	void addChunk(int row, int column, int depth);
+	bool isVisible(int row, int column, int depth) const;
+	void getBounds(int row, int column, int depth, D3DXVECTOR3& min, D3DXVECTOR3& max) const;
+	int getDepth(int row, int column) const;
+	bool needsSplit(const Chunk& chunk) const;
+	int getCoarserEdges(const Chunk& chunk) const;
+
+	ID3D10Device* d3dDevice_;
+	ID3D10Buffer* shortIndexBuffer_;
+	ID3D10Buffer* longIndexBuffer_;
+
+	int width_;			// Vertices along each side of the grid
+	int levels_;		// Depth of the smallest chunks
+	int chunks_;		// Smallest chunks along each side of the grid
+
+	// All the index lists, one for each chunk stride and set of coarser edges,
+	// ordered for the vertex cache. Lists whose vertices are all in reach of 16-bit
+	// indices are kept in the short buffer, the rest in the long one.
+	std::vector<WORD> shortIndices_;
+	std::vector<DWORD> longIndices_;
+	std::vector<UINT> listStarts_;
+	std::vector<UINT> listCounts_;
+	std::vector<char> listIsShort_;
+
+	// Height range of the chunks at each depth, chunks_ >> (levels_ - depth) across
+	std::vector<std::vector<float> > minHeights_;
+	std::vector<std::vector<float> > maxHeights_;
+
+	// Rebuilt by each select
+	D3DXPLANE frustum_[6];
+	D3DXVECTOR3 cameraPos_;
+	float pixelsPerUnit_;
+	std::vector<Chunk> leaves_;
+	std::vector<int> depthMap_;		// Depth of the leaf covering each smallest chunk
+	std::vector<TerrainDraw> draws_;
+};
+
+#endif
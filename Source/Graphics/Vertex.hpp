@@ -26,6 +26,56 @@ struct Vertex
 	unsigned int type;
 };
 
+/*
+	Name		TerrainStaticVertex
+	Syntax		TerrainStaticVertex
+	Brief		The part of a terrain vertex fixed by the grid, its x and z position
+				and texture coordinates
+*/
+struct TerrainStaticVertex
+{
+	D3DXVECTOR2 posXZ;
+	D3DXVECTOR2 texC;
+};
+
+/*
+	Name		TerrainDynamicVertex
+	Syntax		TerrainDynamicVertex
+	Brief		The part of a terrain vertex that changes as the terrain generates,
+				its height and normal
+*/
+struct TerrainDynamicVertex
+{
+	float height;
+	D3DXVECTOR3 normal;
+};
+
+/*
+	Name		TerrainCompactVertex
+	Syntax		TerrainCompactVertex
+	Brief		A terrain vertex packed into 8 bytes. The height is quantized across
+				a range the terrain picks for its grid size, the normal is
+				octahedral encoded with y as its pole and the x and z position and
+				texture coordinates are rebuilt in the vertex shader from the vertex ID.
+*/
+struct TerrainCompactVertex
+{
+	unsigned short height;
+	short normal[2];
+	unsigned short type;
+};
+
+/*
+	Name		TerrainVertexFormat
+	Brief		How terrain vertices are stored on the GPU. Full uses the static,
+				dynamic and material streams, compact one TerrainCompactVertex stream.
+*/
+enum TerrainVertexFormat
+{
+	TERRAIN_VERTEX_FULL,
+	TERRAIN_VERTEX_COMPACT,
+};
+
 /*
 	Name		ParticleVertex
 	Syntax		ParticleVertex
@@ -49,6 +49,7 @@ bool HeatHazeShader::initialise()
 	sceneVar_		= fx_->GetVariableByName("screenTexture")->AsShaderResource();
 	perturbanceVar_ = fx_->GetVariableByName("perturbanceTexture")->AsShaderResource();
 	timeVar_		= fx_->GetVariableByName("time")->AsScalar();
+	perturbanceScaleVar_ = fx_->GetVariableByName("perturbanceScale")->AsVector();
 
 	// Build vertex layout
 	D3D10_INPUT_ELEMENT_DESC layout[] =
@@ -129,4 +130,17 @@ void HeatHazeShader::setSceneSRV(ID3D10ShaderResourceView* sceneSRV)
 void HeatHazeShader::setPerturbanceSRV(ID3D10ShaderResourceView* perturbanceSRV)
 {
 	perturbanceVar_->SetResource(perturbanceSRV);
+}
+
+/*
+	Name		HeatHazeShader::setPerturbanceScale
+	Syntax		HeatHazeShader::setPerturbanceScale(float x, float y)
+	Param		float x, y - How many times the perturbance texture repeats across
+				and down the screen
+	Brief		Sets the scale applied to the perturbance texture coordinates
+*/
+void HeatHazeShader::setPerturbanceScale(float x, float y)
+{
+	D3DXVECTOR4 scale(x, y, 0.0f, 0.0f);
+	perturbanceScaleVar_->SetFloatVector((float*)&scale);
 }
\ No newline at end of file
@@ -19,6 +19,7 @@ public:
 	void render(float time, int indices);
 	void setSceneSRV(ID3D10ShaderResourceView* sceneSRV);
 	void setPerturbanceSRV(ID3D10ShaderResourceView* perturbanceSRV);
+	void setPerturbanceScale(float x, float y);
 	void deinitialise();
 
 private:
@@ -26,6 +27,7 @@ private:
 	ID3D10EffectShaderResourceVariable* sceneVar_;
 	ID3D10EffectShaderResourceVariable* perturbanceVar_;
 	ID3D10EffectScalarVariable* timeVar_;
+	ID3D10EffectVectorVariable* perturbanceScaleVar_;
 };
 
 #endif // HEATHAZESHADER_H
\ No newline at end of file
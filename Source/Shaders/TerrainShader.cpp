@@ -47,6 +47,7 @@ bool TerrainShader::initialise()
 	} 
 
 	technique_		= fx_->GetTechniqueByName("TexTech");
+	compactTechnique_ = fx_->GetTechniqueByName("CompactTexTech");
 	
 	wvpVar_			= fx_->GetVariableByName("Wvp")->AsMatrix();
 	worldVar_		= fx_->GetVariableByName("World")->AsMatrix();
@@ -55,23 +56,29 @@ bool TerrainShader::initialise()
 	cameraPosVar_	= fx_->GetVariableByName("cameraPos")->AsVector();
 	fogColourVar_	= fx_->GetVariableByName("fogColour")->AsVector();
 	lightVar_		= fx_->GetVariableByName("parallelLight");
+	gridWidthVar_	= fx_->GetVariableByName("gridWidth")->AsScalar();
+	heightMinVar_	= fx_->GetVariableByName("heightMin")->AsScalar();
+	heightRangeVar_	= fx_->GetVariableByName("heightRange")->AsScalar();
+	vertexBaseVar_	= fx_->GetVariableByName("vertexBase")->AsScalar();
 
 	permTableVar_->SetResource(SimplexNoise::getPermTable());
 	simplexVar_->SetResource(SimplexNoise::getSimplexTex());
 
-	// Build vertex layout
+	// Build vertex layout - slot 0 holds the grid positions and texture coordinates,
+	// slot 1 the heights and normals and slot 2 the materials
 	D3D10_INPUT_ELEMENT_DESC layout[] =
 	{
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,	D3D10_INPUT_PER_VERTEX_DATA, 0},
-		{"NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D10_INPUT_PER_VERTEX_DATA, 0},
-		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, 24, D3D10_INPUT_PER_VERTEX_DATA, 0},
-		{"TYPE",     0, DXGI_FORMAT_R32_UINT,        0, 32, D3D10_INPUT_PER_VERTEX_DATA, 0},
+		{"POSITION", 0, DXGI_FORMAT_R32G32_FLOAT,    0, 0,	D3D10_INPUT_PER_VERTEX_DATA, 0},
+		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, 8,	D3D10_INPUT_PER_VERTEX_DATA, 0},
+		{"HEIGHT",   0, DXGI_FORMAT_R32_FLOAT,       1, 0,	D3D10_INPUT_PER_VERTEX_DATA, 0},
+		{"NORMAL",   0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 4,	D3D10_INPUT_PER_VERTEX_DATA, 0},
+		{"TYPE",     0, DXGI_FORMAT_R32_UINT,        2, 0,	D3D10_INPUT_PER_VERTEX_DATA, 0},
 	};
 
 	// Create the input layout
     D3D10_PASS_DESC PassDesc;
     technique_->GetPassByIndex(0)->GetDesc(&PassDesc);
-    hr = d3dDevice_->CreateInputLayout(layout, 4, PassDesc.pIAInputSignature, PassDesc.IAInputSignatureSize, &vertexLayout_);
+    hr = d3dDevice_->CreateInputLayout(layout, 5, PassDesc.pIAInputSignature, PassDesc.IAInputSignatureSize, &vertexLayout_);
 
 	if (FAILED(hr))
 	{
@@ -79,9 +86,47 @@ bool TerrainShader::initialise()
 		return false;
 	}
 
+	// Compact vertices are one 8 byte stream, the position comes from the vertex ID
+	D3D10_INPUT_ELEMENT_DESC compactLayout[] =
+	{
+		{"HEIGHT",   0, DXGI_FORMAT_R16_UNORM,       0, 0,	D3D10_INPUT_PER_VERTEX_DATA, 0},
+		{"NORMAL",   0, DXGI_FORMAT_R16G16_SNORM,    0, 2,	D3D10_INPUT_PER_VERTEX_DATA, 0},
+		{"TYPE",     0, DXGI_FORMAT_R16_UINT,        0, 6,	D3D10_INPUT_PER_VERTEX_DATA, 0},
+	};
+
+	compactTechnique_->GetPassByIndex(0)->GetDesc(&PassDesc);
+	hr = d3dDevice_->CreateInputLayout(compactLayout, 3, PassDesc.pIAInputSignature, PassDesc.IAInputSignatureSize, &compactLayout_);
+
+	if (FAILED(hr))
+	{
+		MessageBoxA(0, "Creating compact input layout - Failed", "Error", MB_OK);
+		return false;
+	}
+
+	format_ = TERRAIN_VERTEX_FULL;
+
 	return true;
 }
 
+/*
+	Name		TerrainShader::setVertexFormat
+	Syntax		TerrainShader::setVertexFormat(TerrainVertexFormat format, int gridWidth,
+										   float heightMin, float heightRange)
+	Param		TerrainVertexFormat format - The format of the terrain's vertex buffers
+	Param		int gridWidth - The number of vertices along each row of the terrain
+	Param		float heightMin, heightRange - The heights compact vertices are
+				quantized across
+	Brief		Chooses the technique and input layout that read the terrain's vertices
+*/
+void TerrainShader::setVertexFormat(TerrainVertexFormat format, int gridWidth, float heightMin, float heightRange)
+{
+	format_ = format;
+
+	gridWidthVar_->SetInt(gridWidth);
+	heightMinVar_->SetFloat(heightMin);
+	heightRangeVar_->SetFloat(heightRange);
+}
+
 /*
 	Name		TerrainShader::deinitialise
 	Syntax		TerrainShader::deinitialise()
@@ -93,14 +138,16 @@ void TerrainShader::deinitialise()
 
 /*
 	Name		TerrainShader::render
-	Syntax		TerrainShader::render(D3DXVECTOR3* cameraPos, Light* light, D3DXVECTOR3* fogColour, int indices)
+	Syntax		TerrainShader::render(D3DXVECTOR3* cameraPos, Light* light, D3DXVECTOR3* fogColour,
+									  const std::vector<TerrainDraw>& draws)
 	Param		D3DXVECTOR3* cameraPos - The position of the camera in the scene
 	Param		Light* light - Light data
 	Param		D3DXVECTOR3* fogColour - The colour of the fog effect to apply to the terrain
-	Param		int indices - The number of indices to render
+	Param		const std::vector<TerrainDraw>& draws - The parts of the terrain to render
 	Brief		Prepares the shader for rendering
 */
-void TerrainShader::render(D3DXVECTOR3* cameraPos, Light* light, D3DXVECTOR3* fogColour, int indices)
+void TerrainShader::render(D3DXVECTOR3* cameraPos, Light* light, D3DXVECTOR3* fogColour,
+						   const std::vector<TerrainDraw>& draws)
 {
 	// Set constants
 	wvpVar_->SetMatrix((float*)&Scene::instance()->getWVP());
@@ -118,18 +165,42 @@ void TerrainShader::render(D3DXVECTOR3* cameraPos, Light* light, D3DXVECTOR3* fo
 
     D3D10_TECHNIQUE_DESC techniqueDesc;
 	unsigned int i;
+
+	ID3D10EffectTechnique* technique = technique_;
+	ID3D10InputLayout* layout = vertexLayout_;
+	if (format_ == TERRAIN_VERTEX_COMPACT)
+	{
+		technique = compactTechnique_;
+		layout = compactLayout_;
+	}
 	
 	// Set the input layout.
-	Scene::instance()->getDevice()->IASetInputLayout(vertexLayout_);
+	Scene::instance()->getDevice()->IASetInputLayout(layout);
 
 	// Get the description structure of the technique from inside the shader so it can be used for rendering.
-    technique_->GetDesc(&techniqueDesc);
+    technique->GetDesc(&techniqueDesc);
 
     // Go through each pass in the technique (should be just one currently) and render the triangles.
 	for(i=0; i<techniqueDesc.Passes; ++i)
     {
-        technique_->GetPassByIndex(i)->Apply(0);
-        Scene::instance()->getDevice()->DrawIndexed(indices, 0, 0);
+		ID3D10Buffer* indexBuffer = 0;
+		for (size_t d = 0; d < draws.size(); ++d)
+		{
+			// Draws sharing an index buffer come together, so it is rarely changed
+			if (draws[d].indexBuffer != indexBuffer)
+			{
+				indexBuffer = draws[d].indexBuffer;
+				Scene::instance()->getDevice()->IASetIndexBuffer(indexBuffer, draws[d].indexFormat, 0);
+			}
+
+			// SV_VertexID does not include the base vertex, so the compact
+			// vertex shader is told it to find the vertex's grid position
+			if (format_ == TERRAIN_VERTEX_COMPACT)
+				vertexBaseVar_->SetInt(draws[d].baseVertex);
+
+			technique->GetPassByIndex(i)->Apply(0);
+			Scene::instance()->getDevice()->DrawIndexed(draws[d].indexCount, draws[d].startIndex, draws[d].baseVertex);
+		}
     }
 
 }
@@ -10,7 +10,10 @@
 #ifndef TERRAINSHADER_H
 #define TERRAINSHADER_H
 
+#include <vector>
 #include "Shaders/Shader.hpp"
+#include "Graphics/Vertex.hpp"
+#include "Geometry/TerrainQuadtree.hpp"
 
 struct Light;
 
@@ -18,7 +21,8 @@ class TerrainShader : public Shader
 {
 public:
     bool initialise();
-	void render(D3DXVECTOR3* cameraPos, Light* light, D3DXVECTOR3* fogColour, int indices);
+	void render(D3DXVECTOR3* cameraPos, Light* light, D3DXVECTOR3* fogColour, const std::vector<TerrainDraw>& draws);
+	void setVertexFormat(TerrainVertexFormat format, int gridWidth, float heightMin, float heightRange);
 	void deinitialise();
 
 private:
@@ -28,6 +32,16 @@ private:
 	ID3D10EffectVectorVariable* cameraPosVar_;
 	ID3D10EffectVectorVariable* fogColourVar_;
 	ID3D10EffectVariable* lightVar_;
+
+	// Technique and layout for TERRAIN_VERTEX_COMPACT and the grid constants
+	// used to unpack its vertices
+	TerrainVertexFormat format_;
+	ID3D10EffectTechnique* compactTechnique_;
+	ID3D10InputLayout* compactLayout_;
+	ID3D10EffectScalarVariable* gridWidthVar_;
+	ID3D10EffectScalarVariable* heightMinVar_;
+	ID3D10EffectScalarVariable* heightRangeVar_;
+	ID3D10EffectScalarVariable* vertexBaseVar_;
 };
 
 #endif
\ No newline at end of file
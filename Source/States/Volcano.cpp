@@ -21,6 +21,12 @@
 #include "ParticleSystem\ParticleSystem.hpp"
 #include "ParticleSystem\Particle.hpp"
 
+namespace
+{
+	// Written by the bake key and loaded instead of generating when present
+	const char* BAKED_TERRAIN_FILE = "Assets/volcano.mvhf";
+}
+
 /*
 	Name		Volcano::Volcano
 	Syntax		Volcano()
@@ -31,7 +37,7 @@ Volcano::Volcano()
   screenQuad_(0), terrainShader_(0), skyMapShader_(0), heatHazeShader_(0), time_(0), hazeScroll_(0), 
   MOVESPEED(100), ROTATESPEED(50), fogColour_(0.5f, 0.5f, 0.6f), cameraRotation_(0.0f, 0.0f, 0.0f),
   ashRV_(0), fireRV_(0), smokeRV_(0), ash_(0), useHeatHaze_(true), particlesInitialised_(false),
-  currentCamera_(CAMERA_ONE), paused_(false)
+  currentCamera_(CAMERA_ONE), paused_(false), shownUploadedBytes_(0), shownProgress_(0)
 {
 }
 
@@ -81,13 +87,19 @@ bool Volcano::initialise()
 	}
 
 	terrain_ = new Terrain();
-	terrain_->initialise(d3dDevice_, 500);
+	if (GetFileAttributesA(BAKED_TERRAIN_FILE) == INVALID_FILE_ATTRIBUTES ||
+		!terrain_->initialise(d3dDevice_, BAKED_TERRAIN_FILE, TERRAIN_VERTEX_FULL))
+	{
+		terrain_->initialise(d3dDevice_, 500, TERRAIN_VERTEX_FULL);
+	}
 	terrain_->setPos(-250, -50, 25);
 	terrain_->setTheta(0, 0, 0);
 
 	// Create and initialise terrain shader
 	terrainShader_ = new TerrainShader;
 	terrainShader_->initialise();
+	terrainShader_->setVertexFormat(terrain_->getVertexFormat(), terrain_->getGridWidth(),
+									terrain_->getCompactHeightMin(), terrain_->getCompactHeightRange());
 
 	moveX_ = 0.0f;
 	moveY_ = 0.0f;
@@ -211,6 +223,10 @@ bool Volcano::update(float dt)
 		if (input_->isKeyPressed(DIK_C))
 			terrain_->autoComplete();
 
+		// Bake the completed volcano to load next time
+		if (input_->isKeyPressed(DIK_B) && terrain_->isComplete() && !terrain_->save(BAKED_TERRAIN_FILE))
+			MessageBox(0, "Bake terrain - Failed", "Error", MB_OK);
+
 		// Change camera
 		if (input_->isKeyPressed(DIK_V))
 		{
@@ -289,6 +305,19 @@ bool Volcano::update(float dt)
 		// Update the terrain - terrain generates over time
 		terrain_->update(dt);
 
+		// Show how much vertex data the terrain sent to the GPU this frame, and how
+		// far its generation has got
+		int progress = (int)(terrain_->getGenerationProgress() * 100.0f);
+		if (terrain_->getUploadedBytes() != shownUploadedBytes_ || progress != shownProgress_)
+		{
+			shownUploadedBytes_ = terrain_->getUploadedBytes();
+			shownProgress_ = progress;
+			char title[96];
+			sprintf_s(title, "Mordor - terrain upload %u KB/frame, generated %d%%", shownUploadedBytes_ / 1024,
+				shownProgress_);
+			SetWindowText(ghWnd, title);
+		}
+
 		// Update particle effects
 		if (terrain_->isComplete())
 		{
@@ -352,8 +381,8 @@ void Volcano::render()
 	Scene::instance()->setWVP();
 
 	// Render the terrain
-	terrain_->render();
-	terrainShader_->render(&camera_->getPosition(), &parallelLight_, &fogColour_, terrain_->getNumIndices());
+	terrain_->render(camera_->getPosition());
+	terrainShader_->render(&camera_->getPosition(), &parallelLight_, &fogColour_, terrain_->getDraws());
 
 	// Set world and wvp transformation matrices
 	Scene::instance()->setWorld(skySphere_->getWorld());
@@ -392,6 +421,9 @@ void Volcano::render()
 
 			// Set resources for heat haze shader
 			heatHazeShader_->setPerturbanceSRV(perturbance_);
+			heatHazeShader_->setPerturbanceScale(
+				(float)Scene::instance()->getWidth() / SimplexNoise::PERTURBANCE_TILE_SIZE,
+				(float)Scene::instance()->getHeight() / SimplexNoise::PERTURBANCE_TILE_SIZE);
 			heatHazeShader_->setSceneSRV(heatHazeMap_.getTextureSRV());
 
 			// Render scene using heat haze post-processing effect
@@ -80,6 +80,10 @@ private:
 	bool particlesInitialised_;
 	bool paused_;
 
+	// Terrain upload size and generation percentage last shown in the window title
+	UINT shownUploadedBytes_;
+	int shownProgress_;
+
 	ActiveCamera currentCamera_;
 	Camera* camera_;
 
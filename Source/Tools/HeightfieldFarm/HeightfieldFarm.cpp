@@ -0,0 +1,281 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Heightfield Farm
+	Brief		Headless batch volcano generator. Generates one volcano per seed in
+				[first, first + count) across every core and writes a CSV row of
+				statistics per seed: generation time, height range and mean, crater
+				depth, lava coverage and a height histogram.
+
+				Each worker slot owns one Heightfield, and so its own Random, and
+				reuses it for every seed it claims. The ridged noise layer only
+				depends on the grid size, so all slots share one noise field cache.
+				Rows are written in seed order whatever order they finished in.
+
+				Build from the repository root with
+					g++ -O2 -std=c++20 -pthread -ISource -o heightfieldfarm
+						Source/Tools/HeightfieldFarm/HeightfieldFarm.cpp
+						Source/Geometry/Heightfield.cpp
+						Source/Utilities/Random.cpp
+						Source/Utilities/NoiseField.cpp
+						Source/Utilities/NoiseFieldCache.cpp
+						Source/Utilities/SimplexNoiseBatch.cpp
+						Source/Utilities/SimplexNoiseGenerator.cpp
+						Source/Utilities/SimplexNoiseTables.cpp
+						Source/Utilities/StageTask.cpp
+						Source/Utilities/TaskGraph.cpp
+						Source/Utilities/WorkerPool.cpp
+
+				Usage
+					heightfieldfarm [--first <seed>] [--count <n>] [--grid <n>] [--threads <n>]
+									[--bins <n>] [--min-height <h>] [--max-height <h>]
+									[--output <file.csv>]
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Geometry/Heightfield.hpp"
+#include "Utilities/NoiseFieldCache.hpp"
+#include "Utilities/WorkerPool.hpp"
+
+namespace
+{
+	struct Options
+	{
+		Options()
+		: first(Random::DEFAULT_SEED), count(1000), grid(500), threads(0),
+		  bins(16), minHeight(-50.0f), maxHeight(250.0f), output(0)
+		{}
+
+		unsigned int first;
+		int count;
+		int grid;
+		int threads;
+		int bins;
+		float minHeight;	// Histogram range, heights outside go in the end bins
+		float maxHeight;
+		const char* output;
+	};
+
+	/*
+		Name		Stats
+		Brief		The statistics written for one volcano
+	*/
+	struct Stats
+	{
+		double seconds;
+		float minHeight;
+		float maxHeight;
+		float meanHeight;
+		float craterDepth;		// Peak height before the crater less the lowest point inside it
+		float lavaCoverage;		// Fraction of vertices that are lava
+		std::vector<int> histogram;
+	};
+
+	Options options;
+
+	double now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/*
+		Name		measure
+		Syntax		measure(const Heightfield& heightfield, Stats& stats)
+		Brief		Fills in everything but the generation time
+	*/
+	void measure(const Heightfield& heightfield, Stats& stats)
+	{
+		int size = heightfield.getSize();
+		int count = size * size;
+		const float* heights = heightfield.getHeights();
+		const unsigned int* types = heightfield.getTypes();
+
+		stats.histogram.assign(options.bins, 0);
+		float binScale = options.bins / (options.maxHeight - options.minHeight);
+
+		double sum = 0.0;
+		int lava = 0;
+		stats.minHeight = heights[0];
+		stats.maxHeight = heights[0];
+		for (int i = 0; i < count; ++i)
+		{
+			float h = heights[i];
+			if (h < stats.minHeight)
+				stats.minHeight = h;
+			if (h > stats.maxHeight)
+				stats.maxHeight = h;
+			sum += h;
+
+			if (types[i] == LAVA)
+				++lava;
+
+			int bin = (int)std::floor((h - options.minHeight) * binScale);
+			if (bin < 0)
+				bin = 0;
+			else if (bin >= options.bins)
+				bin = options.bins - 1;
+			++stats.histogram[bin];
+		}
+
+		stats.meanHeight = (float)(sum / count);
+		stats.lavaCoverage = (float)lava / (float)count;
+
+		// Lowest point within the crater's radius
+		float craterX = heightfield.getCraterX();
+		float craterZ = heightfield.getCraterZ();
+		float radius = heightfield.getCraterRadius();
+		float floor = heightfield.getPeakHeight();
+		for (int z = 0; z < size; ++z)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				float dx = craterX - x;
+				float dz = craterZ - z;
+				if (dx * dx + dz * dz < radius * radius && heights[x + z * size] < floor)
+					floor = heights[x + z * size];
+			}
+		}
+		stats.craterDepth = heightfield.getPeakHeight() - floor;
+	}
+
+	void writeCsv(FILE* file, const std::vector<Stats>& results)
+	{
+		fprintf(file, "seed,grid,seconds,min_height,max_height,mean_height,crater_depth,lava_coverage");
+		for (int b = 0; b < options.bins; ++b)
+		{
+			fprintf(file, ",hist_%d", b);
+		}
+		fprintf(file, "\n");
+
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const Stats& stats = results[i];
+			fprintf(file, "%u,%d,%.6f,%.4f,%.4f,%.4f,%.4f,%.6f", options.first + (unsigned int)i, options.grid,
+				stats.seconds, stats.minHeight, stats.maxHeight, stats.meanHeight, stats.craterDepth, stats.lavaCoverage);
+			for (int b = 0; b < options.bins; ++b)
+			{
+				fprintf(file, ",%d", stats.histogram[b]);
+			}
+			fprintf(file, "\n");
+		}
+	}
+
+	bool parseArguments(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "--first") == 0 && i + 1 < argc)
+			{
+				options.first = (unsigned int)strtoul(argv[++i], 0, 10);
+			}
+			else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+			{
+				options.count = atoi(argv[++i]);
+			}
+			else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc)
+			{
+				options.grid = atoi(argv[++i]);
+			}
+			else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			{
+				options.threads = atoi(argv[++i]);
+			}
+			else if (strcmp(argv[i], "--bins") == 0 && i + 1 < argc)
+			{
+				options.bins = atoi(argv[++i]);
+			}
+			else if (strcmp(argv[i], "--min-height") == 0 && i + 1 < argc)
+			{
+				options.minHeight = (float)atof(argv[++i]);
+			}
+			else if (strcmp(argv[i], "--max-height") == 0 && i + 1 < argc)
+			{
+				options.maxHeight = (float)atof(argv[++i]);
+			}
+			else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+			{
+				options.output = argv[++i];
+			}
+			else
+			{
+				fprintf(stderr, "Usage: %s [--first <seed>] [--count <n>] [--grid <n>] [--threads <n>] "
+					"[--bins <n>] [--min-height <h>] [--max-height <h>] [--output <file.csv>]\n", argv[0]);
+				return false;
+			}
+		}
+
+		if (options.grid < 2 || options.count < 1 || options.bins < 1 || options.maxHeight <= options.minHeight)
+		{
+			fprintf(stderr, "Need --grid >= 2, --count >= 1, --bins >= 1 and --max-height > --min-height\n");
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (!parseArguments(argc, argv))
+		return 1;
+
+	// --threads counts the calling thread, like WorkerPool::getNumThreads
+	WorkerPool pool(options.threads > 0 ? options.threads - 1 : -1);
+	int slots = pool.getNumThreads();
+
+	SimplexNoise::NoiseFieldCache noiseCache(1);
+	std::vector<Stats> results(options.count);
+	std::atomic<int> next(0);
+
+	double start = now();
+
+	// One iteration per worker slot, each claiming seeds until none are left.
+	// A slot's noise generation is nested inside the loop, idle slots help with it.
+	pool.parallelFor(slots, [&](int)
+	{
+		Heightfield heightfield;
+		heightfield.setNoiseCache(&noiseCache);
+
+		for (int i = next.fetch_add(1); i < options.count; i = next.fetch_add(1))
+		{
+			double begin = now();
+
+			heightfield.setSeed(options.first + (unsigned int)i);
+			heightfield.initialise(options.grid + 1);
+			heightfield.generate(&pool);
+
+			results[i].seconds = now() - begin;
+			measure(heightfield, results[i]);
+		}
+	});
+
+	double total = now() - start;
+	fprintf(stderr, "%d volcanoes on %d threads in %.3f s (%.2f per second)\n",
+		options.count, slots, total, options.count / total);
+
+	FILE* file = stdout;
+	if (options.output)
+	{
+		file = fopen(options.output, "w");
+		if (!file)
+		{
+			fprintf(stderr, "Could not open %s\n", options.output);
+			return 1;
+		}
+	}
+
+	writeCsv(file, results);
+
+	if (file != stdout)
+		fclose(file);
+
+	return 0;
+}
@@ -0,0 +1,276 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Heightfield Generator
+	Brief		Headless command-line volcano generator. Runs every Heightfield stage
+				for a seed and grid size and writes the final heights as a Portable
+				Float Map and the rock/lava mask as a greyscale PGM (lava is white),
+				and bakes the volcano as a heightfield file Terrain can load.
+				Per stage timings are printed to stdout as JSON.
+
+				Build from the repository root with
+					g++ -O2 -std=c++20 -pthread -ISource -o heightfieldgen
+						Source/Tools/HeightfieldGenerator/HeightfieldGenerator.cpp
+						Source/Geometry/Heightfield.cpp
+						Source/Geometry/HeightfieldFile.cpp
+						Source/Utilities/Random.cpp
+						Source/Utilities/NoiseField.cpp
+						Source/Utilities/NoiseFieldCache.cpp
+						Source/Utilities/SimplexNoiseBatch.cpp
+						Source/Utilities/SimplexNoiseGenerator.cpp
+						Source/Utilities/SimplexNoiseTables.cpp
+						Source/Utilities/StageTask.cpp
+						Source/Utilities/TaskGraph.cpp
+						Source/Utilities/WorkerPool.cpp
+
+				Usage
+					heightfieldgen [--seed <n>] [--grid <n>] [--threads <n>] [--output <prefix>]
+
+				writes <prefix>_height.pfm, <prefix>_mask.pgm and <prefix>.mvhf
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Geometry/Heightfield.hpp"
+#include "Geometry/HeightfieldFile.hpp"
+#include "Utilities/WorkerPool.hpp"
+
+namespace
+{
+	// The emitters the volcano scene has, as Terrain places them
+	const int FIRE_EMITTERS = 15;
+	const int SMOKE_EMITTERS = 5;
+	const float ASH_HEIGHT = 150.0f;
+
+	struct Options
+	{
+		Options() : seed(Random::DEFAULT_SEED), grid(500), threads(0), output("volcano") {}
+
+		unsigned int seed;
+		int grid;
+		int threads;
+		const char* output;
+	};
+
+	struct Stage
+	{
+		const char* name;
+		double seconds;
+	};
+
+	Options options;
+
+	double now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/*
+		Name		writeHeights
+		Syntax		writeHeights(const Heightfield& heightfield, const std::string& path)
+		Brief		Writes the heights as a little-endian greyscale PFM. PFM stores rows
+					bottom to top, so the first heightfield row is written last.
+	*/
+	bool writeHeights(const Heightfield& heightfield, const std::string& path)
+	{
+		FILE* file = fopen(path.c_str(), "wb");
+		if (!file)
+			return false;
+
+		int size = heightfield.getSize();
+		fprintf(file, "Pf\n%d %d\n-1.0\n", size, size);
+		for (int row = size - 1; row >= 0; --row)
+		{
+			fwrite(heightfield.getHeights() + row * size, sizeof(float), size, file);
+		}
+
+		fclose(file);
+		return true;
+	}
+
+	/*
+		Name		writeMask
+		Syntax		writeMask(const Heightfield& heightfield, const std::string& path)
+		Brief		Writes the materials as a binary PGM, 0 for rock and 255 for lava
+	*/
+	bool writeMask(const Heightfield& heightfield, const std::string& path)
+	{
+		FILE* file = fopen(path.c_str(), "wb");
+		if (!file)
+			return false;
+
+		int size = heightfield.getSize();
+		fprintf(file, "P5\n%d %d\n255\n", size, size);
+
+		std::vector<unsigned char> row(size);
+		const unsigned int* types = heightfield.getTypes();
+		for (int r = 0; r < size; ++r)
+		{
+			for (int c = 0; c < size; ++c)
+			{
+				row[c] = (types[r * size + c] == LAVA) ? 255 : 0;
+			}
+			fwrite(&row[0], 1, size, file);
+		}
+
+		fclose(file);
+		return true;
+	}
+
+	/*
+		Name		writeBaked
+		Syntax		writeBaked(Heightfield& heightfield, const std::string& path)
+		Brief		Picks the volcano's emitters and saves it as a heightfield file
+	*/
+	bool writeBaked(Heightfield& heightfield, const std::string& path)
+	{
+		std::vector<HeightfieldEmitter> emitters;
+		HeightfieldEmitter emitter;
+
+		emitter.type = EMITTER_ASH;
+		emitter.position.x = heightfield.getCraterX();
+		emitter.position.y = heightfield.getPeakHeight() + ASH_HEIGHT;
+		emitter.position.z = heightfield.getCraterZ();
+		emitters.push_back(emitter);
+
+		std::vector<HeightfieldPoint> points = heightfield.pickLavaPoints(FIRE_EMITTERS);
+		emitter.type = EMITTER_FIRE;
+		for (size_t i = 0; i < points.size(); ++i)
+		{
+			emitter.position = points[i];
+			emitters.push_back(emitter);
+		}
+
+		points = heightfield.pickLavaPoints(SMOKE_EMITTERS);
+		emitter.type = EMITTER_SMOKE;
+		for (size_t i = 0; i < points.size(); ++i)
+		{
+			emitter.position = points[i];
+			emitters.push_back(emitter);
+		}
+
+		return HeightfieldFile::save(path.c_str(), heightfield, emitters);
+	}
+
+	bool parseArguments(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			{
+				options.seed = (unsigned int)strtoul(argv[++i], 0, 10);
+			}
+			else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc)
+			{
+				options.grid = atoi(argv[++i]);
+			}
+			else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			{
+				options.threads = atoi(argv[++i]);
+			}
+			else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+			{
+				options.output = argv[++i];
+			}
+			else
+			{
+				fprintf(stderr, "Usage: %s [--seed <n>] [--grid <n>] [--threads <n>] [--output <prefix>]\n", argv[0]);
+				return false;
+			}
+		}
+
+		if (options.grid < 2)
+		{
+			fprintf(stderr, "--grid must be at least 2\n");
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (!parseArguments(argc, argv))
+		return 1;
+
+	// --threads counts the calling thread, like WorkerPool::getNumThreads
+	WorkerPool* pool = WorkerPool::instance();
+	WorkerPool ownPool(options.threads > 0 ? options.threads - 1 : 0);
+	if (options.threads > 0)
+		pool = &ownPool;
+
+	Heightfield heightfield;
+	heightfield.setSeed(options.seed);
+
+	// The grid size counts quads, as in Terrain::initialise
+	double start = now();
+	heightfield.initialise(options.grid + 1);
+
+	std::vector<Stage> stages;
+	Stage stage;
+	double time = now();
+
+	stage.name = "initialise";
+	stage.seconds = time - start;
+	stages.push_back(stage);
+
+	heightfield.generateMountain();
+	stage.name = "mountain";
+	stage.seconds = now() - time;
+	stages.push_back(stage);
+	time = now();
+
+	heightfield.generateCrater();
+	stage.name = "crater";
+	stage.seconds = now() - time;
+	stages.push_back(stage);
+	time = now();
+
+	heightfield.generateNoise(pool);
+	stage.name = "noise";
+	stage.seconds = now() - time;
+	stages.push_back(stage);
+	time = now();
+
+	for (int i = 0; i < Heightfield::LAVA_FLOWS; ++i)
+	{
+		heightfield.generateLavaFlow();
+	}
+	stage.name = "lava_flows";
+	stage.seconds = now() - time;
+	stages.push_back(stage);
+
+	double total = now() - start;
+
+	std::string prefix = options.output;
+	if (!writeHeights(heightfield, prefix + "_height.pfm") || !writeMask(heightfield, prefix + "_mask.pgm") ||
+		!writeBaked(heightfield, prefix + ".mvhf"))
+	{
+		fprintf(stderr, "Could not write %s_height.pfm, %s_mask.pgm or %s.mvhf\n",
+			options.output, options.output, options.output);
+		return 1;
+	}
+
+	printf("{\n");
+	printf("\t\"seed\": %u,\n", options.seed);
+	printf("\t\"grid\": %d,\n", options.grid);
+	printf("\t\"threads\": %d,\n", pool->getNumThreads());
+	printf("\t\"lava_points\": %d,\n", (int)heightfield.getLavaPoints().size());
+	printf("\t\"stages\": {\n");
+	for (size_t i = 0; i < stages.size(); ++i)
+	{
+		printf("\t\t\"%s\": %.6f,\n", stages[i].name, stages[i].seconds);
+	}
+	printf("\t\t\"total\": %.6f\n", total);
+	printf("\t}\n");
+	printf("}\n");
+
+	return 0;
+}
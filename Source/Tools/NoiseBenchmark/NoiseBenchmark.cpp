@@ -0,0 +1,507 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Noise Benchmark
+	Brief		Headless micro-benchmark for the SimplexNoise namespace. Times the double
+				precision per-point functions (the original code path), the batch kernels
+				at each SIMD level and batch size, and the tiled field generator at each
+				octave and thread count. Prints a table to stderr and JSON to stdout (or
+				to the file given with --output). The periodic noise is checked against
+				its contract first, exiting with 1 if it fails.
+
+				Build from the repository root with
+					g++ -O2 -std=c++17 -pthread -ISource -o noisebench
+						Source/Tools/NoiseBenchmark/NoiseBenchmark.cpp
+						Source/Utilities/SimplexNoiseBatch.cpp
+						Source/Utilities/SimplexNoiseGenerator.cpp
+						Source/Utilities/SimplexNoiseTables.cpp
+						Source/Utilities/NoiseField.cpp
+						Source/Utilities/WorkerPool.cpp
+
+				Usage
+					noisebench [--quick] [--min-time <ms>] [--threads <n>] [--output <file>]
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Utilities/NoiseField.hpp"
+#include "Utilities/SimplexNoiseBatch.hpp"
+#include "Utilities/SimplexNoiseGenerator.hpp"
+#include "Utilities/SimplexNoiseKernels.hpp"
+#include "Utilities/WorkerPool.hpp"
+
+namespace
+{
+	/*
+		Name		Result
+		Brief		One timed configuration. Fields that do not apply are left at 0.
+	*/
+	struct Result
+	{
+		std::string name;
+		std::string precision;
+		std::string simd;
+		int dimensions;
+		int octaves;
+		int batch;
+		int threads;
+		long long samples;
+		double seconds;
+	};
+
+	struct Options
+	{
+		Options() : quick(false), minSeconds(0.25), maxThreads(0), output(0) {}
+
+		bool quick;
+		double minSeconds;
+		int maxThreads;
+		const char* output;
+	};
+
+	Options options;
+	std::vector<Result> results;
+
+	// Keeps the compiler from discarding the work being timed
+	volatile double sink = 0.0;
+
+	const char* SIMD_NAMES[] = { "scalar", "sse2", "avx2" };
+
+	double now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/*
+		Name		measure
+		Syntax		measure(Result result, long long samplesPerCall, Call call)
+		Param		Result result - The configuration, samples and seconds are filled in
+		Param		long long samplesPerCall - Noise samples produced by one call
+		Param		Call call - The work to time, returning a checksum
+		Brief		Runs call once to warm up, then repeatedly until the minimum time has
+					passed, and records the average
+	*/
+	template <typename Call>
+	void measure(Result result, long long samplesPerCall, Call call)
+	{
+		sink = sink + call();
+
+		long long calls = 0;
+		double start = now();
+		double elapsed = 0.0;
+		do
+		{
+			sink = sink + call();
+			++calls;
+			elapsed = now() - start;
+		} while (elapsed < options.minSeconds);
+
+		result.samples = calls * samplesPerCall;
+		result.seconds = elapsed;
+		results.push_back(result);
+
+		double ns = result.seconds * 1e9 / (double)result.samples;
+		fprintf(stderr, "%-28s %-6s %-6s d=%d oct=%-2d batch=%-6d thr=%-2d %10.2f ns/sample %12.0f samples/s\n",
+			result.name.c_str(), result.precision.c_str(), result.simd.c_str(), result.dimensions,
+			result.octaves, result.batch, result.threads, ns, 1e9 / ns);
+	}
+
+	Result makeResult(const char* name, const char* precision, const char* simd, int dimensions)
+	{
+		Result result;
+		result.name = name;
+		result.precision = precision;
+		result.simd = simd;
+		result.dimensions = dimensions;
+		result.octaves = 0;
+		result.batch = 0;
+		result.threads = 1;
+		result.samples = 0;
+		result.seconds = 0.0;
+		return result;
+	}
+
+	/*
+		Name		Points
+		Brief		Sample positions spread over [-128, 128), generated with a fixed LCG so
+					every run times the same inputs
+	*/
+	struct Points
+	{
+		explicit Points(int count)
+		{
+			unsigned int state = 12345u;
+			for (int d = 0; d < 4; ++d)
+			{
+				coords[d].resize(count);
+				for (int i = 0; i < count; ++i)
+				{
+					state = state * 1664525u + 1013904223u;
+					coords[d][i] = (float)(state >> 8) * (256.0f / 16777216.0f) - 128.0f;
+				}
+			}
+		}
+
+		std::vector<float> coords[4];
+	};
+
+	/*
+		Name		checkPeriodic
+		Syntax		checkPeriodic(const SimplexNoise::Generator& generator)
+		Param		const SimplexNoise::Generator& generator - Supplies the permutation
+		Return		bool - False if periodicSimplexNoise does not repeat every period, or
+					differs from simplexNoise more than the kernel radius inside the
+					first period
+	*/
+	bool checkPeriodic(const SimplexNoise::Generator& generator)
+	{
+		typedef SimplexNoise::SimplexConstants<double, 3> C;
+		const int* perm = generator.getPermutation();
+		const int period[3] = {6, 9, 12};
+		double margin = std::sqrt(C::RADIUS);
+		int repeats = 0;
+		int matches = 0;
+		int interior = 0;
+		int samples = 0;
+
+		// An off-lattice grid over the first period, so no sample sits on a face
+		for (int i = 0; i < 4 * period[0]; ++i)
+		{
+			for (int j = 0; j < 4 * period[1]; ++j)
+			{
+				for (int k = 0; k < 4 * period[2]; ++k)
+				{
+					double in[3] = {i * 0.25 + 0.013, j * 0.25 + 0.029, k * 0.25 + 0.007};
+					double value = SimplexNoise::periodicSimplexNoise<double>(in, period, perm);
+					++samples;
+
+					bool isInterior = true;
+					for (int d = 0; d < 3; ++d)
+					{
+						double shifted[3] = {in[0], in[1], in[2]};
+						shifted[d] += period[d];
+						if (std::fabs(SimplexNoise::periodicSimplexNoise<double>(shifted, period, perm) - value) < 1e-9)
+							++repeats;
+
+						if (in[d] <= margin || in[d] >= period[d] - margin)
+							isInterior = false;
+					}
+
+					if (isInterior)
+					{
+						++interior;
+						if (SimplexNoise::simplexNoise<double, 3>(in, perm) == value)
+							++matches;
+					}
+				}
+			}
+		}
+
+		if (repeats != 3 * samples || matches != interior)
+		{
+			fprintf(stderr, "Periodic noise check failed: %d of %d shifts repeat, %d of %d interior samples match\n",
+				repeats, 3 * samples, matches, interior);
+			return false;
+		}
+		return true;
+	}
+
+	void benchmarkScalar(const SimplexNoise::Generator& generator, const Points& points)
+	{
+		const int count = (int)points.coords[0].size();
+		const float* x = &points.coords[0][0];
+		const float* y = &points.coords[1][0];
+		const float* z = &points.coords[2][0];
+		const float* w = &points.coords[3][0];
+
+		// The original per-point double path
+		measure(makeResult("noise", "double", "scalar", 2), count, [&]()
+		{
+			double sum = 0.0;
+			for (int i = 0; i < count; ++i)
+				sum += generator.noise(x[i], y[i]);
+			return sum;
+		});
+		measure(makeResult("noise", "double", "scalar", 3), count, [&]()
+		{
+			double sum = 0.0;
+			for (int i = 0; i < count; ++i)
+				sum += generator.noise(x[i], y[i], z[i]);
+			return sum;
+		});
+		measure(makeResult("noise", "double", "scalar", 4), count, [&]()
+		{
+			double sum = 0.0;
+			for (int i = 0; i < count; ++i)
+				sum += generator.noise(x[i], y[i], z[i], w[i]);
+			return sum;
+		});
+
+		// 4D has no batch kernel, so time the float template instantiation too
+		measure(makeResult("noise", "float", "scalar", 4), count, [&]()
+		{
+			const int* perm = generator.getPermutation();
+			double sum = 0.0;
+			for (int i = 0; i < count; ++i)
+			{
+				float in[4] = { x[i], y[i], z[i], w[i] };
+				sum += SimplexNoise::simplexNoise<float, 4>(in, perm);
+			}
+			return sum;
+		});
+
+		const int octaveCounts[] = { 1, 4, 10 };
+		for (int o = 0; o < 3; ++o)
+		{
+			int octaves = octaveCounts[o];
+			int fractalCount = count / octaves;
+
+			for (int dimensions = 2; dimensions <= 4; ++dimensions)
+			{
+				Result fbm = makeResult("fBm", "double", "scalar", dimensions);
+				Result turbulence = makeResult("turbulence", "double", "scalar", dimensions);
+				Result ridged = makeResult("ridgedMultifractal", "double", "scalar", dimensions);
+				fbm.octaves = turbulence.octaves = ridged.octaves = octaves;
+
+				// Samples are counted per output value, each costs octaves noise calls
+				measure(fbm, fractalCount, [&]()
+				{
+					double sum = 0.0;
+					for (int i = 0; i < fractalCount; ++i)
+					{
+						if (dimensions == 2)
+							sum += generator.fBm(x[i], y[i], octaves);
+						else if (dimensions == 3)
+							sum += generator.fBm(x[i], y[i], z[i], octaves);
+						else
+							sum += generator.fBm(x[i], y[i], z[i], (double)w[i], octaves);
+					}
+					return sum;
+				});
+				measure(turbulence, fractalCount, [&]()
+				{
+					double sum = 0.0;
+					for (int i = 0; i < fractalCount; ++i)
+					{
+						if (dimensions == 2)
+							sum += generator.turbulence(x[i], y[i], octaves);
+						else if (dimensions == 3)
+							sum += generator.turbulence(x[i], y[i], z[i], octaves);
+						else
+							sum += generator.turbulence(x[i], y[i], z[i], (double)w[i], octaves);
+					}
+					return sum;
+				});
+				measure(ridged, fractalCount, [&]()
+				{
+					double sum = 0.0;
+					for (int i = 0; i < fractalCount; ++i)
+					{
+						if (dimensions == 2)
+							sum += generator.ridgedMultifractal(x[i], y[i], octaves);
+						else if (dimensions == 3)
+							sum += generator.ridgedMultifractal(x[i], y[i], z[i], octaves);
+						else
+							sum += generator.ridgedMultifractal(x[i], y[i], z[i], (double)w[i], octaves);
+					}
+					return sum;
+				});
+			}
+		}
+	}
+
+	void benchmarkBatch(const SimplexNoise::Generator& generator, const Points& points)
+	{
+		const int count = (int)points.coords[0].size();
+		std::vector<float> out(count), dx(count), dy(count), dz(count);
+
+		const int batchSizes[] = { 16, 256, 4096, 65536 };
+		for (int level = 0; level <= (int)SimplexNoise::getSupportedSimdLevel(); ++level)
+		{
+			SimplexNoise::setSimdLevel((SimplexNoise::SimdLevel)level);
+
+			for (int b = 0; b < 4; ++b)
+			{
+				int batch = (batchSizes[b] < count) ? batchSizes[b] : count;
+				int total = count - count % batch;
+
+				Result noise2 = makeResult("noise2 batch", "float", SIMD_NAMES[level], 2);
+				Result noise3 = makeResult("noise3 batch", "float", SIMD_NAMES[level], 3);
+				Result derivative = makeResult("noise3Derivative batch", "float", SIMD_NAMES[level], 3);
+				noise2.batch = noise3.batch = derivative.batch = batch;
+
+				measure(noise2, total, [&]()
+				{
+					for (int i = 0; i < total; i += batch)
+						generator.noise2(&points.coords[0][i], &points.coords[1][i], &out[i], batch);
+					return (double)out[total - 1];
+				});
+				measure(noise3, total, [&]()
+				{
+					for (int i = 0; i < total; i += batch)
+						generator.noise3(&points.coords[0][i], &points.coords[1][i], &points.coords[2][i], &out[i], batch);
+					return (double)out[total - 1];
+				});
+				measure(derivative, total, [&]()
+				{
+					for (int i = 0; i < total; i += batch)
+						generator.noise3Derivative(&points.coords[0][i], &points.coords[1][i], &points.coords[2][i],
+							&out[i], &dx[i], &dy[i], &dz[i], batch);
+					return (double)out[total - 1] + dx[total - 1];
+				});
+			}
+		}
+
+		SimplexNoise::setSimdLevel(SimplexNoise::getSupportedSimdLevel());
+	}
+
+	void benchmarkField(const SimplexNoise::Generator& generator)
+	{
+		const int size = options.quick ? 256 : 1024;
+		std::vector<float> out(size * size);
+
+		std::vector<int> threadCounts;
+		for (int threads = 1; threads <= options.maxThreads; threads *= 2)
+			threadCounts.push_back(threads);
+		if (threadCounts.back() != options.maxThreads)
+			threadCounts.push_back(options.maxThreads);
+
+		const SimplexNoise::FractalType types[] = {
+			SimplexNoise::FRACTAL_FBM, SimplexNoise::FRACTAL_TURBULENCE, SimplexNoise::FRACTAL_RIDGED_MULTIFRACTAL };
+		const char* typeNames[] = { "fBm field", "turbulence field", "ridgedMultifractal field" };
+		const int octaveCounts[] = { 1, 4, 10 };
+
+		for (size_t t = 0; t < threadCounts.size(); ++t)
+		{
+			int threads = threadCounts[t];
+			WorkerPool pool(threads - 1);
+			WorkerPool* usePool = (threads > 1) ? &pool : 0;
+
+			for (int type = 0; type < 3; ++type)
+			{
+				for (int o = 0; o < 3; ++o)
+				{
+					SimplexNoise::FieldDesc desc;
+					desc.type = types[type];
+					desc.octaves = octaveCounts[o];
+					desc.lacunarity = 1.5f;
+					desc.stepX = desc.stepY = 1.0f / 128.0f;
+					desc.rows = desc.columns = size;
+
+					Result result = makeResult(typeNames[type], "float", SIMD_NAMES[SimplexNoise::getSimdLevel()], 2);
+					result.octaves = desc.octaves;
+					result.batch = SimplexNoise::FIELD_TILE_SIZE * SimplexNoise::FIELD_TILE_SIZE;
+					result.threads = threads;
+
+					measure(result, (long long)size * size, [&]()
+					{
+						SimplexNoise::generateField(generator, desc, &out[0], usePool);
+						return (double)out[size * size / 2];
+					});
+				}
+			}
+		}
+	}
+
+	void writeJson(FILE* file)
+	{
+		fprintf(file, "{\n");
+		fprintf(file, "\t\"benchmark\": \"SimplexNoise\",\n");
+		fprintf(file, "\t\"simd_supported\": \"%s\",\n", SIMD_NAMES[SimplexNoise::getSupportedSimdLevel()]);
+		fprintf(file, "\t\"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+		fprintf(file, "\t\"min_time_seconds\": %g,\n", options.minSeconds);
+		fprintf(file, "\t\"results\": [\n");
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const Result& r = results[i];
+			double ns = r.seconds * 1e9 / (double)r.samples;
+			fprintf(file, "\t\t{\"name\": \"%s\", \"precision\": \"%s\", \"simd\": \"%s\", \"dimensions\": %d, "
+				"\"octaves\": %d, \"batch\": %d, \"threads\": %d, \"samples\": %lld, \"seconds\": %.6f, "
+				"\"ns_per_sample\": %.3f, \"samples_per_second\": %.1f}%s\n",
+				r.name.c_str(), r.precision.c_str(), r.simd.c_str(), r.dimensions, r.octaves, r.batch,
+				r.threads, r.samples, r.seconds, ns, 1e9 / ns, (i + 1 < results.size()) ? "," : "");
+		}
+		fprintf(file, "\t]\n");
+		fprintf(file, "}\n");
+	}
+
+	bool parseArguments(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "--quick") == 0)
+			{
+				options.quick = true;
+				options.minSeconds = 0.05;
+			}
+			else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+			{
+				options.minSeconds = atof(argv[++i]) / 1000.0;
+			}
+			else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			{
+				options.maxThreads = atoi(argv[++i]);
+			}
+			else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+			{
+				options.output = argv[++i];
+			}
+			else
+			{
+				fprintf(stderr, "Usage: %s [--quick] [--min-time <ms>] [--threads <n>] [--output <file>]\n", argv[0]);
+				return false;
+			}
+		}
+
+		if (options.maxThreads <= 0)
+		{
+			options.maxThreads = (int)std::thread::hardware_concurrency();
+			if (options.maxThreads <= 0)
+				options.maxThreads = 1;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (!parseArguments(argc, argv))
+		return 1;
+
+	const SimplexNoise::Generator& generator = SimplexNoise::getDefaultGenerator();
+	Points points(options.quick ? 16384 : 65536);
+
+	if (!checkPeriodic(generator))
+		return 1;
+
+	benchmarkScalar(generator, points);
+	benchmarkBatch(generator, points);
+	benchmarkField(generator);
+
+	FILE* file = stdout;
+	if (options.output)
+	{
+		file = fopen(options.output, "w");
+		if (!file)
+		{
+			fprintf(stderr, "Could not open %s\n", options.output);
+			return 1;
+		}
+	}
+
+	writeJson(file);
+
+	if (file != stdout)
+		fclose(file);
+
+	return 0;
+}
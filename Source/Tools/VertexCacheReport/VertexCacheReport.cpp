@@ -0,0 +1,185 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Vertex Cache Report
+	Brief		Headless report of how well the terrain's index lists use the GPU's
+				post-transform vertex cache. Builds the lists Terrain draws, the whole
+				terrain in bands of rows and the quadtree's chunk lists, and prints
+				ACMR and ATVR for a FIFO cache before and after they are reordered,
+				with the size of the index data.
+
+				ACMR is the vertices transformed per triangle, ATVR the vertices
+				transformed per vertex used. Both are 1 lower for every vertex the
+				cache saves, so lower is better.
+
+				Build from the repository root with
+					g++ -O2 -std=c++17 -ISource -o vertexcachereport
+						Source/Tools/VertexCacheReport/VertexCacheReport.cpp
+						Source/Geometry/TerrainIndices.cpp
+						Source/Utilities/VertexCache.cpp
+
+				Usage
+					vertexcachereport [--grid <n>] [--cache <n>]
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Geometry/TerrainIndices.hpp"
+#include "Utilities/VertexCache.hpp"
+
+namespace
+{
+	// Quads along each side of a chunk, as TerrainQuadtree::CHUNK_QUADS
+	const int CHUNK_QUADS = 32;
+
+	struct Options
+	{
+		Options()
+		: grid(500), cache(16)
+		{}
+
+		int grid;
+		int cache;		// Entries in the simulated FIFO cache
+	};
+
+	/*
+		Name		Report
+		Brief		Totals for a set of lists, each measured on its own as each is
+					its own draw call
+	*/
+	struct Report
+	{
+		Report()
+		: triangles(0), vertices(0), missesBefore(0), missesAfter(0), bytesBefore(0), bytesAfter(0)
+		{}
+
+		int triangles;
+		int vertices;
+		int missesBefore;
+		int missesAfter;
+		int bytesBefore;
+		int bytesAfter;
+	};
+
+	Options options;
+
+	/*
+		Name		addList
+		Syntax		addList(Report& report, std::vector<unsigned int>& indices, bool isShort)
+		Param		Report& report - The totals to add the list to
+		Param		std::vector<unsigned int>& indices - The list in build order, reordered
+		Param		bool isShort - Whether the reordered list is drawn with 16-bit indices
+	*/
+	void addList(Report& report, std::vector<unsigned int>& indices, bool isShort)
+	{
+		int count = (int)indices.size();
+		VertexCache::CacheStats before = VertexCache::measure(&indices[0], count, options.cache);
+		VertexCache::optimise(&indices[0], count);
+		VertexCache::CacheStats after = VertexCache::measure(&indices[0], count, options.cache);
+
+		report.triangles += before.triangles;
+		report.vertices += before.vertices;
+		report.missesBefore += before.misses;
+		report.missesAfter += after.misses;
+		report.bytesBefore += count * 4;
+		report.bytesAfter += count * (isShort ? 2 : 4);
+	}
+
+	void printReport(const char* name, int lists, const Report& report)
+	{
+		printf("%-28s %6d %10d %10d  %6.3f %6.3f  %6.3f %6.3f  %10d %10d\n", name, lists,
+			report.triangles, report.vertices,
+			(float)report.missesBefore / report.triangles, (float)report.missesAfter / report.triangles,
+			(float)report.missesBefore / report.vertices, (float)report.missesAfter / report.vertices,
+			report.bytesBefore, report.bytesAfter);
+	}
+
+	bool parseArguments(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc)
+			{
+				options.grid = atoi(argv[++i]);
+			}
+			else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+			{
+				options.cache = atoi(argv[++i]);
+			}
+			else
+			{
+				fprintf(stderr, "Usage: %s [--grid <n>] [--cache <n>]\n", argv[0]);
+				return false;
+			}
+		}
+
+		if (options.grid < 2 || options.cache < 3)
+		{
+			fprintf(stderr, "Need --grid >= 2 and --cache >= 3\n");
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (!parseArguments(argc, argv))
+		return 1;
+
+	int width = options.grid + 1;
+	int bandRows = TerrainIndices::SHORT_INDEX_VERTICES / width - 1;
+	if (bandRows < 1)
+	{
+		fprintf(stderr, "Grid too wide for 16-bit indices\n");
+		return 1;
+	}
+
+	printf("FIFO cache of %d vertices, grid of %d quads\n\n", options.cache, options.grid);
+	printf("%-28s %6s %10s %10s  %13s  %13s  %21s\n", "", "", "", "", "ACMR", "ATVR", "index bytes");
+	printf("%-28s %6s %10s %10s  %6s %6s  %6s %6s  %10s %10s\n", "lists", "count", "triangles", "vertices",
+		"before", "after", "before", "after", "before", "after");
+
+	std::vector<unsigned int> indices;
+
+	// The whole terrain, as drawn when it is not chunked
+	Report whole;
+	int bands = 0;
+	for (int i = 0; i < options.grid; i += bandRows)
+	{
+		indices.clear();
+		TerrainIndices::buildGrid(indices, i, std::min(options.grid - i, bandRows), options.grid, 1, width);
+		addList(whole, indices, true);
+		++bands;
+	}
+	printReport("whole terrain bands", bands, whole);
+
+	// Chunk lists. How far apart a chunk's vertices are does not change how
+	// they use the cache, only whether 16-bit indices reach them all.
+	for (int stride = 1; stride * CHUNK_QUADS <= options.grid; stride *= 2)
+	{
+		Report plain;
+		Report folded;
+		for (int mask = 0; mask < TerrainIndices::EDGE_MASKS; ++mask)
+		{
+			indices.clear();
+			TerrainIndices::buildGrid(indices, 0, CHUNK_QUADS, CHUNK_QUADS, stride, width, mask);
+			bool isShort = TerrainIndices::getMaxIndex(&indices[0], (int)indices.size()) < TerrainIndices::SHORT_INDEX_VERTICES;
+			addList(mask == 0 ? plain : folded, indices, isShort);
+		}
+
+		char name[64];
+		sprintf(name, "chunk stride %d", stride);
+		printReport(name, 1, plain);
+		sprintf(name, "chunk stride %d folded edges", stride);
+		printReport(name, TerrainIndices::EDGE_MASKS - 1, folded);
+	}
+
+	return 0;
+}
@@ -0,0 +1,141 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Noise Field
+	Brief		Definition of the fractal field functions
+*/
+
+#include <cmath>
+
+#include "Utilities/NoiseField.hpp"
+#include "Utilities/SimplexNoiseGenerator.hpp"
+#include "Utilities/WorkerPool.hpp"
+
+namespace
+{
+	const int TILE_POINTS = SimplexNoise::FIELD_TILE_SIZE * SimplexNoise::FIELD_TILE_SIZE;
+
+	int tileCount(int size)
+	{
+		return (size + SimplexNoise::FIELD_TILE_SIZE - 1) / SimplexNoise::FIELD_TILE_SIZE;
+	}
+}
+
+/*
+	Name		SimplexNoise::generateFieldTile
+	Syntax		SimplexNoise::generateFieldTile(const Generator& generator, const FieldDesc& desc,
+												int tileRow, int tileColumn, float* out)
+	Param		const Generator& generator - The noise source
+	Param		const FieldDesc& desc - The field being generated
+	Param		int tileRow, tileColumn - Which FIELD_TILE_SIZE square tile to fill
+	Param		float* out - The whole desc.rows * desc.columns field
+	Brief		Fills one tile of a field, evaluating each octave for the whole tile with
+				the batch noise. Sample positions are worked out from the point's index
+				in the whole field, so a point's value does not depend on the tiling.
+*/
+void SimplexNoise::generateFieldTile(const Generator& generator, const FieldDesc& desc, int tileRow, int tileColumn, float* out)
+{
+	float x[TILE_POINTS];
+	float y[TILE_POINTS];
+	float noise[TILE_POINTS];
+	float sum[TILE_POINTS];
+	float previous[TILE_POINTS];
+
+	int rowStart = tileRow * FIELD_TILE_SIZE;
+	int columnStart = tileColumn * FIELD_TILE_SIZE;
+	int rows = (desc.rows - rowStart < FIELD_TILE_SIZE) ? desc.rows - rowStart : FIELD_TILE_SIZE;
+	int columns = (desc.columns - columnStart < FIELD_TILE_SIZE) ? desc.columns - columnStart : FIELD_TILE_SIZE;
+	int count = rows * columns;
+
+	for (int n = 0; n < count; ++n)
+	{
+		sum[n] = 0.0f;
+		previous[n] = 1.0f;
+	}
+
+	float frequency = 1.0f;
+	float amplitude = (desc.type == FRACTAL_TURBULENCE) ? 1.0f : 0.5f;
+
+	for (int octave = 0; octave < desc.octaves; ++octave)
+	{
+		for (int r = 0; r < rows; ++r)
+		{
+			float px = (desc.originX + (rowStart + r) * desc.stepX) * frequency;
+			for (int c = 0; c < columns; ++c)
+			{
+				x[r * columns + c] = px;
+				y[r * columns + c] = (desc.originY + (columnStart + c) * desc.stepY) * frequency;
+			}
+		}
+
+		generator.noise2(x, y, noise, count);
+
+		switch (desc.type)
+		{
+		case FRACTAL_FBM:
+			for (int n = 0; n < count; ++n)
+				sum[n] += noise[n] * amplitude;
+			break;
+		case FRACTAL_TURBULENCE:
+			for (int n = 0; n < count; ++n)
+				sum[n] += std::fabs(noise[n]) * amplitude;
+			break;
+		case FRACTAL_RIDGED_MULTIFRACTAL:
+			for (int n = 0; n < count; ++n)
+			{
+				float h = desc.offset - std::fabs(noise[n]);
+				h *= h;
+				sum[n] += h * amplitude * previous[n];
+				previous[n] = h;
+			}
+			break;
+		}
+
+		frequency *= desc.lacunarity;
+		amplitude *= desc.gain;
+	}
+
+	for (int r = 0; r < rows; ++r)
+	{
+		float* row = out + (rowStart + r) * desc.columns + columnStart;
+		for (int c = 0; c < columns; ++c)
+		{
+			row[c] = sum[r * columns + c] * desc.scale;
+		}
+	}
+}
+
+/*
+	Name		SimplexNoise::generateField
+	Syntax		SimplexNoise::generateField(const Generator& generator, const FieldDesc& desc,
+											float* out, WorkerPool* pool)
+	Param		const Generator& generator - The noise source
+	Param		const FieldDesc& desc - The field to generate
+	Param		float* out - Receives desc.rows * desc.columns values
+	Param		WorkerPool* pool - Pool to spread the tiles over, or 0 to run serially
+	Brief		Fills a buffer with fractal noise. Tiles write disjoint parts of the
+				buffer and every point is computed the same way whichever thread runs
+				its tile, so the result is bit-identical to the serial path.
+*/
+void SimplexNoise::generateField(const Generator& generator, const FieldDesc& desc, float* out, WorkerPool* pool)
+{
+	int tileRows = tileCount(desc.rows);
+	int tileColumns = tileCount(desc.columns);
+	int tiles = tileRows * tileColumns;
+
+	if (!pool)
+	{
+		for (int tile = 0; tile < tiles; ++tile)
+		{
+			generateFieldTile(generator, desc, tile / tileColumns, tile % tileColumns, out);
+		}
+		return;
+	}
+
+	pool->parallelFor(tiles, [&](int tile)
+	{
+		generateFieldTile(generator, desc, tile / tileColumns, tile % tileColumns, out);
+	});
+}
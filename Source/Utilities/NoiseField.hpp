@@ -0,0 +1,60 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Noise Field
+	Brief		Declaration of the fractal field functions, which fill a 2D buffer with
+				fBm, turbulence or ridged multifractal noise a tile at a time
+*/
+
+#ifndef NOISEFIELD_H
+#define NOISEFIELD_H
+
+class WorkerPool;
+
+namespace SimplexNoise
+{
+	class Generator;
+
+	enum FractalType
+	{
+		FRACTAL_FBM,
+		FRACTAL_TURBULENCE,
+		FRACTAL_RIDGED_MULTIFRACTAL,
+	};
+
+	/*
+		Name		FieldDesc
+		Brief		Describes a fractal field. out[r * columns + c] is the fractal at
+					(originX + r * stepX, originY + c * stepY), multiplied by scale.
+	*/
+	struct FieldDesc
+	{
+		FieldDesc()
+		: type(FRACTAL_FBM), octaves(1), lacunarity(2.0f), gain(0.5f), offset(1.0f), scale(1.0f),
+		  originX(0.0f), originY(0.0f), stepX(1.0f), stepY(1.0f), rows(0), columns(0)
+		{}
+
+		FractalType type;
+		int octaves;
+		float lacunarity;
+		float gain;
+		float offset;		// Ridged multifractal only
+		float scale;
+		float originX;
+		float originY;
+		float stepX;
+		float stepY;
+		int rows;
+		int columns;
+	};
+
+	// Edge length of a field tile, 32x32 keeps a tile's working arrays within L1
+	const int FIELD_TILE_SIZE = 32;
+
+	void generateField(const Generator& generator, const FieldDesc& desc, float* out, WorkerPool* pool = 0);
+	void generateFieldTile(const Generator& generator, const FieldDesc& desc, int tileRow, int tileColumn, float* out);
+};
+
+#endif // NOISEFIELD_H
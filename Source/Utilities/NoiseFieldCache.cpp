@@ -0,0 +1,158 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Noise Field Cache
+	Brief		Definition of the NoiseFieldCache class
+*/
+
+#include "Utilities/NoiseFieldCache.hpp"
+#include "Utilities/SimplexNoiseGenerator.hpp"
+
+/*
+	Name		NoiseFieldCache::NoiseFieldCache
+	Syntax		NoiseFieldCache(int maxEntries)
+	Param		int maxEntries - The number of fields kept before the least recently
+				used is dropped
+*/
+SimplexNoise::NoiseFieldCache::NoiseFieldCache(int maxEntries)
+: maxEntries_(maxEntries > 0 ? maxEntries : 1), useCount_(0), hits_(0), misses_(0)
+{
+
+}
+
+/*
+	Name		NoiseFieldCache::get
+	Syntax		NoiseFieldCache::get(const Generator& generator, const FieldDesc& desc, WorkerPool* pool)
+	Param		const Generator& generator - The noise source, only its seed is part of the key
+	Param		const FieldDesc& desc - The field wanted
+	Param		WorkerPool* pool - Pool used if the field has to be generated, or 0
+	Return		FieldPtr - The field, desc.rows * desc.columns values laid out as
+				generateField writes them. Stays valid after the entry is evicted.
+	Brief		Returns the cached field for the seed and description, generating and
+				caching it first if needed. The lock is not held while generating, as
+				a thread waiting on the pool may run another get, so two threads
+				missing the same field at once both generate it and the first kept.
+*/
+SimplexNoise::FieldPtr SimplexNoise::NoiseFieldCache::get(const Generator& generator, const FieldDesc& desc, WorkerPool* pool)
+{
+	FieldPtr cached = find(generator, desc);
+	if (cached)
+		return cached;
+
+	std::shared_ptr<std::vector<float> > field(new std::vector<float>(desc.rows * desc.columns));
+	if (!field->empty())
+		generateField(generator, desc, &(*field)[0], pool);
+
+	return insert(generator, desc, field);
+}
+
+/*
+	Name		NoiseFieldCache::find
+	Syntax		NoiseFieldCache::find(const Generator& generator, const FieldDesc& desc)
+	Param		const Generator& generator - The noise source, only its seed is part of the key
+	Param		const FieldDesc& desc - The field wanted
+	Return		FieldPtr - The cached field, or none. Counted as a hit or a miss.
+	Brief		Looks the field up without generating it, for callers that generate
+				a missing field themselves a tile at a time
+*/
+SimplexNoise::FieldPtr SimplexNoise::NoiseFieldCache::find(const Generator& generator, const FieldDesc& desc)
+{
+	unsigned int seed = generator.getSeed();
+	std::lock_guard<std::mutex> lock(mutex_);
+	++useCount_;
+
+	for (size_t i = 0; i < entries_.size(); ++i)
+	{
+		if (matches(entries_[i], seed, desc))
+		{
+			++hits_;
+			entries_[i].lastUse = useCount_;
+			return entries_[i].field;
+		}
+	}
+
+	++misses_;
+	return FieldPtr();
+}
+
+/*
+	Name		NoiseFieldCache::insert
+	Syntax		NoiseFieldCache::insert(const Generator& generator, const FieldDesc& desc,
+										const FieldPtr& field)
+	Param		const Generator& generator - The noise source the field was generated with
+	Param		const FieldDesc& desc - The field's description
+	Param		const FieldPtr& field - The generated field
+	Return		FieldPtr - The field cached for the key, which is an earlier one if
+				another thread inserted the same field first
+	Brief		Caches a field, dropping the least recently used once full
+*/
+SimplexNoise::FieldPtr SimplexNoise::NoiseFieldCache::insert(const Generator& generator, const FieldDesc& desc,
+	const FieldPtr& field)
+{
+	unsigned int seed = generator.getSeed();
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (size_t i = 0; i < entries_.size(); ++i)
+	{
+		if (matches(entries_[i], seed, desc))
+			return entries_[i].field;
+	}
+
+	Entry entry;
+	entry.seed = seed;
+	entry.desc = desc;
+	entry.field = field;
+	entry.lastUse = useCount_;
+
+	if ((int)entries_.size() < maxEntries_)
+	{
+		entries_.push_back(entry);
+	}
+	else
+	{
+		size_t oldest = 0;
+		for (size_t i = 1; i < entries_.size(); ++i)
+		{
+			if (entries_[i].lastUse < entries_[oldest].lastUse)
+				oldest = i;
+		}
+		entries_[oldest] = entry;
+	}
+
+	return entry.field;
+}
+
+/*
+	Name		NoiseFieldCache::clear
+	Syntax		NoiseFieldCache::clear()
+	Brief		Drops every cached field
+*/
+void SimplexNoise::NoiseFieldCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.clear();
+}
+
+/*
+	Name		NoiseFieldCache::matches
+	Syntax		NoiseFieldCache::matches(const Entry& entry, unsigned int seed, const FieldDesc& desc)
+	Return		bool - True if the entry was generated from the same seed and description
+*/
+bool SimplexNoise::NoiseFieldCache::matches(const Entry& entry, unsigned int seed, const FieldDesc& desc)
+{
+	const FieldDesc& d = entry.desc;
+	return entry.seed == seed &&
+		d.type == desc.type &&
+		d.octaves == desc.octaves &&
+		d.lacunarity == desc.lacunarity &&
+		d.gain == desc.gain &&
+		d.offset == desc.offset &&
+		d.scale == desc.scale &&
+		d.originX == desc.originX &&
+		d.originY == desc.originY &&
+		d.stepX == desc.stepX &&
+		d.stepY == desc.stepY &&
+		d.rows == desc.rows &&
+		d.columns == desc.columns;
+}
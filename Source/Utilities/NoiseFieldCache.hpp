@@ -0,0 +1,58 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Noise Field Cache
+	Brief		Declaration of the NoiseFieldCache class, which keeps recently generated
+				fractal fields so a field that only depends on its description and the
+				generator's seed is not generated twice
+*/
+
+#ifndef NOISEFIELDCACHE_H
+#define NOISEFIELDCACHE_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Utilities/NoiseField.hpp"
+
+namespace SimplexNoise
+{
+	typedef std::shared_ptr<const std::vector<float> > FieldPtr;
+
+	class NoiseFieldCache
+	{
+	public:
+		explicit NoiseFieldCache(int maxEntries = 4);
+
+		FieldPtr get(const Generator& generator, const FieldDesc& desc, WorkerPool* pool = 0);
+		FieldPtr find(const Generator& generator, const FieldDesc& desc);
+		FieldPtr insert(const Generator& generator, const FieldDesc& desc, const FieldPtr& field);
+		void clear();
+
+		int getHits() const { return hits_; };
+		int getMisses() const { return misses_; };
+
+	private:
+		struct Entry
+		{
+			unsigned int seed;
+			FieldDesc desc;
+			FieldPtr field;
+			unsigned int lastUse;
+		};
+
+		static bool matches(const Entry& entry, unsigned int seed, const FieldDesc& desc);
+
+		std::mutex mutex_;
+		std::vector<Entry> entries_;
+		int maxEntries_;
+		unsigned int useCount_;
+		int hits_;
+		int misses_;
+	};
+};
+
+#endif // NOISEFIELDCACHE_H
@@ -0,0 +1,203 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Perturbance Field
+	Brief		Definition of the perturbance field functions
+*/
+
+#include <cmath>
+#include <vector>
+
+#include "Utilities/PerturbanceField.hpp"
+#include "Utilities/SimplexNoiseGenerator.hpp"
+#include "Utilities/WorkerPool.hpp"
+
+namespace
+{
+	/*
+		Name		RowSamples
+		Brief		The three noise components for one row of texels, with the batch
+					noise inputs they are generated from
+	*/
+	struct RowSamples
+	{
+		explicit RowSamples(int width)
+		: across(width), along(width), constant(width), x(width), y(width), z(width)
+		{}
+
+		std::vector<float> across;
+		std::vector<float> along;
+		std::vector<float> constant;
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+	};
+
+	// Evaluates the noise vector of every texel in a row
+	void sampleRow(const SimplexNoise::Generator& generator, const SimplexNoise::PerturbanceDesc& desc,
+		int row, RowSamples& samples)
+	{
+		int width = desc.width;
+		float frequencyX = desc.frequency;
+		float frequencyY = desc.frequency;
+		int periodX = 0;
+		int periodY = 0;
+
+		if (desc.tileable)
+		{
+			// Stretch the frequency slightly so a whole number of periods fits the texture
+			periodX = SimplexNoise::getValidPeriod((int)(desc.width * desc.frequency + 0.5f));
+			periodY = SimplexNoise::getValidPeriod((int)(desc.height * desc.frequency + 0.5f));
+			frequencyX = (float)periodX / (float)desc.width;
+			frequencyY = (float)periodY / (float)desc.height;
+		}
+
+		float rowPosition = frequencyY * row;
+		for (int c = 0; c < width; ++c)
+		{
+			samples.across[c] = frequencyX * c;
+			samples.along[c] = rowPosition;
+			samples.constant[c] = desc.frequency;
+		}
+
+		// The components sample the same volume with the axes swizzled
+		const float* across = &samples.across[0];
+		const float* along = &samples.along[0];
+		const float* constant = &samples.constant[0];
+		if (desc.tileable)
+		{
+			// The constant axis never wraps, so any valid period does for it
+			int periodZ = SimplexNoise::getValidPeriod(0);
+			generator.periodicNoise3(across, along, constant, &samples.x[0], width, periodX, periodY, periodZ);
+			generator.periodicNoise3(along, constant, across, &samples.y[0], width, periodY, periodZ, periodX);
+			generator.periodicNoise3(constant, across, along, &samples.z[0], width, periodZ, periodX, periodY);
+		}
+		else
+		{
+			generator.noise3(across, along, constant, &samples.x[0], width);
+			generator.noise3(along, constant, across, &samples.y[0], width);
+			generator.noise3(constant, across, along, &samples.z[0], width);
+		}
+	}
+
+	template <typename T>
+	T packSnorm(float value, float maximum)
+	{
+		if (value > 1.0f)
+			value = 1.0f;
+		else if (value < -1.0f)
+			value = -1.0f;
+
+		return (T)std::floor(value * maximum + 0.5f);
+	}
+}
+
+/*
+	Name		SimplexNoise::getPerturbanceTexelSize
+	Syntax		SimplexNoise::getPerturbanceTexelSize(PerturbanceFormat format)
+	Return		int - Bytes per texel in the given format
+*/
+int SimplexNoise::getPerturbanceTexelSize(PerturbanceFormat format)
+{
+	switch (format)
+	{
+	case PERTURBANCE_SNORM16:
+		return 4 * sizeof(short);
+	case PERTURBANCE_SNORM8:
+		return 4 * sizeof(signed char);
+	default:
+		return 3 * sizeof(float);
+	}
+}
+
+/*
+	Name		SimplexNoise::generatePerturbanceRow
+	Syntax		SimplexNoise::generatePerturbanceRow(const Generator& generator, const PerturbanceDesc& desc,
+													 int row, void* out)
+	Param		const Generator& generator - The noise source
+	Param		const PerturbanceDesc& desc - The texture being generated
+	Param		int row - The row to fill
+	Param		void* out - The whole texture
+	Brief		Fills one row of a perturbance texture. A texel depends only on its own
+				position, so rows can be generated in any order. Tileable textures
+				use periodic noise whose period is the texture size.
+*/
+void SimplexNoise::generatePerturbanceRow(const Generator& generator, const PerturbanceDesc& desc, int row, void* out)
+{
+	int width = desc.width;
+	RowSamples samples(width);
+	sampleRow(generator, desc, row, samples);
+
+	const float* x = &samples.x[0];
+	const float* y = &samples.y[0];
+	const float* z = &samples.z[0];
+
+	int texelSize = getPerturbanceTexelSize(desc.format);
+	unsigned char* texel = (unsigned char*)out + (size_t)row * width * texelSize;
+
+	for (int c = 0; c < width; ++c, texel += texelSize)
+	{
+		float length = std::sqrt(x[c] * x[c] + y[c] * y[c] + z[c] * z[c]);
+		float scale = (length > 0.0f) ? 1.0f / length : 0.0f;
+		float v[3] = {x[c] * scale, y[c] * scale, z[c] * scale};
+
+		switch (desc.format)
+		{
+		case PERTURBANCE_SNORM16:
+		{
+			short* packed = (short*)texel;
+			for (int i = 0; i < 3; ++i)
+				packed[i] = packSnorm<short>(v[i], 32767.0f);
+			packed[3] = 32767;
+			break;
+		}
+		case PERTURBANCE_SNORM8:
+		{
+			signed char* packed = (signed char*)texel;
+			for (int i = 0; i < 3; ++i)
+				packed[i] = packSnorm<signed char>(v[i], 127.0f);
+			packed[3] = 127;
+			break;
+		}
+		default:
+		{
+			float* unpacked = (float*)texel;
+			for (int i = 0; i < 3; ++i)
+				unpacked[i] = v[i];
+			break;
+		}
+		}
+	}
+}
+
+/*
+	Name		SimplexNoise::generatePerturbance
+	Syntax		SimplexNoise::generatePerturbance(const Generator& generator, const PerturbanceDesc& desc,
+												  void* out, WorkerPool* pool)
+	Param		const Generator& generator - The noise source
+	Param		const PerturbanceDesc& desc - The texture to generate
+	Param		void* out - Receives desc.width * desc.height texels, row-major
+	Param		WorkerPool* pool - Pool to spread the rows over, or 0 to run serially
+	Brief		Fills a perturbance texture a row at a time
+*/
+void SimplexNoise::generatePerturbance(const Generator& generator, const PerturbanceDesc& desc, void* out, WorkerPool* pool)
+{
+	if (desc.width <= 0 || desc.height <= 0)
+		return;
+
+	if (!pool)
+	{
+		for (int row = 0; row < desc.height; ++row)
+		{
+			generatePerturbanceRow(generator, desc, row, out);
+		}
+		return;
+	}
+
+	pool->parallelFor(desc.height, [&](int row)
+	{
+		generatePerturbanceRow(generator, desc, row, out);
+	});
+}
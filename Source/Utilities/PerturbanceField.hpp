@@ -0,0 +1,53 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Perturbance Field
+	Brief		Declaration of the perturbance field functions, which fill the texels of
+				the heat haze perturbance texture with normalised noise vectors
+*/
+
+#ifndef PERTURBANCEFIELD_H
+#define PERTURBANCEFIELD_H
+
+class WorkerPool;
+
+namespace SimplexNoise
+{
+	class Generator;
+
+	enum PerturbanceFormat
+	{
+		PERTURBANCE_FLOAT3,		// 3 x float, 12 bytes a texel
+		PERTURBANCE_SNORM16,	// 4 x signed normalised short, 8 bytes a texel
+		PERTURBANCE_SNORM8,		// 4 x signed normalised byte, 4 bytes a texel
+	};
+
+	/*
+		Name		PerturbanceDesc
+		Brief		Describes a perturbance texture. Texels are written row-major with a
+					pitch of width * getPerturbanceTexelSize(format). The packed formats
+					store 1 in the fourth channel, which is what the shader reads from
+					a 3 channel texture.
+	*/
+	struct PerturbanceDesc
+	{
+		PerturbanceDesc()
+		: format(PERTURBANCE_FLOAT3), width(0), height(0), frequency(0.05f), tileable(false)
+		{}
+
+		PerturbanceFormat format;
+		int width;
+		int height;
+		float frequency;	// Noise units per texel, rounded to fit whole periods when tileable
+		bool tileable;		// Use periodic noise so the texture repeats without seams
+	};
+
+	int getPerturbanceTexelSize(PerturbanceFormat format);
+
+	void generatePerturbance(const Generator& generator, const PerturbanceDesc& desc, void* out, WorkerPool* pool = 0);
+	void generatePerturbanceRow(const Generator& generator, const PerturbanceDesc& desc, int row, void* out);
+};
+
+#endif // PERTURBANCEFIELD_H
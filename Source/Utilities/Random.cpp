@@ -0,0 +1,163 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Random
+	Brief		Definition of Random Class
+*/
+
+#include "Utilities/Random.hpp"
+
+namespace
+{
+	// Philox4x32 multipliers and Weyl key increments
+	const unsigned int PHILOX_M0 = 0xD2511F53u;
+	const unsigned int PHILOX_M1 = 0xCD9E8D57u;
+	const unsigned int PHILOX_W0 = 0x9E3779B9u;
+	const unsigned int PHILOX_W1 = 0xBB67AE85u;
+	const int PHILOX_ROUNDS = 10;
+
+	inline void mulHiLo(unsigned int a, unsigned int b, unsigned int& hi, unsigned int& lo)
+	{
+		unsigned long long product = (unsigned long long)a * b;
+		hi = (unsigned int)(product >> 32);
+		lo = (unsigned int)product;
+	}
+}
+
+/*
+	Name		Random::Random
+	Syntax		Random(unsigned int seed, unsigned int stream)
+	Param		unsigned int seed - The seed
+	Param		unsigned int stream - Which of the seed's independent streams to draw from
+*/
+Random::Random(unsigned int seed, unsigned int stream)
+{
+	setSeed(seed, stream);
+}
+
+/*
+	Name		Random::setSeed
+	Syntax		Random::setSeed(unsigned int seed, unsigned int stream)
+	Param		unsigned int seed - The seed
+	Param		unsigned int stream - Which of the seed's independent streams to draw from
+	Brief		Restarts the generator at the beginning of the given stream
+*/
+void Random::setSeed(unsigned int seed, unsigned int stream)
+{
+	key_[0] = seed;
+	key_[1] = stream;
+	counter_ = 0;
+	index_ = 4;
+}
+
+/*
+	Name		Random::nextFloat
+	Syntax		Random::nextFloat()
+	Return		float - A uniformly distributed value in [0, 1)
+	Brief		Uses the top 24 bits so every value is exactly representable
+*/
+float Random::nextFloat()
+{
+	return (float)(nextUInt() >> 8) * (1.0f / 16777216.0f);
+}
+
+/*
+	Name		Random::nextFloat
+	Syntax		Random::nextFloat(float a, float b)
+	Return		float - A uniformly distributed value in [a, b)
+*/
+float Random::nextFloat(float a, float b)
+{
+	return a + nextFloat() * (b - a);
+}
+
+/*
+	Name		Random::nextInt
+	Syntax		Random::nextInt(int n)
+	Param		int n - The number of possible values, greater than 0
+	Return		int - A uniformly distributed value in [0, n)
+	Brief		Scales a 32 bit value by n with a multiply, rejecting the few values
+				that would make the result biased
+*/
+int Random::nextInt(int n)
+{
+	if (n <= 1)
+		return 0;
+
+	unsigned int range = (unsigned int)n;
+	unsigned int threshold = (0u - range) % range;
+	for (;;)
+	{
+		unsigned long long product = (unsigned long long)nextUInt() * range;
+		if ((unsigned int)product >= threshold)
+			return (int)(product >> 32);
+	}
+}
+
+/*
+	Name		Random::skip
+	Syntax		Random::skip(unsigned long long count)
+	Param		unsigned long long count - The number of 32 bit values to jump over
+	Brief		Jumps ahead in the stream in constant time
+*/
+void Random::skip(unsigned long long count)
+{
+	unsigned long long position = counter_ * 4 - (4 - index_) + count;
+
+	counter_ = position / 4;
+	index_ = 4;
+	if (position % 4 != 0)
+	{
+		refill();
+		index_ = (int)(position % 4);
+	}
+}
+
+/*
+	Name		Random::generateBlock
+	Syntax		Random::generateBlock(unsigned int seed, unsigned int stream, unsigned long long counter,
+									  unsigned int out[4])
+	Param		unsigned long long counter - The block to generate
+	Param		unsigned int out[4] - Receives values 4 * counter to 4 * counter + 3 of the stream
+	Brief		Philox4x32-10. Needs no state, so parallel loops can draw the values
+				for item i directly from block i.
+*/
+void Random::generateBlock(unsigned int seed, unsigned int stream, unsigned long long counter, unsigned int out[4])
+{
+	unsigned int c[4] = {(unsigned int)counter, (unsigned int)(counter >> 32), 0, 0};
+	unsigned int k[2] = {seed, stream};
+
+	for (int round = 0; round < PHILOX_ROUNDS; ++round)
+	{
+		unsigned int hi0, lo0, hi1, lo1;
+		mulHiLo(PHILOX_M0, c[0], hi0, lo0);
+		mulHiLo(PHILOX_M1, c[2], hi1, lo1);
+
+		c[0] = hi1 ^ c[1] ^ k[0];
+		c[1] = lo1;
+		c[2] = hi0 ^ c[3] ^ k[1];
+		c[3] = lo0;
+
+		k[0] += PHILOX_W0;
+		k[1] += PHILOX_W1;
+	}
+
+	for (int i = 0; i < 4; ++i)
+	{
+		out[i] = c[i];
+	}
+}
+
+/*
+	Name		Random::refill
+	Syntax		Random::refill()
+	Brief		Generates the next block of four values
+*/
+void Random::refill()
+{
+	generateBlock(key_[0], key_[1], counter_, block_);
+	++counter_;
+	index_ = 0;
+}
@@ -0,0 +1,52 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Random
+	Brief		Declaration of Random Class, a counter-based Philox4x32-10 generator.
+				Every value is a pure function of (seed, stream, position), so each
+				thread or generation stage can draw from its own stream and results
+				do not depend on the order anything else used random numbers in.
+*/
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+class Random
+{
+public:
+	static const unsigned int DEFAULT_SEED = 1;
+
+	explicit Random(unsigned int seed = DEFAULT_SEED, unsigned int stream = 0);
+
+	void setSeed(unsigned int seed, unsigned int stream = 0);
+	unsigned int getSeed() const { return key_[0]; };
+	unsigned int getStream() const { return key_[1]; };
+
+	// Returns a uniformly distributed 32 bit value
+	unsigned int nextUInt()
+	{
+		if (index_ == 4)
+			refill();
+		return block_[index_++];
+	};
+
+	float nextFloat();
+	float nextFloat(float a, float b);
+	int nextInt(int n);
+
+	void skip(unsigned long long count);
+
+	static void generateBlock(unsigned int seed, unsigned int stream, unsigned long long counter, unsigned int out[4]);
+
+private:
+	void refill();
+
+	unsigned int key_[2];
+	unsigned long long counter_;
+	unsigned int block_[4];
+	int index_;
+};
+
+#endif // RANDOM_H
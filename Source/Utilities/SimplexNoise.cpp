@@ -7,9 +7,12 @@
 	Brief		Definitions of Simplex Noise Functions
 */
 
+#include <atomic>
 #include <cmath>
+#include <vector>
 
 #include "Utilities\SimplexNoise.hpp"
+#include "Utilities\WorkerPool.hpp"
 #include "Scene\Scene.hpp"
 
 /*
@@ -189,49 +192,41 @@ ID3D10ShaderResourceView* SimplexNoise::createSimplexTexture()
 
 /*
 	Name		SimplexNoise::createPerturbanceTexture
-	Syntax		SimplexNoise::createPerturbanceTexture()
+	Syntax		SimplexNoise::createPerturbanceTexture(const PerturbanceDesc& desc)
+	Param		const PerturbanceDesc& desc - Size, format and tiling of the texture
 	Return		ID3D10ShaderResourceView* - A pointer to a Perturbance resource
-	Brief		Creates a 2D perturbance texture
+	Brief		Creates a 2D perturbance texture, generating its rows across the
+				worker pool
 */
-ID3D10ShaderResourceView* SimplexNoise::createPerturbanceTexture()
+ID3D10ShaderResourceView* SimplexNoise::createPerturbanceTexture(const PerturbanceDesc& desc)
 {
-	int width = Scene::instance()->getWidth();
-	int height = Scene::instance()->getHeight();
-
-	D3DXVECTOR3* texels =  new D3DXVECTOR3[width * height];
-	D3DXVECTOR3 normal = D3DXCOLOR(0.0f,0.0f,0.0f,1.0f);
-	float noiseCoefx, noiseCoefy, noiseCoefz;
-	int i, j;
-	float factor = 0.05f;
-
-	for(i = 0; i < width; i++)
-	{
-		for(j = 0; j < height; j++) 
-		{
-			
-			noiseCoefx = SimplexNoise::noise(factor * i, factor * j, factor);
-			noiseCoefy = SimplexNoise::noise(factor * j, factor, factor * i);
-			noiseCoefz = SimplexNoise::noise(factor, factor * i, factor * j);
-			normal.x = normal.x + noiseCoefx; 
-			normal.y = normal.y + noiseCoefy; 
-			normal.z = normal.z + noiseCoefz; 
-   
-			D3DXVec3Normalize(&normal, &normal);
-			texels[i * height + j] = normal;   
-		}
-	}
+	int texelSize = getPerturbanceTexelSize(desc.format);
+	std::vector<unsigned char> texels(desc.width * desc.height * texelSize);
+	generatePerturbance(getDefaultGenerator(), desc, &texels[0], WorkerPool::instance());
 
 	D3D10_SUBRESOURCE_DATA initData;
-	initData.pSysMem = texels;
-	initData.SysMemPitch = width * sizeof(D3DXVECTOR3);
-	initData.SysMemSlicePitch = height * sizeof(D3DXVECTOR3);
+	initData.pSysMem = &texels[0];
+	initData.SysMemPitch = desc.width * texelSize;
+	initData.SysMemSlicePitch = desc.width * desc.height * texelSize;
 
 	// Create the texture
 	D3D10_TEXTURE2D_DESC texDesc;
-	texDesc.Width = width;
-	texDesc.Height = height;
+	texDesc.Width = desc.width;
+	texDesc.Height = desc.height;
 	texDesc.MipLevels = 1;
-	texDesc.Format = DXGI_FORMAT_R32G32B32_FLOAT; 
+
+	switch (desc.format)
+	{
+	case PERTURBANCE_SNORM16:
+		texDesc.Format = DXGI_FORMAT_R16G16B16A16_SNORM;
+		break;
+	case PERTURBANCE_SNORM8:
+		texDesc.Format = DXGI_FORMAT_R8G8B8A8_SNORM;
+		break;
+	default:
+		texDesc.Format = DXGI_FORMAT_R32G32B32_FLOAT;
+		break;
+	}
 	 
 	texDesc.Usage = D3D10_USAGE_IMMUTABLE;
 	texDesc.BindFlags = D3D10_BIND_SHADER_RESOURCE;
@@ -270,8 +265,6 @@ ID3D10ShaderResourceView* SimplexNoise::createPerturbanceTexture()
 
 	tex->Release();
 	tex = 0;
-	
-	delete texels;
 
 	return texRV;
 }
@@ -288,12 +281,17 @@ ID3D10ShaderResourceView* SimplexNoise::createRandomTexture()
 	// Create random data
 	D3DXVECTOR4 randomValues[1024];
 
+	// Each texture built draws from the next stream, so every particle system
+	// gets its own values but the same ones every run
+	static std::atomic<unsigned int> stream(0);
+	Random random(RANDOM_TEXTURE_SEED, stream++);
+
 	for (int i = 0; i < 1024; ++i)
 	{
-		randomValues[i].x = randFloat(-1.0f, 1.0f);
-		randomValues[i].y = randFloat(-1.0f, 1.0f);
-		randomValues[i].z = randFloat(-1.0f, 1.0f);
-		randomValues[i].w = randFloat(-1.0f, 1.0f);
+		randomValues[i].x = randFloat(random, -1.0f, 1.0f);
+		randomValues[i].y = randFloat(random, -1.0f, 1.0f);
+		randomValues[i].z = randFloat(random, -1.0f, 1.0f);
+		randomValues[i].w = randFloat(random, -1.0f, 1.0f);
 	}
 
 	D3D10_SUBRESOURCE_DATA initData;
@@ -357,34 +355,34 @@ int SimplexNoise::fastfloor(double x)
 
 /*
 	Name		SimplexNoise::dot
-	Syntax		SimplexNoise::dot(int g[], double x, double y)
-	Param		int g[] - Array of valuea used as A in dot product equation (A.B)
+	Syntax		SimplexNoise::dot(const int g[], double x, double y)
+	Param		const int g[] - Array of valuea used as A in dot product equation (A.B)
 	Param		double x - x value for B in dot product equation
 	Param		double y - See x
 	Return		double - dot product
 	Brief		Finds the dot product of g and (x, y)
 */
-double SimplexNoise::dot(int g[], double x, double y) 
+double SimplexNoise::dot(const int g[], double x, double y) 
 {
     return g[0]*x + g[1]*y; 
 }
 
 /*
 	Name		SimplexNoise::dot
-	Syntax		SimplexNoise::dot(int g[], double x, double y, double z)
+	Syntax		SimplexNoise::dot(const int g[], double x, double y, double z)
 	Brief		Finds the dot product of g and (x, y, z)
 */
-double SimplexNoise::dot(int g[], double x, double y, double z) 
+double SimplexNoise::dot(const int g[], double x, double y, double z) 
 {
     return g[0]*x + g[1]*y + g[2]*z; 
 }
 
 /*
 	Name		SimplexNoise::dot
-	Syntax		SimplexNoise::dot(int g[], double x, double y, double z, double w)
+	Syntax		SimplexNoise::dot(const int g[], double x, double y, double z, double w)
 	Brief		Finds the dot product of g and (x, y, z, w)
 */
-double SimplexNoise::dot(int g[], double x, double y, double z, double w) 
+double SimplexNoise::dot(const int g[], double x, double y, double z, double w) 
 {
     return g[0]*x + g[1]*y + g[2]*z + g[3]*w; 
 }  
@@ -400,96 +398,9 @@ double SimplexNoise::dot(int g[], double x, double y, double z, double w)
 */
 double SimplexNoise::noise(double xin, double yin) 
 {
-	// To remove the need for index wrapping, double the permutation table length
-	int perm[512];
-	for (int i = 0; i < 512; i++) 
-	{
-		perm[i] = p[i & 255];
-	}
-
-    double n0, n1, n2; // Noise contributions from the three corners
-
-    // Skew the input space to determine which simplex cell we're in
-    double F2 = 0.5 * (sqrt(3.0) - 1.0);
-
-    double s = (xin+yin) * F2; // Hairy factor for 2D
-    int i = fastfloor(xin + s);
-    int j = fastfloor(yin + s);
-    double G2 = (3.0 - sqrt(3.0)) / 6.0;
-    double t = (i + j) * G2;
-
-    double X0 = i - t; // Unskew the cell origin back to (x,y) space
-    double Y0 = j - t;
-
-    double x0 = xin - X0; // The x,y distances from the cell origin
-    double y0 = yin - Y0;
-
-    // For the 2D case, the simplex shape is an equilateral triangle.
-    // Determine which simplex we are in.
-    int i1, j1; // Offsets for second (middle) corner of simplex in (i,j) coords
-    if (x0 > y0) 
-	{
-		i1 = 1; 
-		j1 = 0;
-	} // lower triangle, XY order: (0,0)->(1,0)->(1,1)
-
-    else 
-	{
-		i1 = 0; 
-		j1 = 1;
-	}      // upper triangle, YX order: (0,0)->(0,1)->(1,1)   
-	// A step of (1,0) in (i,j) means a step of (1-c,-c) in (x,y), and
-    // a step of (0,1) in (i,j) means a step of (-c,1-c) in (x,y), where
-    // c = (3-sqrt(3))/6
-	
-	// Offsets for middle corner in (x,y) unskewed coords
-    double x1 = x0 - i1 + G2; 
-    double y1 = y0 - j1 + G2;
-
-	// Offsets for last corner in (x,y) unskewed coords
-    double x2 = x0 - 1.0 + 2.0 * G2; 
-    double y2 = y0 - 1.0 + 2.0 * G2;
-
-    // Work out the hashed gradient indices of the three simplex corners
-    int ii = i & 255;
-    int jj = j & 255;
-    int gi0 = perm[ii + perm[jj]] % 12;
-    int gi1 = perm[ii + i1 + perm[jj + j1]] % 12;
-    int gi2 = perm[ii + 1 + perm[jj + 1]] % 12;
-
-    // Calculate the contribution from the three corners
-    double t0 = 0.5 - x0*x0 - y0*y0;
-    if (t0 < 0) 
-		n0 = 0.0;
-    else 
-	{
-      t0 *= t0;
-      n0 = t0 * t0 * dot(grad3[gi0], x0, y0);  // (x,y) of grad3 used for 2D gradient
-    }
-
-    double t1 = 0.5 - x1*x1 - y1*y1;
-    if (t1 < 0) 
-		n1 = 0.0;
-    else 
-	{
-      t1 *= t1;
-      n1 = t1 * t1 * dot(grad3[gi1], x1, y1);
-    }
-
-	double t2 = 0.5 - x2*x2 - y2*y2;
-    if (t2 < 0) 
-		n2 = 0.0;
-    else 
-	{
-      t2 *= t2;
-      n2 = t2 * t2 * dot(grad3[gi2], x2, y2);
-    }
-    // Add contributions from each corner to get the final noise value.
-    // The result is scaled to return values in the interval [-1,1].
-    return 70.0 * (n0 + n1 + n2);
+	return getDefaultGenerator().noise(xin, yin);
 }
 
-
 /*
 	Name		SimplexNoise::noise
 	Syntax		SimplexNoise::noise(double xin, double yin, double zin)
@@ -497,164 +408,7 @@ double SimplexNoise::noise(double xin, double yin)
 */
 double SimplexNoise::noise(double xin, double yin, double zin) 
 {
-    // To remove the need for index wrapping, double the permutation table length
-	int perm[512];
-	for (int i = 0; i < 512; i++) 
-	{
-		perm[i] = p[i & 255];
-	}
-	
-	double n0, n1, n2, n3; // Noise contributions from the four corners
-
-    // Skew the input space to determine which simplex cell we're in
-    double F3 = 1.0 / 3.0;
-
-    double s = (xin+yin+zin) * F3; // Very nice and simple skew factor for 3D
-    int i = fastfloor(xin+s);
-    int j = fastfloor(yin+s);
-    int k = fastfloor(zin+s);
-
-    double G3 = 1.0 / 6.0; // Very nice and simple unskew factor, too
-    double t = (i+j+k) * G3; 
-
-    double X0 = i - t; // Unskew the cell origin back to (x,y,z) space
-    double Y0 = j - t;
-    double Z0 = k - t;
-
-    double x0 = xin - X0; // The x,y,z distances from the cell origin
-    double y0 = yin - Y0;
-    double z0 = zin - Z0;
-
-    // For the 3D case, the simplex shape is a slightly irregular tetrahedron.
-    // Determine which simplex we are in.
-    int i1, j1, k1; // Offsets for second corner of simplex in (i,j,k) coords
-    int i2, j2, k2; // Offsets for third corner of simplex in (i,j,k) coords
-    if (x0 >= y0) 
-	{
-		if (y0 >= z0)
-		{ 
-			i1 = 1; 
-			j1 = 0; 
-			k1 = 0; 
-			i2 = 1; 
-			j2 = 1; 
-			k2 = 0; 
-		} // X Y Z order
-        else if (x0 >= z0) 
-		{ 
-			i1 = 1; 
-			j1 = 0; 
-			k1 = 0; 
-			i2 = 1; 
-			j2 = 0; 
-			k2 = 1; 
-		} // X Z Y order
-		else 
-		{ 
-			i1 = 0; 
-			j1 = 0; 
-			k1 = 1; 
-			i2 = 1; 
-			j2 = 0; 
-			k2 = 1; 
-		} // Z X Y order
-	}
-	else 
-	{ // x0<y0
-		if (y0 < z0) 
-		{ 
-			i1 = 0; 
-			j1 = 0; 
-			k1 = 1;  
-			i2 = 0; 
-			j2 = 1; 
-			k2 = 1; 
-		} // Z Y X order
-		else if (x0 < z0) 
-		{ 
-			i1 = 0; 
-			j1 = 1; 
-			k1 = 0; 
-			i2 = 0; 
-			j2 = 1; 
-			k2 = 1; 
-		} // Y Z X order
-		else 
-		{ 
-			i1 = 0; 
-			j1 = 1; 
-			k1 = 0; 
-			i2 = 1; 
-			j2 = 1; 
-			k2 = 0; 
-		} // Y X Z order
-	}
-    // A step of (1,0,0) in (i,j,k) means a step of (1-c,-c,-c) in (x,y,z),
-    // a step of (0,1,0) in (i,j,k) means a step of (-c,1-c,-c) in (x,y,z), and
-    // a step of (0,0,1) in (i,j,k) means a step of (-c,-c,1-c) in (x,y,z), where
-    // c = 1/6.    
-	
-	// Offsets for second corner in (x,y,z) coords
-	double x1 = x0 - i1 + G3;	
-    double y1 = y0 - j1 + G3;
-    double z1 = z0 - k1 + G3;
-
-	// Offsets for third corner in (x,y,z) coords
-    double x2 = x0 - i2 + 2.0*G3;
-    double y2 = y0 - j2 + 2.0*G3;
-    double z2 = z0 - k2 + 2.0*G3;
-
-	// Offsets for last corner in (x,y,z) coords
-    double x3 = x0 - 1.0 + 3.0*G3; 
-    double y3 = y0 - 1.0 + 3.0*G3;
-    double z3 = z0 - 1.0 + 3.0*G3;
-
-    // Work out the hashed gradient indices of the four simplex corners
-    int ii = i & 255;
-    int jj = j & 255;
-    int kk = k & 255;
-    int gi0 = perm[ii + perm[jj + perm[kk]]] % 12;
-    int gi1 = perm[ii + i1 + perm[jj + j1 + perm[kk+k1]]] % 12;
-    int gi2 = perm[ii + i2 + perm[jj + j2 + perm[kk+k2]]] % 12;
-    int gi3 = perm[ii + 1 + perm[jj + 1 + perm[kk+1]]] % 12;
-
-    // Calculate the contribution from the four corners
-    double t0 = 0.6 - x0*x0 - y0*y0 - z0*z0;
-    if (t0 < 0) 
-		n0 = 0.0;
-    else 
-	{
-      t0 *= t0;
-      n0 = t0 * t0 * dot(grad3[gi0], x0, y0, z0);
-    }
-    double t1 = 0.6 - x1*x1 - y1*y1 - z1*z1;
-    if (t1 < 0) 
-		n1 = 0.0;
-    else 
-	{
-		t1 *= t1;
-		n1 = t1 * t1 * dot(grad3[gi1], x1, y1, z1);
-    }
-    double t2 = 0.6 - x2*x2 - y2*y2 - z2*z2;
-    if (t2 < 0) 
-		n2 = 0.0;
-    else 
-	{
-		t2 *= t2;
-		n2 = t2 * t2 * dot(grad3[gi2], x2, y2, z2);
-    }
-    double t3 = 0.6 - x3*x3 - y3*y3 - z3*z3;
-    if (t3 < 0) 
-		n3 = 0.0;
-    else 
-	{
-		t3 *= t3;
-		n3 = t3 * t3 * dot(grad3[gi3], x3, y3, z3);
-    }
-
-    // Add contributions from each corner to get the final noise value.
-    // The result is scaled to stay just inside [-1,1]
-    return 32.0 * (n0 + n1 + n2 + n3);
+	return getDefaultGenerator().noise(xin, yin, zin);
 }  
 
 /*
@@ -664,158 +418,7 @@ double SimplexNoise::noise(double xin, double yin, double zin)
 */
 double SimplexNoise::noise(double xin, double yin, double zin, double win)
 {
-	// To remove the need for index wrapping, double the permutation table length
-	int perm[512];
-	 for (int i = 0; i < 512; i++) 
-	{
-		perm[i] = p[i & 255];
-	}
-
-    // The skewing and unskewing factors are hairy again for the 4D case
-    double F4 = (sqrt(5.0) - 1.0) / 4.0;
-    double G4 = (5.0 - sqrt(5.0)) / 20.0;
-
-    double n0, n1, n2, n3, n4; // Noise contributions from the five corners
-
-    // Skew the (x,y,z,w) space to determine which cell of 24 simplices we're in
-    double s = (xin + yin + zin + win) * F4; // Factor for 4D skewing
-    int i = fastfloor(xin + s);
-    int j = fastfloor(yin + s);
-    int k = fastfloor(zin + s);
-    int l = fastfloor(win + s);
-    double t = (i + j + k + l) * G4; // Factor for 4D unskewing
-
-    double X0 = i - t; // Unskew the cell origin back to (x,y,z,w) space
-    double Y0 = j - t;
-    double Z0 = k - t;
-    double W0 = l - t;
-
-    double x0 = xin - X0;  // The x,y,z,w distances from the cell origin
-    double y0 = yin - Y0;
-    double z0 = zin - Z0;
-    double w0 = win - W0;
-
-    // For the 4D case, the simplex is a 4D shape I won't even try to describe.
-    // To find out which of the 24 possible simplices we're in, we need to
-    // determine the magnitude ordering of x0, y0, z0 and w0.
-    // The method below is a good way of finding the ordering of x,y,z,w and
-    // then find the correct traversal order for the simplex were in.
-    // First, six pair-wise comparisons are performed between each possible pair
-    // of the four coordinates, and the results are used to add up binary bits
-    // for an integer index.
-    int c1 = (x0 > y0) ? 32 : 0;
-    int c2 = (x0 > z0) ? 16 : 0;
-    int c3 = (y0 > z0) ? 8 : 0;
-    int c4 = (x0 > w0) ? 4 : 0;
-    int c5 = (y0 > w0) ? 2 : 0;
-    int c6 = (z0 > w0) ? 1 : 0;
-    int c = c1 + c2 + c3 + c4 + c5 + c6;
-    int i1, j1, k1, l1; // The integer offsets for the second simplex corner
-    int i2, j2, k2, l2; // The integer offsets for the third simplex corner
-    int i3, j3, k3, l3; // The integer offsets for the fourth simplex corner
-    // simplex[c] is a 4-vector with the numbers 0, 1, 2 and 3 in some order.
-    // Many values of c will never occur, since e.g. x>y>z>w makes x<z, y<w and x<w
-    // impossible. Only the 24 indices which have non-zero entries make any sense.
-    // We use a thresholding to set the coordinates in turn from the largest magnitude.
-    // The number 3 in the "simplex" array is at the position of the largest coordinate.
-    i1 = simplex[c][0]>=3 ? 1 : 0;
-    j1 = simplex[c][1]>=3 ? 1 : 0;
-    k1 = simplex[c][2]>=3 ? 1 : 0;
-    l1 = simplex[c][3]>=3 ? 1 : 0;
-    // The number 2 in the "simplex" array is at the second largest coordinate.
-    i2 = simplex[c][0]>=2 ? 1 : 0;
-    j2 = simplex[c][1]>=2 ? 1 : 0;    k2 = simplex[c][2]>=2 ? 1 : 0;
-    l2 = simplex[c][3]>=2 ? 1 : 0;
-    // The number 1 in the "simplex" array is at the second smallest coordinate.
-    i3 = simplex[c][0]>=1 ? 1 : 0;
-    j3 = simplex[c][1]>=1 ? 1 : 0;
-    k3 = simplex[c][2]>=1 ? 1 : 0;
-    l3 = simplex[c][3]>=1 ? 1 : 0;
-
-    // The fifth corner has all coordinate offsets = 1, so no need to look that up.
-    // Offsets for second corner in (x,y,z,w) coords
-	double x1 = x0 - i1 + G4; 
-    double y1 = y0 - j1 + G4;
-    double z1 = z0 - k1 + G4;
-    double w1 = w0 - l1 + G4;
-
-    // Offsets for third corner in (x,y,z,w) coords
-	double x2 = x0 - i2 + 2.0*G4; 
-    double y2 = y0 - j2 + 2.0*G4;
-    double z2 = z0 - k2 + 2.0*G4;
-    double w2 = w0 - l2 + 2.0*G4;
-
-    // Offsets for fourth corner in (x,y,z,w) coords
-	double x3 = x0 - i3 + 3.0*G4; 
-    double y3 = y0 - j3 + 3.0*G4;
-    double z3 = z0 - k3 + 3.0*G4;
-    double w3 = w0 - l3 + 3.0*G4;
-
-	// Offsets for last corner in (x,y,z,w) coords
-    double x4 = x0 - 1.0 + 4.0*G4; 
-    double y4 = y0 - 1.0 + 4.0*G4;
-    double z4 = z0 - 1.0 + 4.0*G4;
-    double w4 = w0 - 1.0 + 4.0*G4;
-
-    // Work out the hashed gradient indices of the five simplex corners
-    int ii = i & 255;
-    int jj = j & 255;
-    int kk = k & 255;
-    int ll = l & 255;
-    int gi0 = perm[ii + perm[jj + perm[kk+perm[ll]]]] % 32;
-    int gi1 = perm[ii + i1 + perm[jj + j1 + perm[kk+k1+perm[ll+l1]]]] % 32;
-    int gi2 = perm[ii + i2 + perm[jj + j2 + perm[kk+k2+perm[ll+l2]]]] % 32;
-    int gi3 = perm[ii + i3 + perm[jj + j3 + perm[kk+k3+perm[ll+l3]]]] % 32;
-    int gi4 = perm[ii + 1 + perm[jj + 1 + perm[kk+1+perm[ll+1]]]] % 32;
-
-    // Calculate the contribution from the five corners
-    double t0 = 0.6 - x0*x0 - y0*y0 - z0*z0 - w0*w0;
-    if (t0 < 0) 
-		n0 = 0.0;
-    else 
-	{
-		t0 *= t0;
-		n0 = t0 * t0 * dot(grad4[gi0], x0, y0, z0, w0);
-    }
-
-	double t1 = 0.6 - x1*x1 - y1*y1 - z1*z1 - w1*w1;
-	if (t1 < 0) 
-		n1 = 0.0;
-    else 
-	{
-		t1 *= t1;
-		n1 = t1 * t1 * dot(grad4[gi1], x1, y1, z1, w1);
-    }
-
-	double t2 = 0.6 - x2*x2 - y2*y2 - z2*z2 - w2*w2;
-    if (t2 < 0) 
-		n2 = 0.0;
-    else 
-	{
-		t2 *= t2;
-		n2 = t2 * t2 * dot(grad4[gi2], x2, y2, z2, w2);
-    }   
-	
-	double t3 = 0.6 - x3*x3 - y3*y3 - z3*z3 - w3*w3;
-    if (t3 < 0) 
-		n3 = 0.0;
-	else 
-	{
-		t3 *= t3;
-		n3 = t3 * t3 * dot(grad4[gi3], x3, y3, z3, w3);
-    }
-
-	double t4 = 0.6 - x4*x4 - y4*y4 - z4*z4 - w4*w4;
-    if (t4 < 0) 
-		n4 = 0.0;
-    else 
-	{
-		t4 *= t4;
-		n4 = t4 * t4 * dot(grad4[gi4], x4, y4, z4, w4);
-    }
-
-    // Sum up and scale the result to cover the range [-1,1]
-    return 27.0 * (n0 + n1 + n2 + n3 + n4);
+	return getDefaultGenerator().noise(xin, yin, zin, win);
 }
 
 /*
@@ -825,16 +428,7 @@ double SimplexNoise::noise(double xin, double yin, double zin, double win)
 */
 double SimplexNoise::fBm(double xin, double yin, int octaves, float lacunarity, float gain)
 {
-	float frequency = 1.0;
-	float amplitude = 0.5;
-	double sum = 0;	
-	for (int i = 0; i < octaves; i++) 
-	{
-		sum += noise(xin * frequency, yin * frequency) * amplitude;
-		frequency *= lacunarity;
-		amplitude *= gain;
-	}
-	return sum;
+	return getDefaultGenerator().fBm(xin, yin, octaves, lacunarity, gain);
 }
 
 /*
@@ -844,16 +438,7 @@ double SimplexNoise::fBm(double xin, double yin, int octaves, float lacunarity,
 */
 double SimplexNoise::fBm(double xin, double yin, double zin, int octaves, float lacunarity, float gain)
 {
-	float frequency = 1.0;
-	float amplitude = 0.5;
-	double sum = 0;	
-	for (int i = 0; i < octaves; i++) 
-	{
-		sum += noise(xin * frequency, yin * frequency, zin * frequency) * amplitude;
-		frequency *= lacunarity;
-		amplitude *= gain;
-	}
-	return sum;
+	return getDefaultGenerator().fBm(xin, yin, zin, octaves, lacunarity, gain);
 }
 
 /*
@@ -863,16 +448,50 @@ double SimplexNoise::fBm(double xin, double yin, double zin, int octaves, float
 */
 double SimplexNoise::fBm(double xin, double yin, double zin, double win, int octaves, float lacunarity, float gain)
 {
-	float frequency = 1.0;
-	float amplitude = 0.5;
-	double sum = 0;	
-	for (int i = 0; i < octaves; i++) 
-	{
-		sum += noise(xin * frequency, yin * frequency, zin * frequency, win * frequency) * amplitude;
-		frequency *= lacunarity;
-		amplitude *= gain;
-	}
-	return sum;
+	return getDefaultGenerator().fBm(xin, yin, zin, win, octaves, lacunarity, gain);
+}
+
+/*
+	Name		SimplexNoise::periodicNoise
+	Syntax		SimplexNoise::periodicNoise(double xin, double yin, int periodX, int periodY)
+	Brief		2D gradient noise repeating every periodX, periodY
+*/
+double SimplexNoise::periodicNoise(double xin, double yin, int periodX, int periodY)
+{
+	return getDefaultGenerator().periodicNoise(xin, yin, periodX, periodY);
+}
+
+/*
+	Name		SimplexNoise::periodicNoise
+	Syntax		SimplexNoise::periodicNoise(double xin, double yin, double zin, int periodX, int periodY, int periodZ)
+	Brief		3D gradient noise repeating every periodX, periodY, periodZ
+*/
+double SimplexNoise::periodicNoise(double xin, double yin, double zin, int periodX, int periodY, int periodZ)
+{
+	return getDefaultGenerator().periodicNoise(xin, yin, zin, periodX, periodY, periodZ);
+}
+
+/*
+	Name		SimplexNoise::periodicFBm
+	Syntax		SimplexNoise::periodicFBm(double xin, double yin, int periodX, int periodY, int octaves,
+										  int lacunarity, float gain)
+	Brief		2D Fractal Brownian motion repeating every periodX, periodY
+*/
+double SimplexNoise::periodicFBm(double xin, double yin, int periodX, int periodY, int octaves, int lacunarity, float gain)
+{
+	return getDefaultGenerator().periodicFBm(xin, yin, periodX, periodY, octaves, lacunarity, gain);
+}
+
+/*
+	Name		SimplexNoise::periodicFBm
+	Syntax		SimplexNoise::periodicFBm(double xin, double yin, double zin, int periodX, int periodY, int periodZ,
+										  int octaves, int lacunarity, float gain)
+	Brief		3D Fractal Brownian motion repeating every periodX, periodY, periodZ
+*/
+double SimplexNoise::periodicFBm(double xin, double yin, double zin, int periodX, int periodY, int periodZ,
+	int octaves, int lacunarity, float gain)
+{
+	return getDefaultGenerator().periodicFBm(xin, yin, zin, periodX, periodY, periodZ, octaves, lacunarity, gain);
 }
 
 /*
@@ -882,16 +501,7 @@ double SimplexNoise::fBm(double xin, double yin, double zin, double win, int oct
 */
 double SimplexNoise::turbulence(double xin, double yin, int octaves, float lacunarity, float gain)
 {
-	double sum = 0;
-	float frequency = 1.0;
-	float amplitude = 1.0;
-	for(int i = 0; i < octaves; i++) 
-	{
-		sum += abs(noise(xin * frequency, yin * frequency)) * amplitude;
-		frequency *= lacunarity;
-		amplitude *= gain;
-	}
-	return sum;
+	return getDefaultGenerator().turbulence(xin, yin, octaves, lacunarity, gain);
 }
 
 /*
@@ -901,16 +511,7 @@ double SimplexNoise::turbulence(double xin, double yin, int octaves, float lacun
 */
 double SimplexNoise::turbulence(double xin, double yin, double zin, int octaves, float lacunarity, float gain)
 {
-	double sum = 0;
-	float frequency = 1.0;
-	float amplitude = 1.0;
-	for(int i = 0; i < octaves; i++) 
-	{
-		sum += abs(noise(xin * frequency, yin * frequency, zin * frequency)) * amplitude;
-		frequency *= lacunarity;
-		amplitude *= gain;
-	}
-	return sum;
+	return getDefaultGenerator().turbulence(xin, yin, zin, octaves, lacunarity, gain);
 }
 
 /*
@@ -920,16 +521,7 @@ double SimplexNoise::turbulence(double xin, double yin, double zin, int octaves,
 */
 double SimplexNoise::turbulence(double xin, double yin, double zin, double win, int octaves, float lacunarity, float gain)
 {
-	double sum = 0;
-	float frequency = 1.0;
-	float amplitude = 1.0;
-	for(int i = 0; i < octaves; i++) 
-	{
-		sum += abs(noise(xin * frequency, yin * frequency, zin * frequency, win * frequency)) * amplitude;
-		frequency *= lacunarity;
-		amplitude *= gain;
-	}
-	return sum;
+	return getDefaultGenerator().turbulence(xin, yin, zin, win, octaves, lacunarity, gain);
 }
 
 /*
@@ -939,10 +531,7 @@ double SimplexNoise::turbulence(double xin, double yin, double zin, double win,
 */
 double SimplexNoise::ridge(float h, float offset)
 {
-    h = abs(h);
-    h = offset - h;
-    h = h * h;
-    return h;
+	return ridge<float>(h, offset);
 }
 
 /*
@@ -952,19 +541,7 @@ double SimplexNoise::ridge(float h, float offset)
 */
 double SimplexNoise::ridgedMultifractal(double xin, double yin, int octaves, float lacunarity, float gain, float offset)
 {
-	double sum = 0;
-	float frequency = 1.0;
-	float amplitude = 0.5;
-	float previous = 1.0;
-	for(int i = 0; i < octaves; i++) 
-	{
-		double n = ridge(noise(xin * frequency, yin * frequency), offset);
-		sum += n * amplitude * previous;
-		previous = n;
-		frequency *= lacunarity;
-		amplitude *= gain;
-	}
-	return sum;
+	return getDefaultGenerator().ridgedMultifractal(xin, yin, octaves, lacunarity, gain, offset);
 }
 
 /*
@@ -974,19 +551,7 @@ double SimplexNoise::ridgedMultifractal(double xin, double yin, int octaves, flo
 */
 double SimplexNoise::ridgedMultifractal(double xin, double yin, double zin, int octaves, float lacunarity, float gain, float offset)
 {
-	double sum = 0;
-	float frequency = 1.0;
-	float amplitude = 0.5;
-	float previous = 1.0;
-	for(int i = 0; i < octaves; i++) 
-	{
-		double n = ridge(noise(xin * frequency, yin * frequency, zin * frequency), offset);
-		sum += n * amplitude * previous;
-		previous = n;
-		frequency *= lacunarity;
-		amplitude *= gain;
-	}
-	return sum;
+	return getDefaultGenerator().ridgedMultifractal(xin, yin, zin, octaves, lacunarity, gain, offset);
 }
 
 /*
@@ -996,19 +561,7 @@ double SimplexNoise::ridgedMultifractal(double xin, double yin, double zin, int
 */
 double SimplexNoise::ridgedMultifractal(double xin, double yin, double zin, double win, int octaves, float lacunarity, float gain, float offset)
 {
-	double sum = 0;
-	float frequency = 1.0;
-	float amplitude = 0.5;
-	float previous = 1.0;
-	for(int i = 0; i < octaves; i++) 
-	{
-		double n = ridge(noise(xin * frequency, yin * frequency, zin * frequency, win * frequency), offset);
-		sum += n * amplitude * previous;
-		previous = n;
-		frequency *= lacunarity;
-		amplitude *= gain;
-	}
-	return sum;
+	return getDefaultGenerator().ridgedMultifractal(xin, yin, zin, win, octaves, lacunarity, gain, offset);
 }
 
 ID3D10ShaderResourceView* SimplexNoise::getPermTable()
@@ -1028,7 +581,16 @@ ID3D10ShaderResourceView* SimplexNoise::getSimplexTex()
 ID3D10ShaderResourceView* SimplexNoise::getPeturbationTex()
 {
 	if (!perturbationTex_)
-		perturbationTex_ = createPerturbanceTexture();
+	{
+		// A small seamless tile repeated across the screen, so the cost does not
+		// grow with the window size
+		PerturbanceDesc desc;
+		desc.format = PERTURBANCE_SNORM8;
+		desc.width = PERTURBANCE_TILE_SIZE;
+		desc.height = PERTURBANCE_TILE_SIZE;
+		desc.tileable = true;
+		perturbationTex_ = createPerturbanceTexture(desc);
+	}
 	return perturbationTex_;
 }
 
@@ -11,12 +11,24 @@
 #define SIMPLEXNOISE_H
 
 #include <d3dx10.h>
+#include "Utilities/SimplexNoiseTables.hpp"
+#include "Utilities/SimplexNoiseBatch.hpp"
+#include "Utilities/SimplexNoiseGenerator.hpp"
+#include "Utilities/SimplexNoiseKernels.hpp"
+#include "Utilities/PerturbanceField.hpp"
+#include "Utilities/Random.hpp"
 
 namespace SimplexNoise
 {
+	// Edge length of the perturbance tile the heat haze repeats across the screen
+	const int PERTURBANCE_TILE_SIZE = 256;
+
+	// Seed of the random values texture read by the particle effects
+	const unsigned int RANDOM_TEXTURE_SEED = 1;
+
 	ID3D10ShaderResourceView* createPermTableTexture();
 	ID3D10ShaderResourceView* createSimplexTexture();
-	ID3D10ShaderResourceView* createPerturbanceTexture();
+	ID3D10ShaderResourceView* createPerturbanceTexture(const PerturbanceDesc& desc);
 	ID3D10ShaderResourceView* createRandomTexture();
 
 	ID3D10ShaderResourceView* getPermTable();
@@ -31,9 +43,9 @@ namespace SimplexNoise
 
 	int fastfloor(double x);
 
-	double dot(int g[], double x, double y);
-	double dot(int g[], double x, double y, double z);
-	double dot(int g[], double x, double y, double z, double w);
+	double dot(const int g[], double x, double y);
+	double dot(const int g[], double x, double y, double z);
+	double dot(const int g[], double x, double y, double z, double w);
 
 	double noise(double xin, double yin);
 	double noise(double xin, double yin, double zin);
@@ -43,6 +55,14 @@ namespace SimplexNoise
 	double fBm(double xin, double yin, double zin, int octaves, float lacunarity = 2.0, float gain = 0.5);
 	double fBm(double xin, double yin, double zin, double win, int octaves, float lacunarity = 2.0, float gain = 0.5);
 
+	// Periods are rounded up to a multiple of 3, the lacunarity is whole so every octave tiles
+	double periodicNoise(double xin, double yin, int periodX, int periodY);
+	double periodicNoise(double xin, double yin, double zin, int periodX, int periodY, int periodZ);
+
+	double periodicFBm(double xin, double yin, int periodX, int periodY, int octaves, int lacunarity = 2, float gain = 0.5);
+	double periodicFBm(double xin, double yin, double zin, int periodX, int periodY, int periodZ,
+		int octaves, int lacunarity = 2, float gain = 0.5);
+
 	double turbulence(double xin, double yin, int octaves, float lacunarity = 2.0, float gain = 0.5);
 	double turbulence(double xin, double yin, double zin, int octaves, float lacunarity = 2.0, float gain = 0.5);
 	double turbulence(double xin, double yin, double zin, double win, int octaves, float lacunarity = 2.0, float gain = 0.5);
@@ -53,61 +73,22 @@ namespace SimplexNoise
 	double ridgedMultifractal(double xin, double yin, double zin, int octaves, float lacunarity = 2.0, float gain = 0.5, float offset = 1.0);
 	double ridgedMultifractal(double xin, double yin, double zin, double win, int octaves, float lacunarity = 2.0, float gain = 0.5, float offset = 1.0);
 
-	static int grad3[][3] = {{1,1,0},{-1,1,0},{1,-1,0},{-1,-1,0},
-                                 {1,0,1},{-1,0,1},{1,0,-1},{-1,0,-1},
-                                 {0,1,1},{0,-1,1},{0,1,-1},{0,-1,-1}};
-
-	static int grad4[][4]= {{0,1,1,1}, {0,1,1,-1}, {0,1,-1,1}, {0,1,-1,-1},
-                   {0,-1,1,1}, {0,-1,1,-1}, {0,-1,-1,1}, {0,-1,-1,-1},
-                   {1,0,1,1}, {1,0,1,-1}, {1,0,-1,1}, {1,0,-1,-1},
-                   {-1,0,1,1}, {-1,0,1,-1}, {-1,0,-1,1}, {-1,0,-1,-1},
-                   {1,1,0,1}, {1,1,0,-1}, {1,-1,0,1}, {1,-1,0,-1},
-                   {-1,1,0,1}, {-1,1,0,-1}, {-1,-1,0,1}, {-1,-1,0,-1},
-                   {1,1,1,0}, {1,1,-1,0}, {1,-1,1,0}, {1,-1,-1,0},
-                   {-1,1,1,0}, {-1,1,-1,0}, {-1,-1,1,0}, {-1,-1,-1,0}};
-
-	static int p[] = {151,160,137,91,90,15,
-	131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
-	190, 6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,
-	88,237,149,56,87,174,20,125,136,171,168, 68,175,74,165,71,134,139,48,27,166,
-	77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244,
-	102,143,54, 65,25,63,161, 1,216,80,73,209,76,132,187,208, 89,18,169,200,196,
-	135,130,116,188,159,86,164,100,109,198,173,186, 3,64,52,217,226,250,124,123,
-	5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,
-	223,183,170,213,119,248,152, 2,44,154,163, 70,221,153,101,155,167, 43,172,9,
-	129,22,39,253, 19,98,108,110,79,113,224,232,178,185, 112,104,218,246,97,228,
-	251,34,242,193,238,210,144,12,191,179,162,241, 81,51,145,235,249,14,239,107,
-	49,192,214, 31,181,199,106,157,184, 84,204,176,115,121,50,45,127, 4,150,254,
-	138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180};
-
-	// A lookup table to traverse the simplex around a given point in 4D.
-	// Details can be found where this table is used, in the 4D noise method.
-	static int simplex[][4] = {
-	{0,1,2,3},{0,1,3,2},{0,0,0,0},{0,2,3,1},{0,0,0,0},{0,0,0,0},{0,0,0,0},{1,2,3,0},
-	{0,2,1,3},{0,0,0,0},{0,3,1,2},{0,3,2,1},{0,0,0,0},{0,0,0,0},{0,0,0,0},{1,3,2,0},
-	{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},
-	{1,2,0,3},{0,0,0,0},{1,3,0,2},{0,0,0,0},{0,0,0,0},{0,0,0,0},{2,3,0,1},{2,3,1,0},
-	{1,0,2,3},{1,0,3,2},{0,0,0,0},{0,0,0,0},{0,0,0,0},{2,0,3,1},{0,0,0,0},{2,1,3,0},
-	{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},{0,0,0,0},
-	{2,0,1,3},{0,0,0,0},{0,0,0,0},{0,0,0,0},{3,0,1,2},{3,0,2,1},{0,0,0,0},{3,1,2,0},
-	{2,1,0,3},{0,0,0,0},{0,0,0,0},{0,0,0,0},{3,1,0,2},{0,0,0,0},{3,2,0,1},{3,2,1,0}};
-
 	// Returns random float in [0, 1)
-	D3DX10INLINE float randFloat()
+	D3DX10INLINE float randFloat(Random& random)
 	{
-		return (float)(rand()) / (float)RAND_MAX;
+		return random.nextFloat();
 	}
 
 	// Returns random float in [a, b)
-	D3DX10INLINE float randFloat(float a, float b)
+	D3DX10INLINE float randFloat(Random& random, float a, float b)
 	{
-		return a + randFloat()*(b-a);
+		return random.nextFloat(a, b);
 	}
 
 	// Returns random vector on the unit sphere
-	D3DX10INLINE D3DXVECTOR3 randUnitVector3()
+	D3DX10INLINE D3DXVECTOR3 randUnitVector3(Random& random)
 	{
-		D3DXVECTOR3 v(randFloat(), randFloat(), randFloat());
+		D3DXVECTOR3 v(randFloat(random), randFloat(random), randFloat(random));
 		D3DXVec3Normalize(&v, &v);
 		return v;
 	}
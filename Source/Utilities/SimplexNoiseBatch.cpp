@@ -0,0 +1,928 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Simplex Noise Batch
+	Brief		Definitions of the batched simplex noise functions
+*/
+
+#include <cmath>
+
+#include "Utilities/SimplexNoiseBatch.hpp"
+#include "Utilities/SimplexNoiseGenerator.hpp"
+#include "Utilities/SimplexNoiseKernels.hpp"
+#include "Utilities/SimplexNoiseTables.hpp"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SIMPLEX_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// MSVC allows AVX2 intrinsics in any function, GCC and Clang need the target enabling per function
+#if defined(SIMPLEX_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SIMPLEX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMPLEX_TARGET_AVX2
+#endif
+
+namespace
+{
+	// Skewing and unskewing factors for 2D and 3D, shared with the scalar kernels so every level rounds alike
+	const float F2 = SimplexNoise::SimplexConstants<float, 2>::F;
+	const float G2 = SimplexNoise::SimplexConstants<float, 2>::G;
+	const float F3 = SimplexNoise::SimplexConstants<float, 3>::F;
+	const float G3 = SimplexNoise::SimplexConstants<float, 3>::G;
+
+	// Number of points generated on the stack at a time when filling a lattice
+	const int LATTICE_CHUNK = 256;
+
+	/*
+		Name		Gradients
+		Brief		The 3D gradients split into components so the kernels can gather them
+	*/
+	struct Gradients
+	{
+		float x[12];
+		float y[12];
+		float z[12];
+
+		Gradients()
+		{
+			for (int i = 0; i < 12; ++i)
+			{
+				x[i] = (float)SimplexNoise::grad3[i][0];
+				y[i] = (float)SimplexNoise::grad3[i][1];
+				z[i] = (float)SimplexNoise::grad3[i][2];
+			}
+		}
+	};
+
+	const Gradients& gradients()
+	{
+		static const Gradients gradients;
+		return gradients;
+	}
+
+	/*
+		Name		Tables
+		Brief		The tables a kernel reads, the permutations of one generator and the
+					shared gradients
+	*/
+	struct Tables
+	{
+		const int* perm;
+		const int* permMod12;
+		const float* gradX;
+		const float* gradY;
+		const float* gradZ;
+
+		explicit Tables(const SimplexNoise::Generator& generator)
+		{
+			const Gradients& g = gradients();
+			perm = generator.getPermutation();
+			permMod12 = generator.getPermutationMod12();
+			gradX = g.x;
+			gradY = g.y;
+			gradZ = g.z;
+		}
+	};
+
+	/*
+		Name		detectSimdLevel
+		Syntax		detectSimdLevel()
+		Return		SimplexNoise::SimdLevel - The best level supported by the CPU and OS
+		Brief		Queries cpuid (and xgetbv for the OS saving YMM state) to find
+					whether AVX2 can be used
+	*/
+	SimplexNoise::SimdLevel detectSimdLevel()
+	{
+#if defined(SIMPLEX_X86)
+		unsigned int regs[4] = {0, 0, 0, 0};
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		__cpuid(info, 1);
+		for (int i = 0; i < 4; ++i)
+			regs[i] = (unsigned int)info[i];
+#else
+		unsigned int maxLeaf = __get_cpuid_max(0, 0);
+		__get_cpuid(1, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+		bool sse2 = (regs[3] & (1u << 26)) != 0;
+		bool osxsave = (regs[2] & (1u << 27)) != 0;
+		bool avx = (regs[2] & (1u << 28)) != 0;
+
+		if (!sse2)
+			return SimplexNoise::SIMD_SCALAR;
+		if (!osxsave || !avx || maxLeaf < 7)
+			return SimplexNoise::SIMD_SSE2;
+
+		// The OS must save the XMM and YMM registers on context switch
+#if defined(_MSC_VER)
+		unsigned long long xcr0 = _xgetbv(0);
+#else
+		unsigned int xcrLow, xcrHigh;
+		__asm__ volatile("xgetbv" : "=a"(xcrLow), "=d"(xcrHigh) : "c"(0));
+		unsigned long long xcr0 = ((unsigned long long)xcrHigh << 32) | xcrLow;
+#endif
+		if ((xcr0 & 6) != 6)
+			return SimplexNoise::SIMD_SSE2;
+
+#if defined(_MSC_VER)
+		__cpuidex(info, 7, 0);
+		bool avx2 = (info[1] & (1 << 5)) != 0;
+#else
+		__cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+		bool avx2 = (regs[1] & (1u << 5)) != 0;
+#endif
+		return avx2 ? SimplexNoise::SIMD_AVX2 : SimplexNoise::SIMD_SSE2;
+#else
+		return SimplexNoise::SIMD_SCALAR;
+#endif
+	}
+
+	const SimplexNoise::SimdLevel supportedLevel = detectSimdLevel();
+	SimplexNoise::SimdLevel currentLevel = supportedLevel;
+
+	/*
+		Name		noise2Scalar
+		Syntax		noise2Scalar(const Tables& t, float xin, float yin)
+		Brief		Single precision 2D simplex noise for one point
+	*/
+	inline float noise2Scalar(const Tables& t, float xin, float yin)
+	{
+		float in[2] = {xin, yin};
+		return SimplexNoise::simplexNoise<float, 2>(in, t.perm);
+	}
+
+	/*
+		Name		noise3Scalar
+		Syntax		noise3Scalar(const Tables& t, float xin, float yin, float zin)
+		Brief		Single precision 3D simplex noise for one point
+	*/
+	inline float noise3Scalar(const Tables& t, float xin, float yin, float zin)
+	{
+		float in[3] = {xin, yin, zin};
+		return SimplexNoise::simplexNoise<float, 3>(in, t.perm);
+	}
+
+	void noise2Scalar(const Tables& t, const float* x, const float* y, float* out, int count)
+	{
+		for (int n = 0; n < count; ++n)
+			out[n] = noise2Scalar(t, x[n], y[n]);
+	}
+
+	void noise3Scalar(const Tables& t, const float* x, const float* y, const float* z, float* out, int count)
+	{
+		for (int n = 0; n < count; ++n)
+			out[n] = noise3Scalar(t, x[n], y[n], z[n]);
+	}
+
+	/*
+		Name		noise3DerivativeScalar
+		Syntax		noise3DerivativeScalar(const Tables& t, const float* x, const float* y, const float* z,
+										   float* out, float* dx, float* dy, float* dz, int count)
+		Brief		Single precision 3D simplex noise and its gradient for an array of points
+	*/
+	void noise3DerivativeScalar(const Tables& t, const float* x, const float* y, const float* z,
+		float* out, float* dx, float* dy, float* dz, int count)
+	{
+		for (int n = 0; n < count; ++n)
+		{
+			float in[3] = {x[n], y[n], z[n]};
+			float gradient[3];
+			out[n] = SimplexNoise::simplexNoiseDerivative<float, 3>(in, t.perm, gradient);
+			dx[n] = gradient[0];
+			dy[n] = gradient[1];
+			dz[n] = gradient[2];
+		}
+	}
+
+#if defined(SIMPLEX_X86)
+	/*
+		Name		floorSSE2
+		Syntax		floorSSE2(__m128 x, __m128i& xi)
+		Brief		Floors four floats, SSE2 has no rounding instruction so truncate and
+					correct the lanes that were rounded up
+	*/
+	inline __m128 floorSSE2(__m128 x, __m128i& xi)
+	{
+		__m128i truncated = _mm_cvttps_epi32(x);
+		__m128 f = _mm_cvtepi32_ps(truncated);
+		__m128i roundedUp = _mm_castps_si128(_mm_cmplt_ps(x, f));
+		xi = _mm_add_epi32(truncated, roundedUp);	// all ones is -1
+		return _mm_cvtepi32_ps(xi);
+	}
+
+	/*
+		Name		contributionSSE2
+		Brief		(max(r - |d|^2, 0))^4 * (g . d) for one corner of four simplices
+	*/
+	inline __m128 contribution2SSE2(__m128 radius, __m128 x, __m128 y, __m128 gx, __m128 gy)
+	{
+		__m128 t = _mm_sub_ps(_mm_sub_ps(radius, _mm_mul_ps(x, x)), _mm_mul_ps(y, y));
+		t = _mm_max_ps(t, _mm_setzero_ps());
+		t = _mm_mul_ps(t, t);
+		__m128 dot = _mm_add_ps(_mm_mul_ps(gx, x), _mm_mul_ps(gy, y));
+		return _mm_mul_ps(_mm_mul_ps(t, t), dot);
+	}
+
+	inline __m128 contribution3SSE2(__m128 radius, __m128 x, __m128 y, __m128 z, __m128 gx, __m128 gy, __m128 gz)
+	{
+		__m128 t = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(radius, _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		t = _mm_max_ps(t, _mm_setzero_ps());
+		t = _mm_mul_ps(t, t);
+		__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(gx, x), _mm_mul_ps(gy, y)), _mm_mul_ps(gz, z));
+		return _mm_mul_ps(_mm_mul_ps(t, t), dot);
+	}
+
+	/*
+		Name		derivative3SSE2
+		Brief		Adds one corner's contribution t^4 (g . d) to value and its derivative
+					t^4 g - 8 t^3 (g . d) d to gradient, in the order simplexNoiseDerivative uses
+	*/
+	inline void derivative3SSE2(__m128 radius, __m128 x, __m128 y, __m128 z, __m128 gx, __m128 gy, __m128 gz,
+		__m128& value, __m128* gradient)
+	{
+		__m128 t = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(radius, _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		t = _mm_max_ps(t, _mm_setzero_ps());
+		__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(gx, x), _mm_mul_ps(gy, y)), _mm_mul_ps(gz, z));
+		__m128 t2 = _mm_mul_ps(t, t);
+		__m128 t4 = _mm_mul_ps(t2, t2);
+		value = _mm_add_ps(value, _mm_mul_ps(t4, dot));
+
+		__m128 falloff = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t2, t), dot), _mm_set1_ps(-8.0f));
+		gradient[0] = _mm_add_ps(gradient[0], _mm_add_ps(_mm_mul_ps(falloff, x), _mm_mul_ps(t4, gx)));
+		gradient[1] = _mm_add_ps(gradient[1], _mm_add_ps(_mm_mul_ps(falloff, y), _mm_mul_ps(t4, gy)));
+		gradient[2] = _mm_add_ps(gradient[2], _mm_add_ps(_mm_mul_ps(falloff, z), _mm_mul_ps(t4, gz)));
+	}
+
+	/*
+		Name		noise2SSE2
+		Brief		2D simplex noise four points at a time. SSE2 has no gather so the
+					hashing is done per lane from spilled indices.
+	*/
+	void noise2SSE2(const Tables& t, const float* x, const float* y, float* out, int count)
+	{
+		const __m128 f2 = _mm_set1_ps(F2);
+		const __m128 g2 = _mm_set1_ps(G2);
+		const __m128 g2x2 = _mm_set1_ps(2.0f * G2);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 radius = _mm_set1_ps(0.5f);
+		const __m128 scale = _mm_set1_ps(70.0f);
+
+		int n = 0;
+		for (; n + 4 <= count; n += 4)
+		{
+			__m128 xin = _mm_loadu_ps(x + n);
+			__m128 yin = _mm_loadu_ps(y + n);
+
+			__m128 s = _mm_mul_ps(_mm_add_ps(xin, yin), f2);
+			__m128i iv, jv;
+			__m128 fi = floorSSE2(_mm_add_ps(xin, s), iv);
+			__m128 fj = floorSSE2(_mm_add_ps(yin, s), jv);
+			__m128 tt = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(iv, jv)), g2);
+			__m128 x0 = _mm_sub_ps(xin, _mm_sub_ps(fi, tt));
+			__m128 y0 = _mm_sub_ps(yin, _mm_sub_ps(fj, tt));
+
+			__m128 lower = _mm_cmpge_ps(x0, y0);
+			__m128 i1 = _mm_and_ps(lower, one);
+			__m128 j1 = _mm_andnot_ps(lower, one);
+
+			__m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), g2);
+			__m128 y1 = _mm_add_ps(_mm_sub_ps(y0, j1), g2);
+			__m128 x2 = _mm_add_ps(_mm_sub_ps(x0, one), g2x2);
+			__m128 y2 = _mm_add_ps(_mm_sub_ps(y0, one), g2x2);
+
+			int ii[4], jj[4], i1s[4];
+			_mm_storeu_si128((__m128i*)ii, iv);
+			_mm_storeu_si128((__m128i*)jj, jv);
+			_mm_storeu_si128((__m128i*)i1s, _mm_castps_si128(lower));
+
+			float gx[3][4], gy[3][4];
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				int a = ii[lane] & 255;
+				int b = jj[lane] & 255;
+				int o = i1s[lane] & 1;
+				int gi0 = t.permMod12[a + t.perm[b]];
+				int gi1 = t.permMod12[a + o + t.perm[b + 1 - o]];
+				int gi2 = t.permMod12[a + 1 + t.perm[b + 1]];
+				gx[0][lane] = t.gradX[gi0]; gy[0][lane] = t.gradY[gi0];
+				gx[1][lane] = t.gradX[gi1]; gy[1][lane] = t.gradY[gi1];
+				gx[2][lane] = t.gradX[gi2]; gy[2][lane] = t.gradY[gi2];
+			}
+
+			__m128 n0 = contribution2SSE2(radius, x0, y0, _mm_loadu_ps(gx[0]), _mm_loadu_ps(gy[0]));
+			__m128 n1 = contribution2SSE2(radius, x1, y1, _mm_loadu_ps(gx[1]), _mm_loadu_ps(gy[1]));
+			__m128 n2 = contribution2SSE2(radius, x2, y2, _mm_loadu_ps(gx[2]), _mm_loadu_ps(gy[2]));
+
+			_mm_storeu_ps(out + n, _mm_mul_ps(scale, _mm_add_ps(_mm_add_ps(n0, n1), n2)));
+		}
+
+		for (; n < count; ++n)
+			out[n] = noise2Scalar(t, x[n], y[n]);
+	}
+
+	/*
+		Name		noise3SSE2
+		Brief		3D simplex noise four points at a time, with the gradient written to
+					dx, dy and dz when DERIVATIVE is set
+	*/
+	template <bool DERIVATIVE>
+	void noise3SSE2(const Tables& t, const float* x, const float* y, const float* z, float* out,
+		float* dx, float* dy, float* dz, int count)
+	{
+		const __m128 f3 = _mm_set1_ps(F3);
+		const __m128 g3 = _mm_set1_ps(G3);
+		const __m128 g3x2 = _mm_set1_ps(2.0f * G3);
+		const __m128 g3x3 = _mm_set1_ps(3.0f * G3);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 radius = _mm_set1_ps(0.6f);
+		const __m128 scale = _mm_set1_ps(32.0f);
+
+		int n = 0;
+		for (; n + 4 <= count; n += 4)
+		{
+			__m128 xin = _mm_loadu_ps(x + n);
+			__m128 yin = _mm_loadu_ps(y + n);
+			__m128 zin = _mm_loadu_ps(z + n);
+
+			__m128 s = _mm_mul_ps(_mm_add_ps(_mm_add_ps(xin, yin), zin), f3);
+			__m128i iv, jv, kv;
+			__m128 fi = floorSSE2(_mm_add_ps(xin, s), iv);
+			__m128 fj = floorSSE2(_mm_add_ps(yin, s), jv);
+			__m128 fk = floorSSE2(_mm_add_ps(zin, s), kv);
+			__m128 tt = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(iv, jv), kv)), g3);
+			__m128 x0 = _mm_sub_ps(xin, _mm_sub_ps(fi, tt));
+			__m128 y0 = _mm_sub_ps(yin, _mm_sub_ps(fj, tt));
+			__m128 z0 = _mm_sub_ps(zin, _mm_sub_ps(fk, tt));
+
+			__m128 xy = _mm_cmpge_ps(x0, y0);
+			__m128 xz = _mm_cmpge_ps(x0, z0);
+			__m128 yz = _mm_cmpge_ps(y0, z0);
+			__m128 first[3], second[3];
+			first[0] = _mm_and_ps(xy, xz);
+			first[1] = _mm_andnot_ps(xy, yz);
+			first[2] = _mm_andnot_ps(_mm_or_ps(xz, yz), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+			second[0] = _mm_or_ps(xy, xz);
+			second[1] = _mm_or_ps(_mm_andnot_ps(xy, _mm_castsi128_ps(_mm_set1_epi32(-1))), yz);
+			second[2] = _mm_andnot_ps(_mm_and_ps(xz, yz), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+			__m128 x1 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(first[0], one)), g3);
+			__m128 y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_and_ps(first[1], one)), g3);
+			__m128 z1 = _mm_add_ps(_mm_sub_ps(z0, _mm_and_ps(first[2], one)), g3);
+			__m128 x2 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(second[0], one)), g3x2);
+			__m128 y2 = _mm_add_ps(_mm_sub_ps(y0, _mm_and_ps(second[1], one)), g3x2);
+			__m128 z2 = _mm_add_ps(_mm_sub_ps(z0, _mm_and_ps(second[2], one)), g3x2);
+			__m128 x3 = _mm_add_ps(_mm_sub_ps(x0, one), g3x3);
+			__m128 y3 = _mm_add_ps(_mm_sub_ps(y0, one), g3x3);
+			__m128 z3 = _mm_add_ps(_mm_sub_ps(z0, one), g3x3);
+
+			int ii[4], jj[4], kk[4], o1[3][4], o2[3][4];
+			_mm_storeu_si128((__m128i*)ii, iv);
+			_mm_storeu_si128((__m128i*)jj, jv);
+			_mm_storeu_si128((__m128i*)kk, kv);
+			for (int d = 0; d < 3; ++d)
+			{
+				_mm_storeu_si128((__m128i*)o1[d], _mm_castps_si128(first[d]));
+				_mm_storeu_si128((__m128i*)o2[d], _mm_castps_si128(second[d]));
+			}
+
+			float gx[4][4], gy[4][4], gz[4][4];
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				int a = ii[lane] & 255;
+				int b = jj[lane] & 255;
+				int c = kk[lane] & 255;
+				int ai = o1[0][lane] & 1, bj = o1[1][lane] & 1, ck = o1[2][lane] & 1;
+				int a2 = o2[0][lane] & 1, b2 = o2[1][lane] & 1, c2 = o2[2][lane] & 1;
+				int gi[4];
+				gi[0] = t.permMod12[a + t.perm[b + t.perm[c]]];
+				gi[1] = t.permMod12[a + ai + t.perm[b + bj + t.perm[c + ck]]];
+				gi[2] = t.permMod12[a + a2 + t.perm[b + b2 + t.perm[c + c2]]];
+				gi[3] = t.permMod12[a + 1 + t.perm[b + 1 + t.perm[c + 1]]];
+				for (int corner = 0; corner < 4; ++corner)
+				{
+					gx[corner][lane] = t.gradX[gi[corner]];
+					gy[corner][lane] = t.gradY[gi[corner]];
+					gz[corner][lane] = t.gradZ[gi[corner]];
+				}
+			}
+
+			if constexpr (DERIVATIVE)
+			{
+				__m128 value = _mm_setzero_ps();
+				__m128 gradient[3] = {value, value, value};
+				derivative3SSE2(radius, x0, y0, z0, _mm_loadu_ps(gx[0]), _mm_loadu_ps(gy[0]), _mm_loadu_ps(gz[0]), value, gradient);
+				derivative3SSE2(radius, x1, y1, z1, _mm_loadu_ps(gx[1]), _mm_loadu_ps(gy[1]), _mm_loadu_ps(gz[1]), value, gradient);
+				derivative3SSE2(radius, x2, y2, z2, _mm_loadu_ps(gx[2]), _mm_loadu_ps(gy[2]), _mm_loadu_ps(gz[2]), value, gradient);
+				derivative3SSE2(radius, x3, y3, z3, _mm_loadu_ps(gx[3]), _mm_loadu_ps(gy[3]), _mm_loadu_ps(gz[3]), value, gradient);
+
+				_mm_storeu_ps(out + n, _mm_mul_ps(scale, value));
+				_mm_storeu_ps(dx + n, _mm_mul_ps(gradient[0], scale));
+				_mm_storeu_ps(dy + n, _mm_mul_ps(gradient[1], scale));
+				_mm_storeu_ps(dz + n, _mm_mul_ps(gradient[2], scale));
+			}
+			else
+			{
+				__m128 n0 = contribution3SSE2(radius, x0, y0, z0, _mm_loadu_ps(gx[0]), _mm_loadu_ps(gy[0]), _mm_loadu_ps(gz[0]));
+				__m128 n1 = contribution3SSE2(radius, x1, y1, z1, _mm_loadu_ps(gx[1]), _mm_loadu_ps(gy[1]), _mm_loadu_ps(gz[1]));
+				__m128 n2 = contribution3SSE2(radius, x2, y2, z2, _mm_loadu_ps(gx[2]), _mm_loadu_ps(gy[2]), _mm_loadu_ps(gz[2]));
+				__m128 n3 = contribution3SSE2(radius, x3, y3, z3, _mm_loadu_ps(gx[3]), _mm_loadu_ps(gy[3]), _mm_loadu_ps(gz[3]));
+
+				_mm_storeu_ps(out + n, _mm_mul_ps(scale, _mm_add_ps(_mm_add_ps(_mm_add_ps(n0, n1), n2), n3)));
+			}
+		}
+
+		if constexpr (DERIVATIVE)
+			noise3DerivativeScalar(t, x + n, y + n, z + n, out + n, dx + n, dy + n, dz + n, count - n);
+		else
+			noise3Scalar(t, x + n, y + n, z + n, out + n, count - n);
+	}
+
+	SIMPLEX_TARGET_AVX2 inline __m256 contribution2AVX2(__m256 radius, __m256 x, __m256 y, __m256 gx, __m256 gy)
+	{
+		__m256 t = _mm256_sub_ps(_mm256_sub_ps(radius, _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y));
+		t = _mm256_max_ps(t, _mm256_setzero_ps());
+		t = _mm256_mul_ps(t, t);
+		__m256 dot = _mm256_add_ps(_mm256_mul_ps(gx, x), _mm256_mul_ps(gy, y));
+		return _mm256_mul_ps(_mm256_mul_ps(t, t), dot);
+	}
+
+	SIMPLEX_TARGET_AVX2 inline __m256 contribution3AVX2(__m256 radius, __m256 x, __m256 y, __m256 z, __m256 gx, __m256 gy, __m256 gz)
+	{
+		__m256 t = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(radius, _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+		t = _mm256_max_ps(t, _mm256_setzero_ps());
+		t = _mm256_mul_ps(t, t);
+		__m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(gx, x), _mm256_mul_ps(gy, y)), _mm256_mul_ps(gz, z));
+		return _mm256_mul_ps(_mm256_mul_ps(t, t), dot);
+	}
+
+	SIMPLEX_TARGET_AVX2 inline void derivative3AVX2(__m256 radius, __m256 x, __m256 y, __m256 z, __m256 gx, __m256 gy, __m256 gz,
+		__m256& value, __m256* gradient)
+	{
+		__m256 t = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(radius, _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+		t = _mm256_max_ps(t, _mm256_setzero_ps());
+		__m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(gx, x), _mm256_mul_ps(gy, y)), _mm256_mul_ps(gz, z));
+		__m256 t2 = _mm256_mul_ps(t, t);
+		__m256 t4 = _mm256_mul_ps(t2, t2);
+		value = _mm256_add_ps(value, _mm256_mul_ps(t4, dot));
+
+		__m256 falloff = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t2, t), dot), _mm256_set1_ps(-8.0f));
+		gradient[0] = _mm256_add_ps(gradient[0], _mm256_add_ps(_mm256_mul_ps(falloff, x), _mm256_mul_ps(t4, gx)));
+		gradient[1] = _mm256_add_ps(gradient[1], _mm256_add_ps(_mm256_mul_ps(falloff, y), _mm256_mul_ps(t4, gy)));
+		gradient[2] = _mm256_add_ps(gradient[2], _mm256_add_ps(_mm256_mul_ps(falloff, z), _mm256_mul_ps(t4, gz)));
+	}
+
+	/*
+		Name		noise2AVX2
+		Brief		2D simplex noise eight points at a time, hashing with gathers
+	*/
+	SIMPLEX_TARGET_AVX2 void noise2AVX2(const Tables& t, const float* x, const float* y, float* out, int count)
+	{
+		const __m256 f2 = _mm256_set1_ps(F2);
+		const __m256 g2 = _mm256_set1_ps(G2);
+		const __m256 g2x2 = _mm256_set1_ps(2.0f * G2);
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 radius = _mm256_set1_ps(0.5f);
+		const __m256 scale = _mm256_set1_ps(70.0f);
+		const __m256i mask255 = _mm256_set1_epi32(255);
+		const __m256i oneI = _mm256_set1_epi32(1);
+
+		int n = 0;
+		for (; n + 8 <= count; n += 8)
+		{
+			__m256 xin = _mm256_loadu_ps(x + n);
+			__m256 yin = _mm256_loadu_ps(y + n);
+
+			__m256 s = _mm256_mul_ps(_mm256_add_ps(xin, yin), f2);
+			__m256 fi = _mm256_floor_ps(_mm256_add_ps(xin, s));
+			__m256 fj = _mm256_floor_ps(_mm256_add_ps(yin, s));
+			__m256i iv = _mm256_cvttps_epi32(fi);
+			__m256i jv = _mm256_cvttps_epi32(fj);
+			__m256 tt = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(iv, jv)), g2);
+			__m256 x0 = _mm256_sub_ps(xin, _mm256_sub_ps(fi, tt));
+			__m256 y0 = _mm256_sub_ps(yin, _mm256_sub_ps(fj, tt));
+
+			__m256 lower = _mm256_cmp_ps(x0, y0, _CMP_GE_OQ);
+			__m256 i1 = _mm256_and_ps(lower, one);
+			__m256 j1 = _mm256_andnot_ps(lower, one);
+
+			__m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, i1), g2);
+			__m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, j1), g2);
+			__m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, one), g2x2);
+			__m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, one), g2x2);
+
+			__m256i ii = _mm256_and_si256(iv, mask255);
+			__m256i jj = _mm256_and_si256(jv, mask255);
+			__m256i i1i = _mm256_and_si256(_mm256_castps_si256(lower), oneI);
+			__m256i j1i = _mm256_sub_epi32(oneI, i1i);
+
+			__m256i gi0 = _mm256_i32gather_epi32(t.permMod12,
+				_mm256_add_epi32(ii, _mm256_i32gather_epi32(t.perm, jj, 4)), 4);
+			__m256i gi1 = _mm256_i32gather_epi32(t.permMod12,
+				_mm256_add_epi32(_mm256_add_epi32(ii, i1i), _mm256_i32gather_epi32(t.perm, _mm256_add_epi32(jj, j1i), 4)), 4);
+			__m256i gi2 = _mm256_i32gather_epi32(t.permMod12,
+				_mm256_add_epi32(_mm256_add_epi32(ii, oneI), _mm256_i32gather_epi32(t.perm, _mm256_add_epi32(jj, oneI), 4)), 4);
+
+			__m256 n0 = contribution2AVX2(radius, x0, y0, _mm256_i32gather_ps(t.gradX, gi0, 4), _mm256_i32gather_ps(t.gradY, gi0, 4));
+			__m256 n1 = contribution2AVX2(radius, x1, y1, _mm256_i32gather_ps(t.gradX, gi1, 4), _mm256_i32gather_ps(t.gradY, gi1, 4));
+			__m256 n2 = contribution2AVX2(radius, x2, y2, _mm256_i32gather_ps(t.gradX, gi2, 4), _mm256_i32gather_ps(t.gradY, gi2, 4));
+
+			_mm256_storeu_ps(out + n, _mm256_mul_ps(scale, _mm256_add_ps(_mm256_add_ps(n0, n1), n2)));
+		}
+
+		for (; n < count; ++n)
+			out[n] = noise2Scalar(t, x[n], y[n]);
+	}
+
+	/*
+		Name		hash3AVX2
+		Brief		Gathers the gradient index perm[i + perm[j + perm[k]]] % 12 for eight corners
+	*/
+	SIMPLEX_TARGET_AVX2 inline __m256i hash3AVX2(const Tables& t, __m256i i, __m256i j, __m256i k)
+	{
+		__m256i h = _mm256_i32gather_epi32(t.perm, k, 4);
+		h = _mm256_i32gather_epi32(t.perm, _mm256_add_epi32(j, h), 4);
+		return _mm256_i32gather_epi32(t.permMod12, _mm256_add_epi32(i, h), 4);
+	}
+
+	/*
+		Name		noise3AVX2
+		Brief		3D simplex noise eight points at a time, hashing with gathers. The
+					gradient is written to dx, dy and dz when DERIVATIVE is set.
+	*/
+	template <bool DERIVATIVE>
+	SIMPLEX_TARGET_AVX2 void noise3AVX2(const Tables& t, const float* x, const float* y, const float* z, float* out,
+		float* dx, float* dy, float* dz, int count)
+	{
+		const __m256 f3 = _mm256_set1_ps(F3);
+		const __m256 g3 = _mm256_set1_ps(G3);
+		const __m256 g3x2 = _mm256_set1_ps(2.0f * G3);
+		const __m256 g3x3 = _mm256_set1_ps(3.0f * G3);
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 allOnes = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		const __m256 radius = _mm256_set1_ps(0.6f);
+		const __m256 scale = _mm256_set1_ps(32.0f);
+		const __m256i mask255 = _mm256_set1_epi32(255);
+		const __m256i oneI = _mm256_set1_epi32(1);
+
+		int n = 0;
+		for (; n + 8 <= count; n += 8)
+		{
+			__m256 xin = _mm256_loadu_ps(x + n);
+			__m256 yin = _mm256_loadu_ps(y + n);
+			__m256 zin = _mm256_loadu_ps(z + n);
+
+			__m256 s = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(xin, yin), zin), f3);
+			__m256 fi = _mm256_floor_ps(_mm256_add_ps(xin, s));
+			__m256 fj = _mm256_floor_ps(_mm256_add_ps(yin, s));
+			__m256 fk = _mm256_floor_ps(_mm256_add_ps(zin, s));
+			__m256i iv = _mm256_cvttps_epi32(fi);
+			__m256i jv = _mm256_cvttps_epi32(fj);
+			__m256i kv = _mm256_cvttps_epi32(fk);
+			__m256 tt = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_add_epi32(iv, jv), kv)), g3);
+			__m256 x0 = _mm256_sub_ps(xin, _mm256_sub_ps(fi, tt));
+			__m256 y0 = _mm256_sub_ps(yin, _mm256_sub_ps(fj, tt));
+			__m256 z0 = _mm256_sub_ps(zin, _mm256_sub_ps(fk, tt));
+
+			__m256 xy = _mm256_cmp_ps(x0, y0, _CMP_GE_OQ);
+			__m256 xz = _mm256_cmp_ps(x0, z0, _CMP_GE_OQ);
+			__m256 yz = _mm256_cmp_ps(y0, z0, _CMP_GE_OQ);
+			__m256 i1 = _mm256_and_ps(xy, xz);
+			__m256 j1 = _mm256_andnot_ps(xy, yz);
+			__m256 k1 = _mm256_andnot_ps(_mm256_or_ps(xz, yz), allOnes);
+			__m256 i2 = _mm256_or_ps(xy, xz);
+			__m256 j2 = _mm256_or_ps(_mm256_andnot_ps(xy, allOnes), yz);
+			__m256 k2 = _mm256_andnot_ps(_mm256_and_ps(xz, yz), allOnes);
+
+			__m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_and_ps(i1, one)), g3);
+			__m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_and_ps(j1, one)), g3);
+			__m256 z1 = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_and_ps(k1, one)), g3);
+			__m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_and_ps(i2, one)), g3x2);
+			__m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_and_ps(j2, one)), g3x2);
+			__m256 z2 = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_and_ps(k2, one)), g3x2);
+			__m256 x3 = _mm256_add_ps(_mm256_sub_ps(x0, one), g3x3);
+			__m256 y3 = _mm256_add_ps(_mm256_sub_ps(y0, one), g3x3);
+			__m256 z3 = _mm256_add_ps(_mm256_sub_ps(z0, one), g3x3);
+
+			__m256i ii = _mm256_and_si256(iv, mask255);
+			__m256i jj = _mm256_and_si256(jv, mask255);
+			__m256i kk = _mm256_and_si256(kv, mask255);
+
+			__m256i gi0 = hash3AVX2(t, ii, jj, kk);
+			__m256i gi1 = hash3AVX2(t,
+				_mm256_add_epi32(ii, _mm256_and_si256(_mm256_castps_si256(i1), oneI)),
+				_mm256_add_epi32(jj, _mm256_and_si256(_mm256_castps_si256(j1), oneI)),
+				_mm256_add_epi32(kk, _mm256_and_si256(_mm256_castps_si256(k1), oneI)));
+			__m256i gi2 = hash3AVX2(t,
+				_mm256_add_epi32(ii, _mm256_and_si256(_mm256_castps_si256(i2), oneI)),
+				_mm256_add_epi32(jj, _mm256_and_si256(_mm256_castps_si256(j2), oneI)),
+				_mm256_add_epi32(kk, _mm256_and_si256(_mm256_castps_si256(k2), oneI)));
+			__m256i gi3 = hash3AVX2(t, _mm256_add_epi32(ii, oneI), _mm256_add_epi32(jj, oneI), _mm256_add_epi32(kk, oneI));
+
+			__m256 gx0 = _mm256_i32gather_ps(t.gradX, gi0, 4), gy0 = _mm256_i32gather_ps(t.gradY, gi0, 4), gz0 = _mm256_i32gather_ps(t.gradZ, gi0, 4);
+			__m256 gx1 = _mm256_i32gather_ps(t.gradX, gi1, 4), gy1 = _mm256_i32gather_ps(t.gradY, gi1, 4), gz1 = _mm256_i32gather_ps(t.gradZ, gi1, 4);
+			__m256 gx2 = _mm256_i32gather_ps(t.gradX, gi2, 4), gy2 = _mm256_i32gather_ps(t.gradY, gi2, 4), gz2 = _mm256_i32gather_ps(t.gradZ, gi2, 4);
+			__m256 gx3 = _mm256_i32gather_ps(t.gradX, gi3, 4), gy3 = _mm256_i32gather_ps(t.gradY, gi3, 4), gz3 = _mm256_i32gather_ps(t.gradZ, gi3, 4);
+
+			if constexpr (DERIVATIVE)
+			{
+				__m256 value = _mm256_setzero_ps();
+				__m256 gradient[3] = {value, value, value};
+				derivative3AVX2(radius, x0, y0, z0, gx0, gy0, gz0, value, gradient);
+				derivative3AVX2(radius, x1, y1, z1, gx1, gy1, gz1, value, gradient);
+				derivative3AVX2(radius, x2, y2, z2, gx2, gy2, gz2, value, gradient);
+				derivative3AVX2(radius, x3, y3, z3, gx3, gy3, gz3, value, gradient);
+
+				_mm256_storeu_ps(out + n, _mm256_mul_ps(scale, value));
+				_mm256_storeu_ps(dx + n, _mm256_mul_ps(gradient[0], scale));
+				_mm256_storeu_ps(dy + n, _mm256_mul_ps(gradient[1], scale));
+				_mm256_storeu_ps(dz + n, _mm256_mul_ps(gradient[2], scale));
+			}
+			else
+			{
+				__m256 n0 = contribution3AVX2(radius, x0, y0, z0, gx0, gy0, gz0);
+				__m256 n1 = contribution3AVX2(radius, x1, y1, z1, gx1, gy1, gz1);
+				__m256 n2 = contribution3AVX2(radius, x2, y2, z2, gx2, gy2, gz2);
+				__m256 n3 = contribution3AVX2(radius, x3, y3, z3, gx3, gy3, gz3);
+
+				_mm256_storeu_ps(out + n, _mm256_mul_ps(scale, _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(n0, n1), n2), n3)));
+			}
+		}
+
+		if constexpr (DERIVATIVE)
+			noise3DerivativeScalar(t, x + n, y + n, z + n, out + n, dx + n, dy + n, dz + n, count - n);
+		else
+			noise3Scalar(t, x + n, y + n, z + n, out + n, count - n);
+	}
+#endif // SIMPLEX_X86
+}
+
+/*
+	Name		SimplexNoise::getSimdLevel
+	Syntax		SimplexNoise::getSimdLevel()
+	Return		SimplexNoise::SimdLevel - The level the batch functions currently use
+	Brief		Returns the instruction set used by the batch functions
+*/
+SimplexNoise::SimdLevel SimplexNoise::getSimdLevel()
+{
+	return currentLevel;
+}
+
+/*
+	Name		SimplexNoise::getSupportedSimdLevel
+	Syntax		SimplexNoise::getSupportedSimdLevel()
+	Return		SimplexNoise::SimdLevel - The best level the CPU supports
+	Brief		Returns the level detected at start up
+*/
+SimplexNoise::SimdLevel SimplexNoise::getSupportedSimdLevel()
+{
+	return supportedLevel;
+}
+
+/*
+	Name		SimplexNoise::setSimdLevel
+	Syntax		SimplexNoise::setSimdLevel(SimdLevel level)
+	Param		SimdLevel level - The level to use, clamped to what the CPU supports
+	Brief		Overrides the detected level, e.g. to compare kernels. Not to be called
+				while other threads are generating noise.
+*/
+void SimplexNoise::setSimdLevel(SimdLevel level)
+{
+	currentLevel = (level > supportedLevel) ? supportedLevel : level;
+}
+
+/*
+	Name		Generator::noise2
+	Syntax		Generator::noise2(const float* x, const float* y, float* out, int count)
+	Param		const float* x - The input x positions
+	Param		const float* y - The input y positions
+	Param		float* out - Receives count noise values
+	Param		int count - The number of points
+	Brief		Generates 2D simplex noise values for an array of points
+*/
+void SimplexNoise::Generator::noise2(const float* x, const float* y, float* out, int count) const
+{
+	Tables t(*this);
+	switch (currentLevel)
+	{
+#if defined(SIMPLEX_X86)
+	case SIMD_AVX2:
+		noise2AVX2(t, x, y, out, count);
+		break;
+	case SIMD_SSE2:
+		noise2SSE2(t, x, y, out, count);
+		break;
+#endif
+	default:
+		noise2Scalar(t, x, y, out, count);
+		break;
+	}
+}
+
+/*
+	Name		Generator::noise3
+	Syntax		Generator::noise3(const float* x, const float* y, const float* z, float* out, int count)
+	Brief		Generates 3D simplex noise values for an array of points
+*/
+void SimplexNoise::Generator::noise3(const float* x, const float* y, const float* z, float* out, int count) const
+{
+	Tables t(*this);
+	switch (currentLevel)
+	{
+#if defined(SIMPLEX_X86)
+	case SIMD_AVX2:
+		noise3AVX2<false>(t, x, y, z, out, 0, 0, 0, count);
+		break;
+	case SIMD_SSE2:
+		noise3SSE2<false>(t, x, y, z, out, 0, 0, 0, count);
+		break;
+#endif
+	default:
+		noise3Scalar(t, x, y, z, out, count);
+		break;
+	}
+}
+
+/*
+	Name		Generator::noise3Derivative
+	Syntax		Generator::noise3Derivative(const float* x, const float* y, const float* z, float* out,
+											float* dx, float* dy, float* dz, int count)
+	Param		const float* x, y, z - The input positions
+	Param		float* out - Receives count noise values, the same as noise3 gives
+	Param		float* dx, dy, dz - Receive the partial derivatives of the noise
+	Param		int count - The number of points
+	Brief		Generates 3D simplex noise values and their analytic gradients for an
+				array of points, at little more than the cost of the values alone
+*/
+void SimplexNoise::Generator::noise3Derivative(const float* x, const float* y, const float* z, float* out,
+	float* dx, float* dy, float* dz, int count) const
+{
+	Tables t(*this);
+	switch (currentLevel)
+	{
+#if defined(SIMPLEX_X86)
+	case SIMD_AVX2:
+		noise3AVX2<true>(t, x, y, z, out, dx, dy, dz, count);
+		break;
+	case SIMD_SSE2:
+		noise3SSE2<true>(t, x, y, z, out, dx, dy, dz, count);
+		break;
+#endif
+	default:
+		noise3DerivativeScalar(t, x, y, z, out, dx, dy, dz, count);
+		break;
+	}
+}
+
+/*
+	Name		Generator::periodicNoise3
+	Syntax		Generator::periodicNoise3(const float* x, const float* y, const float* z, float* out, int count,
+										  int periodX, int periodY, int periodZ)
+	Param		const float* x, y, z - The input positions
+	Param		float* out - Receives count noise values
+	Param		int count - The number of points
+	Param		int periodX, periodY, periodZ - The periods, rounded up to multiples of 3
+	Brief		Generates periodic 3D simplex noise values for an array of points. This
+				is only used to build small tiles once, so it runs the scalar kernel.
+*/
+void SimplexNoise::Generator::periodicNoise3(const float* x, const float* y, const float* z, float* out, int count,
+	int periodX, int periodY, int periodZ) const
+{
+	int period[3] = {getValidPeriod(periodX), getValidPeriod(periodY), getValidPeriod(periodZ)};
+	for (int n = 0; n < count; ++n)
+	{
+		float in[3] = {x[n], y[n], z[n]};
+		out[n] = periodicSimplexNoise<float>(in, period, perm_);
+	}
+}
+
+/*
+	Name		Generator::noiseLattice2
+	Syntax		Generator::noiseLattice2(float originX, float originY, float stepX, float stepY,
+										 int rows, int columns, float* out)
+	Param		float originX, originY - The position of the first sample
+	Param		float stepX - Change in x between rows
+	Param		float stepY - Change in y between columns
+	Param		int rows, columns - The size of the lattice
+	Param		float* out - Receives rows * columns values
+	Brief		Generates 2D noise over a regular lattice, out[r * columns + c] is the noise
+				at (originX + r * stepX, originY + c * stepY)
+*/
+void SimplexNoise::Generator::noiseLattice2(float originX, float originY, float stepX, float stepY, int rows, int columns, float* out) const
+{
+	float xs[LATTICE_CHUNK];
+	float ys[LATTICE_CHUNK];
+
+	for (int r = 0; r < rows; ++r)
+	{
+		float x = originX + r * stepX;
+		for (int c = 0; c < columns; c += LATTICE_CHUNK)
+		{
+			int count = (columns - c < LATTICE_CHUNK) ? columns - c : LATTICE_CHUNK;
+			for (int n = 0; n < count; ++n)
+			{
+				xs[n] = x;
+				ys[n] = originY + (c + n) * stepY;
+			}
+			noise2(xs, ys, out + r * columns + c, count);
+		}
+	}
+}
+
+/*
+	Name		Generator::noiseLattice3
+	Syntax		Generator::noiseLattice3(float originX, float originY, float z, float stepX, float stepY,
+										 int rows, int columns, float* out)
+	Brief		Generates 3D noise over a lattice in the plane at z, laid out as noiseLattice2
+*/
+void SimplexNoise::Generator::noiseLattice3(float originX, float originY, float z, float stepX, float stepY, int rows, int columns, float* out) const
+{
+	float xs[LATTICE_CHUNK];
+	float ys[LATTICE_CHUNK];
+	float zs[LATTICE_CHUNK];
+
+	for (int n = 0; n < LATTICE_CHUNK; ++n)
+		zs[n] = z;
+
+	for (int r = 0; r < rows; ++r)
+	{
+		float x = originX + r * stepX;
+		for (int c = 0; c < columns; c += LATTICE_CHUNK)
+		{
+			int count = (columns - c < LATTICE_CHUNK) ? columns - c : LATTICE_CHUNK;
+			for (int n = 0; n < count; ++n)
+			{
+				xs[n] = x;
+				ys[n] = originY + (c + n) * stepY;
+			}
+			noise3(xs, ys, zs, out + r * columns + c, count);
+		}
+	}
+}
+
+/*
+	Name		SimplexNoise::noise2
+	Syntax		SimplexNoise::noise2(const float* x, const float* y, float* out, int count)
+	Brief		Generates 2D simplex noise values for an array of points with the default
+				generator
+*/
+void SimplexNoise::noise2(const float* x, const float* y, float* out, int count)
+{
+	getDefaultGenerator().noise2(x, y, out, count);
+}
+
+/*
+	Name		SimplexNoise::noise3
+	Syntax		SimplexNoise::noise3(const float* x, const float* y, const float* z, float* out, int count)
+	Brief		Generates 3D simplex noise values for an array of points with the default
+				generator
+*/
+void SimplexNoise::noise3(const float* x, const float* y, const float* z, float* out, int count)
+{
+	getDefaultGenerator().noise3(x, y, z, out, count);
+}
+
+/*
+	Name		SimplexNoise::noise3Derivative
+	Syntax		SimplexNoise::noise3Derivative(const float* x, const float* y, const float* z, float* out,
+											   float* dx, float* dy, float* dz, int count)
+	Brief		Generates 3D simplex noise values and gradients with the default generator
+*/
+void SimplexNoise::noise3Derivative(const float* x, const float* y, const float* z, float* out,
+	float* dx, float* dy, float* dz, int count)
+{
+	getDefaultGenerator().noise3Derivative(x, y, z, out, dx, dy, dz, count);
+}
+
+/*
+	Name		SimplexNoise::noiseLattice2
+	Syntax		SimplexNoise::noiseLattice2(float originX, float originY, float stepX, float stepY,
+											int rows, int columns, float* out)
+	Brief		Generates 2D noise over a regular lattice with the default generator
+*/
+void SimplexNoise::noiseLattice2(float originX, float originY, float stepX, float stepY, int rows, int columns, float* out)
+{
+	getDefaultGenerator().noiseLattice2(originX, originY, stepX, stepY, rows, columns, out);
+}
+
+/*
+	Name		SimplexNoise::noiseLattice3
+	Syntax		SimplexNoise::noiseLattice3(float originX, float originY, float z, float stepX, float stepY,
+											int rows, int columns, float* out)
+	Brief		Generates 3D noise over a lattice in the plane at z with the default generator
+*/
+void SimplexNoise::noiseLattice3(float originX, float originY, float z, float stepX, float stepY, int rows, int columns, float* out)
+{
+	getDefaultGenerator().noiseLattice3(originX, originY, z, stepX, stepY, rows, columns, out);
+}
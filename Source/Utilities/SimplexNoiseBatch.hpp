@@ -0,0 +1,40 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*	
+	Name		Simplex Noise Batch
+	Brief		Declaration of the batched simplex noise functions. These evaluate
+				many points per call using SSE2 or AVX2 kernels, selected at runtime,
+				with a scalar fallback. All paths evaluate in single precision with
+				the same operation order so every level returns identical values.
+				The free functions use the default generator, see Generator for
+				seeded versions.
+*/
+
+#ifndef SIMPLEXNOISEBATCH_H
+#define SIMPLEXNOISEBATCH_H
+
+namespace SimplexNoise
+{
+	enum SimdLevel
+	{
+		SIMD_SCALAR,
+		SIMD_SSE2,
+		SIMD_AVX2,
+	};
+
+	SimdLevel getSimdLevel();
+	SimdLevel getSupportedSimdLevel();
+	void setSimdLevel(SimdLevel level);
+
+	void noise2(const float* x, const float* y, float* out, int count);
+	void noise3(const float* x, const float* y, const float* z, float* out, int count);
+	void noise3Derivative(const float* x, const float* y, const float* z, float* out,
+		float* dx, float* dy, float* dz, int count);
+
+	void noiseLattice2(float originX, float originY, float stepX, float stepY, int rows, int columns, float* out);
+	void noiseLattice3(float originX, float originY, float z, float stepX, float stepY, int rows, int columns, float* out);
+};
+
+#endif // SIMPLEXNOISEBATCH_H
@@ -0,0 +1,360 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Simplex Noise Generator
+	Brief		Definition of the Generator class
+*/
+
+#include "Utilities/SimplexNoiseGenerator.hpp"
+#include "Utilities/SimplexNoiseKernels.hpp"
+#include "Utilities/SimplexNoiseTables.hpp"
+
+/*
+	Name		Generator::Generator
+	Syntax		Generator(unsigned int seed)
+	Param		unsigned int seed - The seed for the permutation table
+	Brief		Builds the permutation tables for the given seed
+*/
+SimplexNoise::Generator::Generator(unsigned int seed)
+{
+	setSeed(seed);
+}
+
+/*
+	Name		Generator::setSeed
+	Syntax		Generator::setSeed(unsigned int seed)
+	Param		unsigned int seed - The seed for the permutation table
+	Brief		Rebuilds the permutation tables by shuffling the reference permutation
+				with a generator local LCG. Seed 0 leaves the reference order in place.
+				Must not be called while another thread is using this generator.
+*/
+void SimplexNoise::Generator::setSeed(unsigned int seed)
+{
+	seed_ = seed;
+
+	int shuffled[256];
+	for (int i = 0; i < 256; ++i)
+	{
+		shuffled[i] = p[i];
+	}
+
+	if (seed != DEFAULT_SEED)
+	{
+		// Fisher-Yates shuffle
+		unsigned int state = seed;
+		for (int i = 255; i > 0; --i)
+		{
+			state = state * 1664525u + 1013904223u;
+			int j = (int)((state >> 8) % (unsigned int)(i + 1));
+			int swap = shuffled[i];
+			shuffled[i] = shuffled[j];
+			shuffled[j] = swap;
+		}
+	}
+
+	for (int i = 0; i < 512; ++i)
+	{
+		perm_[i] = shuffled[i & 255];
+		permMod12_[i] = perm_[i] % 12;
+	}
+}
+
+/*
+	Name		Generator::getSeed
+	Syntax		Generator::getSeed()
+	Return		unsigned int - The seed the tables were built from
+*/
+unsigned int SimplexNoise::Generator::getSeed() const
+{
+	return seed_;
+}
+
+/*
+	Name		Generator::getPermutation
+	Syntax		Generator::getPermutation()
+	Return		const int* - The 512 entry doubled permutation table
+*/
+const int* SimplexNoise::Generator::getPermutation() const
+{
+	return perm_;
+}
+
+/*
+	Name		Generator::getPermutationMod12
+	Syntax		Generator::getPermutationMod12()
+	Return		const int* - The doubled permutation table reduced modulo 12
+	Brief		Lets the batch kernels look up 3D gradient indices without a divide
+*/
+const int* SimplexNoise::Generator::getPermutationMod12() const
+{
+	return permMod12_;
+}
+
+/*
+	Name		Generator::noise
+	Syntax		Generator::noise(double xin, double yin)
+	Return		double - Generated noise value
+	Brief		Generates a 2D gradient noise value
+*/
+double SimplexNoise::Generator::noise(double xin, double yin) const
+{
+	double in[2] = {xin, yin};
+	return simplexNoise<double, 2>(in, perm_);
+}
+
+/*
+	Name		Generator::noise
+	Syntax		Generator::noise(double xin, double yin, double zin)
+	Return		double - Generated noise value
+	Brief		Generates a 3D gradient noise value
+*/
+double SimplexNoise::Generator::noise(double xin, double yin, double zin) const
+{
+	double in[3] = {xin, yin, zin};
+	return simplexNoise<double, 3>(in, perm_);
+}
+
+/*
+	Name		Generator::noise
+	Syntax		Generator::noise(double xin, double yin, double zin, double win)
+	Return		double - Generated noise value
+	Brief		Generates a 4D gradient noise value
+*/
+double SimplexNoise::Generator::noise(double xin, double yin, double zin, double win) const
+{
+	double in[4] = {xin, yin, zin, win};
+	return simplexNoise<double, 4>(in, perm_);
+}
+
+/*
+	Name		Generator::noiseDerivative
+	Syntax		Generator::noiseDerivative(double xin, double yin, double* gradient)
+	Param		double* gradient - Receives the 2 partial derivatives
+	Return		double - Generated noise value, the same as noise gives
+	Brief		Generates a 2D gradient noise value and its analytic gradient
+*/
+double SimplexNoise::Generator::noiseDerivative(double xin, double yin, double* gradient) const
+{
+	double in[2] = {xin, yin};
+	return simplexNoiseDerivative<double, 2>(in, perm_, gradient);
+}
+
+/*
+	Name		Generator::noiseDerivative
+	Syntax		Generator::noiseDerivative(double xin, double yin, double zin, double* gradient)
+	Param		double* gradient - Receives the 3 partial derivatives
+	Return		double - Generated noise value, the same as noise gives
+	Brief		Generates a 3D gradient noise value and its analytic gradient
+*/
+double SimplexNoise::Generator::noiseDerivative(double xin, double yin, double zin, double* gradient) const
+{
+	double in[3] = {xin, yin, zin};
+	return simplexNoiseDerivative<double, 3>(in, perm_, gradient);
+}
+
+/*
+	Name		Generator::fBm
+	Syntax		Generator::fBm(double xin, double yin, int octaves, float lacunarity, float gain)
+	Brief		2D Fractal Brownian motion
+*/
+double SimplexNoise::Generator::fBm(double xin, double yin, int octaves, float lacunarity, float gain) const
+{
+	double in[2] = {xin, yin};
+	return SimplexNoise::fBm<double, 2>(in, perm_, octaves, lacunarity, gain);
+}
+
+/*
+	Name		Generator::fBm
+	Syntax		Generator::fBm(double xin, double yin, double zin, int octaves, float lacunarity, float gain)
+	Brief		3D Fractal Brownian motion
+*/
+double SimplexNoise::Generator::fBm(double xin, double yin, double zin, int octaves, float lacunarity, float gain) const
+{
+	double in[3] = {xin, yin, zin};
+	return SimplexNoise::fBm<double, 3>(in, perm_, octaves, lacunarity, gain);
+}
+
+/*
+	Name		Generator::fBm
+	Syntax		Generator::fBm(double xin, double yin, double zin, double win, int octaves, float lacunarity, float gain)
+	Brief		4D Fractal Brownian motion
+*/
+double SimplexNoise::Generator::fBm(double xin, double yin, double zin, double win, int octaves, float lacunarity, float gain) const
+{
+	double in[4] = {xin, yin, zin, win};
+	return SimplexNoise::fBm<double, 4>(in, perm_, octaves, lacunarity, gain);
+}
+
+/*
+	Name		Generator::fBmDerivative
+	Syntax		Generator::fBmDerivative(double xin, double yin, double* gradient, int octaves,
+										 float lacunarity, float gain)
+	Brief		2D Fractal Brownian motion and its analytic gradient
+*/
+double SimplexNoise::Generator::fBmDerivative(double xin, double yin, double* gradient, int octaves, float lacunarity, float gain) const
+{
+	double in[2] = {xin, yin};
+	return SimplexNoise::fBmDerivative<double, 2>(in, perm_, octaves, lacunarity, gain, gradient);
+}
+
+/*
+	Name		Generator::fBmDerivative
+	Syntax		Generator::fBmDerivative(double xin, double yin, double zin, double* gradient, int octaves,
+										 float lacunarity, float gain)
+	Brief		3D Fractal Brownian motion and its analytic gradient
+*/
+double SimplexNoise::Generator::fBmDerivative(double xin, double yin, double zin, double* gradient, int octaves, float lacunarity, float gain) const
+{
+	double in[3] = {xin, yin, zin};
+	return SimplexNoise::fBmDerivative<double, 3>(in, perm_, octaves, lacunarity, gain, gradient);
+}
+
+/*
+	Name		Generator::turbulence
+	Syntax		Generator::turbulence(double xin, double yin, int octaves, float lacunarity, float gain)
+	Brief		2D abs fBm - turbulence
+*/
+double SimplexNoise::Generator::turbulence(double xin, double yin, int octaves, float lacunarity, float gain) const
+{
+	double in[2] = {xin, yin};
+	return SimplexNoise::turbulence<double, 2>(in, perm_, octaves, lacunarity, gain);
+}
+
+/*
+	Name		Generator::turbulence
+	Syntax		Generator::turbulence(double xin, double yin, double zin, int octaves, float lacunarity, float gain)
+	Brief		3D abs fBm - turbulence
+*/
+double SimplexNoise::Generator::turbulence(double xin, double yin, double zin, int octaves, float lacunarity, float gain) const
+{
+	double in[3] = {xin, yin, zin};
+	return SimplexNoise::turbulence<double, 3>(in, perm_, octaves, lacunarity, gain);
+}
+
+/*
+	Name		Generator::turbulence
+	Syntax		Generator::turbulence(double xin, double yin, double zin, double win, int octaves, float lacunarity, float gain)
+	Brief		4D abs fBm - turbulence
+*/
+double SimplexNoise::Generator::turbulence(double xin, double yin, double zin, double win, int octaves, float lacunarity, float gain) const
+{
+	double in[4] = {xin, yin, zin, win};
+	return SimplexNoise::turbulence<double, 4>(in, perm_, octaves, lacunarity, gain);
+}
+
+/*
+	Name		Generator::ridgedMultifractal
+	Syntax		Generator::ridgedMultifractal(double xin, double yin, int octaves, float lacunarity, float gain, float offset)
+	Brief		Generates 2D gradiated and ridged multifractal noise values
+*/
+double SimplexNoise::Generator::ridgedMultifractal(double xin, double yin, int octaves, float lacunarity, float gain, float offset) const
+{
+	double in[2] = {xin, yin};
+	return SimplexNoise::ridgedMultifractal<double, 2>(in, perm_, octaves, lacunarity, gain, offset);
+}
+
+/*
+	Name		Generator::ridgedMultifractal
+	Syntax		Generator::ridgedMultifractal(double xin, double yin, double zin, int octaves, float lacunarity, float gain, float offset)
+	Brief		Generates 3D gradiated and ridged multifractal noise values
+*/
+double SimplexNoise::Generator::ridgedMultifractal(double xin, double yin, double zin, int octaves, float lacunarity, float gain, float offset) const
+{
+	double in[3] = {xin, yin, zin};
+	return SimplexNoise::ridgedMultifractal<double, 3>(in, perm_, octaves, lacunarity, gain, offset);
+}
+
+/*
+	Name		Generator::ridgedMultifractal
+	Syntax		Generator::ridgedMultifractal(double xin, double yin, double zin, double win, int octaves, float lacunarity, float gain, float offset)
+	Brief		Generates 4D gradiated and ridged multifractal noise values
+*/
+double SimplexNoise::Generator::ridgedMultifractal(double xin, double yin, double zin, double win, int octaves, float lacunarity, float gain, float offset) const
+{
+	double in[4] = {xin, yin, zin, win};
+	return SimplexNoise::ridgedMultifractal<double, 4>(in, perm_, octaves, lacunarity, gain, offset);
+}
+
+/*
+	Name		Generator::periodicNoise
+	Syntax		Generator::periodicNoise(double xin, double yin, int periodX, int periodY)
+	Return		double - Generated noise value
+	Brief		Generates a 2D gradient noise value repeating every periodX, periodY.
+				There is no 2D skew that keeps the lattice whole under axis steps,
+				so this is the z = 0 slice of the periodic 3D noise.
+*/
+double SimplexNoise::Generator::periodicNoise(double xin, double yin, int periodX, int periodY) const
+{
+	double in[3] = {xin, yin, 0.0};
+	int period[3] = {getValidPeriod(periodX), getValidPeriod(periodY), getValidPeriod(0)};
+	return periodicSimplexNoise<double>(in, period, perm_);
+}
+
+/*
+	Name		Generator::periodicNoise
+	Syntax		Generator::periodicNoise(double xin, double yin, double zin, int periodX, int periodY, int periodZ)
+	Return		double - Generated noise value
+	Brief		Generates a 3D gradient noise value repeating every periodX, periodY, periodZ
+*/
+double SimplexNoise::Generator::periodicNoise(double xin, double yin, double zin, int periodX, int periodY, int periodZ) const
+{
+	double in[3] = {xin, yin, zin};
+	int period[3] = {getValidPeriod(periodX), getValidPeriod(periodY), getValidPeriod(periodZ)};
+	return periodicSimplexNoise<double>(in, period, perm_);
+}
+
+/*
+	Name		Generator::periodicFBm
+	Syntax		Generator::periodicFBm(double xin, double yin, int periodX, int periodY, int octaves,
+									   int lacunarity, float gain)
+	Brief		2D Fractal Brownian motion repeating every periodX, periodY
+*/
+double SimplexNoise::Generator::periodicFBm(double xin, double yin, int periodX, int periodY, int octaves, int lacunarity, float gain) const
+{
+	double in[3] = {xin, yin, 0.0};
+	int period[3] = {getValidPeriod(periodX), getValidPeriod(periodY), getValidPeriod(0)};
+	return SimplexNoise::periodicFBm<double>(in, period, perm_, octaves, lacunarity, gain);
+}
+
+/*
+	Name		Generator::periodicFBm
+	Syntax		Generator::periodicFBm(double xin, double yin, double zin, int periodX, int periodY, int periodZ,
+									   int octaves, int lacunarity, float gain)
+	Brief		3D Fractal Brownian motion repeating every periodX, periodY, periodZ
+*/
+double SimplexNoise::Generator::periodicFBm(double xin, double yin, double zin, int periodX, int periodY, int periodZ,
+	int octaves, int lacunarity, float gain) const
+{
+	double in[3] = {xin, yin, zin};
+	int period[3] = {getValidPeriod(periodX), getValidPeriod(periodY), getValidPeriod(periodZ)};
+	return SimplexNoise::periodicFBm<double>(in, period, perm_, octaves, lacunarity, gain);
+}
+
+/*
+	Name		SimplexNoise::getDefaultGenerator
+	Syntax		SimplexNoise::getDefaultGenerator()
+	Return		const Generator& - The seed 0 generator
+	Brief		The generator behind the free noise functions. Built on first use, which
+				is thread safe for function local statics.
+*/
+const SimplexNoise::Generator& SimplexNoise::getDefaultGenerator()
+{
+	static const Generator generator;
+	return generator;
+}
+
+/*
+	Name		SimplexNoise::getValidPeriod
+	Syntax		SimplexNoise::getValidPeriod(int period)
+	Param		int period - The period wanted
+	Return		int - The smallest positive multiple of 3 not below period
+	Brief		The periodic noise only repeats exactly for periods that are multiples of 3
+*/
+int SimplexNoise::getValidPeriod(int period)
+{
+	if (period < 3)
+		return 3;
+	return ((period + 2) / 3) * 3;
+}
@@ -0,0 +1,89 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Simplex Noise Generator
+	Brief		Declaration of the Generator class, a seeded simplex noise source
+				owning its own permutation tables. A generator is never modified
+				while generating so one can be shared between threads, and threads
+				wanting different volcanoes each use their own.
+*/
+
+#ifndef SIMPLEXNOISEGENERATOR_H
+#define SIMPLEXNOISEGENERATOR_H
+
+namespace SimplexNoise
+{
+	class Generator
+	{
+	public:
+		// Seed 0 uses the reference permutation and reproduces the original noise
+		static const unsigned int DEFAULT_SEED = 0;
+
+		explicit Generator(unsigned int seed = DEFAULT_SEED);
+
+		void setSeed(unsigned int seed);
+		unsigned int getSeed() const;
+
+		const int* getPermutation() const;
+		const int* getPermutationMod12() const;
+
+		double noise(double xin, double yin) const;
+		double noise(double xin, double yin, double zin) const;
+		double noise(double xin, double yin, double zin, double win) const;
+
+		// Noise and fBm with their analytic gradients, written to gradient[0..N-1]
+		double noiseDerivative(double xin, double yin, double* gradient) const;
+		double noiseDerivative(double xin, double yin, double zin, double* gradient) const;
+
+		double fBm(double xin, double yin, int octaves, float lacunarity = 2.0, float gain = 0.5) const;
+		double fBm(double xin, double yin, double zin, int octaves, float lacunarity = 2.0, float gain = 0.5) const;
+		double fBm(double xin, double yin, double zin, double win, int octaves, float lacunarity = 2.0, float gain = 0.5) const;
+
+		double fBmDerivative(double xin, double yin, double* gradient, int octaves, float lacunarity = 2.0, float gain = 0.5) const;
+		double fBmDerivative(double xin, double yin, double zin, double* gradient, int octaves, float lacunarity = 2.0, float gain = 0.5) const;
+
+		double turbulence(double xin, double yin, int octaves, float lacunarity = 2.0, float gain = 0.5) const;
+		double turbulence(double xin, double yin, double zin, int octaves, float lacunarity = 2.0, float gain = 0.5) const;
+		double turbulence(double xin, double yin, double zin, double win, int octaves, float lacunarity = 2.0, float gain = 0.5) const;
+
+		double ridgedMultifractal(double xin, double yin, int octaves, float lacunarity = 2.0, float gain = 0.5, float offset = 1.0) const;
+		double ridgedMultifractal(double xin, double yin, double zin, int octaves, float lacunarity = 2.0, float gain = 0.5, float offset = 1.0) const;
+		double ridgedMultifractal(double xin, double yin, double zin, double win, int octaves, float lacunarity = 2.0, float gain = 0.5, float offset = 1.0) const;
+
+		// Noise repeating every period units along each axis. Periods are rounded
+		// up to a multiple of 3 and the 2D variants are the z = 0 slice of the 3D
+		// noise, see periodicSimplexNoise.
+		double periodicNoise(double xin, double yin, int periodX, int periodY) const;
+		double periodicNoise(double xin, double yin, double zin, int periodX, int periodY, int periodZ) const;
+
+		double periodicFBm(double xin, double yin, int periodX, int periodY, int octaves, int lacunarity = 2, float gain = 0.5) const;
+		double periodicFBm(double xin, double yin, double zin, int periodX, int periodY, int periodZ,
+			int octaves, int lacunarity = 2, float gain = 0.5) const;
+
+		// Batch functions, defined with the SIMD kernels in SimplexNoiseBatch.cpp
+		void noise2(const float* x, const float* y, float* out, int count) const;
+		void noise3(const float* x, const float* y, const float* z, float* out, int count) const;
+		void noise3Derivative(const float* x, const float* y, const float* z, float* out,
+			float* dx, float* dy, float* dz, int count) const;
+		void periodicNoise3(const float* x, const float* y, const float* z, float* out, int count,
+			int periodX, int periodY, int periodZ) const;
+
+		void noiseLattice2(float originX, float originY, float stepX, float stepY, int rows, int columns, float* out) const;
+		void noiseLattice3(float originX, float originY, float z, float stepX, float stepY, int rows, int columns, float* out) const;
+
+	private:
+		// Doubled so lookups of perm[i + perm[j]] never need wrapping. Cache line
+		// aligned so generators used by different threads never share a line.
+		alignas(64) int perm_[512];
+		alignas(64) int permMod12_[512];
+		unsigned int seed_;
+	};
+
+	const Generator& getDefaultGenerator();
+
+	int getValidPeriod(int period);
+};
+
+#endif // SIMPLEXNOISEGENERATOR_H
@@ -0,0 +1,545 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Simplex Noise Kernels
+	Brief		Simplex noise and fractal sums templated on scalar type and dimension.
+				The double precision SimplexNoise functions are thin wrappers over these,
+				and the float instantiations are the scalar path of the batch functions.
+*/
+
+#ifndef SIMPLEXNOISEKERNELS_H
+#define SIMPLEXNOISEKERNELS_H
+
+#include <cmath>
+
+#include "Utilities/SimplexNoiseTables.hpp"
+
+namespace SimplexNoise
+{
+	/*
+		Name		constSqrt
+		Syntax		SimplexNoise::constSqrt(double x)
+		Brief		Compile time square root by Newton iteration, used for the skew factors
+	*/
+	constexpr double constSqrt(double x)
+	{
+		double guess = x > 1.0 ? x : 1.0;
+		for (int i = 0; i < 64; ++i)
+		{
+			guess = 0.5 * (guess + x / guess);
+		}
+		return guess;
+	}
+
+	/*
+		Name		SimplexConstants
+		Syntax		SimplexNoise::SimplexConstants<T, N>
+		Brief		Skewing and unskewing factors, kernel radius and output scale for an
+					N dimensional simplex grid
+	*/
+	template <typename T, int N>
+	struct SimplexConstants
+	{
+		static_assert(N >= 2 && N <= 4, "Simplex noise is implemented for 2 to 4 dimensions");
+
+		// Skew (x,y,...) onto the hypercubic lattice and unskew back again
+		static constexpr T F = T((constSqrt(N + 1.0) - 1.0) / N);
+		static constexpr T G = T((N + 1.0 - constSqrt(N + 1.0)) / (N * (N + 1.0)));
+
+		// Squared radius of each corner's contribution
+		static constexpr T RADIUS = T(N == 2 ? 0.5 : 0.6);
+
+		// Scales the result to cover [-1,1]
+		static constexpr T SCALE = T(N == 2 ? 70.0 : (N == 3 ? 32.0 : 27.0));
+	};
+
+	/*
+		Name		floorToInt
+		Syntax		SimplexNoise::floorToInt(T x)
+		Return		int - x rounded towards negative infinity
+		Brief		Floor without going through the C library
+	*/
+	template <typename T>
+	inline int floorToInt(T x)
+	{
+		int i = (int)x;
+		return (x < (T)i) ? i - 1 : i;
+	}
+
+	/*
+		Name		gradientDot
+		Syntax		SimplexNoise::gradientDot<T, N>(int hash, const T* x)
+		Return		T - The dot product of the hashed gradient and x
+		Brief		2D and 3D use the 12 cube edge gradients, 4D the 32 hypercube edges
+	*/
+	template <typename T, int N>
+	inline T gradientDot(int hash, const T* x)
+	{
+		if constexpr (N == 4)
+		{
+			const int* g = grad4[hash % 32];
+			return T(g[0])*x[0] + T(g[1])*x[1] + T(g[2])*x[2] + T(g[3])*x[3];
+		}
+		else if constexpr (N == 3)
+		{
+			const int* g = grad3[hash % 12];
+			return T(g[0])*x[0] + T(g[1])*x[1] + T(g[2])*x[2];
+		}
+		else
+		{
+			const int* g = grad3[hash % 12];
+			return T(g[0])*x[0] + T(g[1])*x[1];
+		}
+	}
+
+	/*
+		Name		gradientVector
+		Syntax		SimplexNoise::gradientVector<T, N>(int hash, T* g)
+		Brief		Writes out the hashed gradient used by gradientDot
+	*/
+	template <typename T, int N>
+	inline void gradientVector(int hash, T* g)
+	{
+		const int* v = (N == 4) ? grad4[hash % 32] : grad3[hash % 12];
+		for (int d = 0; d < N; ++d)
+		{
+			g[d] = T(v[d]);
+		}
+	}
+
+	/*
+		Name		simplexNoise
+		Syntax		SimplexNoise::simplexNoise<T, N>(const T* in, const int* perm)
+		Param		const T* in - The N input coordinates
+		Param		const int* perm - A 512 entry (doubled) permutation table
+		Return		T - Generated noise value in [-1,1]
+		Brief		Generates an N dimensional simplex noise value. The corner loops have
+					compile time trip counts so the compiler fully unrolls them.
+	*/
+	template <typename T, int N>
+	T simplexNoise(const T* in, const int* perm)
+	{
+		typedef SimplexConstants<T, N> C;
+
+		// Skew the input space to determine which simplex cell we're in
+		T s = 0;
+		for (int d = 0; d < N; ++d)
+		{
+			s += in[d];
+		}
+		s *= C::F;
+
+		int cell[N];
+		int cellSum = 0;
+		for (int d = 0; d < N; ++d)
+		{
+			cell[d] = floorToInt(in[d] + s);
+			cellSum += cell[d];
+		}
+
+		// Unskew the cell origin back to input space and find the distances from it
+		T t = T(cellSum) * C::G;
+		T x0[N];
+		for (int d = 0; d < N; ++d)
+		{
+			x0[d] = in[d] - (T(cell[d]) - t);
+		}
+
+		// Rank the coordinates by magnitude to find which simplex we are in. The
+		// corner c steps along the c largest coordinates. Ties go to the earlier axis.
+		int rank[N] = {};
+		for (int a = 0; a < N; ++a)
+		{
+			for (int b = a + 1; b < N; ++b)
+			{
+				if (x0[a] >= x0[b])
+					++rank[a];
+				else
+					++rank[b];
+			}
+		}
+
+		T result = 0;
+		for (int c = 0; c <= N; ++c)
+		{
+			int offset[N];
+			T x[N];
+			for (int d = 0; d < N; ++d)
+			{
+				offset[d] = (rank[d] >= N - c) ? 1 : 0;
+				x[d] = x0[d] - T(offset[d]) + T(c) * C::G;
+			}
+
+			// Calculate the contribution from this corner
+			T contribution = C::RADIUS;
+			for (int d = 0; d < N; ++d)
+			{
+				contribution -= x[d] * x[d];
+			}
+			if (contribution > 0)
+			{
+				// Work out the hashed gradient index of the corner
+				int hash = 0;
+				for (int d = N - 1; d >= 0; --d)
+				{
+					hash = perm[(cell[d] & 255) + offset[d] + hash];
+				}
+
+				contribution *= contribution;
+				result += contribution * contribution * gradientDot<T, N>(hash, x);
+			}
+		}
+
+		return C::SCALE * result;
+	}
+
+	/*
+		Name		simplexNoiseDerivative
+		Syntax		SimplexNoise::simplexNoiseDerivative<T, N>(const T* in, const int* perm, T* gradient)
+		Param		const T* in - The N input coordinates
+		Param		const int* perm - A 512 entry (doubled) permutation table
+		Param		T* gradient - Receives the N partial derivatives of the noise at in
+		Return		T - Generated noise value in [-1,1], identical to simplexNoise
+		Brief		Simplex noise with its analytic gradient. Each corner contributes
+					t^4 (g . x) with t = r - |x|^2, whose derivative is
+					t^4 g - 8 t^3 (g . x) x.
+	*/
+	template <typename T, int N>
+	T simplexNoiseDerivative(const T* in, const int* perm, T* gradient)
+	{
+		typedef SimplexConstants<T, N> C;
+
+		T s = 0;
+		for (int d = 0; d < N; ++d)
+		{
+			s += in[d];
+		}
+		s *= C::F;
+
+		int cell[N];
+		int cellSum = 0;
+		for (int d = 0; d < N; ++d)
+		{
+			cell[d] = floorToInt(in[d] + s);
+			cellSum += cell[d];
+		}
+
+		T t = T(cellSum) * C::G;
+		T x0[N];
+		for (int d = 0; d < N; ++d)
+		{
+			x0[d] = in[d] - (T(cell[d]) - t);
+			gradient[d] = 0;
+		}
+
+		int rank[N] = {};
+		for (int a = 0; a < N; ++a)
+		{
+			for (int b = a + 1; b < N; ++b)
+			{
+				if (x0[a] >= x0[b])
+					++rank[a];
+				else
+					++rank[b];
+			}
+		}
+
+		T result = 0;
+		for (int c = 0; c <= N; ++c)
+		{
+			int offset[N];
+			T x[N];
+			for (int d = 0; d < N; ++d)
+			{
+				offset[d] = (rank[d] >= N - c) ? 1 : 0;
+				x[d] = x0[d] - T(offset[d]) + T(c) * C::G;
+			}
+
+			T contribution = C::RADIUS;
+			for (int d = 0; d < N; ++d)
+			{
+				contribution -= x[d] * x[d];
+			}
+			if (contribution > 0)
+			{
+				int hash = 0;
+				for (int d = N - 1; d >= 0; --d)
+				{
+					hash = perm[(cell[d] & 255) + offset[d] + hash];
+				}
+
+				T g[N];
+				gradientVector<T, N>(hash, g);
+
+				T dot = gradientDot<T, N>(hash, x);
+				T t2 = contribution * contribution;
+				T t4 = t2 * t2;
+				result += t4 * dot;
+
+				T falloff = t2 * contribution * dot * T(-8);
+				for (int d = 0; d < N; ++d)
+				{
+					gradient[d] += falloff * x[d] + t4 * g[d];
+				}
+			}
+		}
+
+		for (int d = 0; d < N; ++d)
+		{
+			gradient[d] *= C::SCALE;
+		}
+		return C::SCALE * result;
+	}
+
+	/*
+		Name		periodicSimplexNoise
+		Syntax		SimplexNoise::periodicSimplexNoise<T>(const T* in, const int* period, const int* perm)
+		Param		const T* in - The 3 input coordinates
+		Param		const int* period - The period along each axis, positive multiples of 3
+		Param		const int* perm - A 512 entry (doubled) permutation table
+		Return		T - Generated noise value in [-1,1]
+		Brief		3D simplex noise that repeats every period[d] along axis d. Skewing by
+					1/3 turns a step of 3 along an axis into whole lattice steps, so the
+					lattice maps onto itself and each corner can be wrapped into the
+					first period before hashing. Corners within the kernel radius of a
+					point near a lower face lie below it and are wrapped, so the result
+					only matches simplexNoise more than sqrt(RADIUS) inside every face
+					of the first period.
+	*/
+	template <typename T>
+	T periodicSimplexNoise(const T* in, const int* period, const int* perm)
+	{
+		typedef SimplexConstants<T, 3> C;
+
+		T s = (in[0] + in[1] + in[2]) * C::F;
+
+		int cell[3];
+		int cellSum = 0;
+		for (int d = 0; d < 3; ++d)
+		{
+			cell[d] = floorToInt(in[d] + s);
+			cellSum += cell[d];
+		}
+
+		T t = T(cellSum) * C::G;
+		T x0[3];
+		for (int d = 0; d < 3; ++d)
+		{
+			x0[d] = in[d] - (T(cell[d]) - t);
+		}
+
+		int rank[3] = {};
+		for (int a = 0; a < 3; ++a)
+		{
+			for (int b = a + 1; b < 3; ++b)
+			{
+				if (x0[a] >= x0[b])
+					++rank[a];
+				else
+					++rank[b];
+			}
+		}
+
+		T result = 0;
+		for (int c = 0; c <= 3; ++c)
+		{
+			int corner[3];
+			T x[3];
+			for (int d = 0; d < 3; ++d)
+			{
+				int offset = (rank[d] >= 3 - c) ? 1 : 0;
+				corner[d] = cell[d] + offset;
+				x[d] = x0[d] - T(offset) + T(c) * C::G;
+			}
+
+			T contribution = C::RADIUS - x[0] * x[0] - x[1] * x[1] - x[2] * x[2];
+			if (contribution > 0)
+			{
+				// Six times the unskewed corner position is whole, so the corner is
+				// wrapped with integer arithmetic and skewed back onto the lattice
+				int cornerSum = corner[0] + corner[1] + corner[2];
+				int unskewed[3];
+				for (int d = 0; d < 3; ++d)
+				{
+					int range = 6 * period[d];
+					unskewed[d] = (6 * corner[d] - cornerSum) % range;
+					if (unskewed[d] < 0)
+						unskewed[d] += range;
+				}
+
+				int wrappedSum = (unskewed[0] + unskewed[1] + unskewed[2]) / 3;
+				int hash = 0;
+				for (int d = 2; d >= 0; --d)
+				{
+					hash = perm[(((unskewed[d] + wrappedSum) / 6) & 255) + hash];
+				}
+
+				contribution *= contribution;
+				result += contribution * contribution * gradientDot<T, 3>(hash, x);
+			}
+		}
+
+		return C::SCALE * result;
+	}
+
+	/*
+		Name		periodicFBm
+		Syntax		SimplexNoise::periodicFBm<T>(const T* in, const int* period, const int* perm,
+												 int octaves, int lacunarity, T gain)
+		Brief		3D fractal Brownian motion repeating every period[d] along axis d. The
+					lacunarity is whole so every octave's period is a multiple of the base
+					period.
+	*/
+	template <typename T>
+	T periodicFBm(const T* in, const int* period, const int* perm, int octaves, int lacunarity, T gain)
+	{
+		int frequency = 1;
+		T amplitude = T(0.5);
+		T sum = 0;
+		T p[3];
+		int octavePeriod[3];
+		for (int i = 0; i < octaves; i++)
+		{
+			for (int d = 0; d < 3; ++d)
+			{
+				p[d] = in[d] * T(frequency);
+				octavePeriod[d] = period[d] * frequency;
+			}
+			sum += periodicSimplexNoise<T>(p, octavePeriod, perm) * amplitude;
+			frequency *= lacunarity;
+			amplitude *= gain;
+		}
+		return sum;
+	}
+
+	/*
+		Name		fBm
+		Syntax		SimplexNoise::fBm<T, N>(const T* in, const int* perm, int octaves, T lacunarity, T gain)
+		Brief		N dimensional fractal Brownian motion
+	*/
+	template <typename T, int N>
+	T fBm(const T* in, const int* perm, int octaves, T lacunarity, T gain)
+	{
+		T frequency = 1;
+		T amplitude = T(0.5);
+		T sum = 0;
+		T p[N];
+		for (int i = 0; i < octaves; i++)
+		{
+			for (int d = 0; d < N; ++d)
+			{
+				p[d] = in[d] * frequency;
+			}
+			sum += simplexNoise<T, N>(p, perm) * amplitude;
+			frequency *= lacunarity;
+			amplitude *= gain;
+		}
+		return sum;
+	}
+
+	/*
+		Name		fBmDerivative
+		Syntax		SimplexNoise::fBmDerivative<T, N>(const T* in, const int* perm, int octaves,
+													  T lacunarity, T gain, T* gradient)
+		Brief		N dimensional fractal Brownian motion and its analytic gradient. Each
+					octave's gradient is scaled by its amplitude and frequency.
+	*/
+	template <typename T, int N>
+	T fBmDerivative(const T* in, const int* perm, int octaves, T lacunarity, T gain, T* gradient)
+	{
+		T frequency = 1;
+		T amplitude = T(0.5);
+		T sum = 0;
+		T p[N];
+		T octaveGradient[N];
+		for (int d = 0; d < N; ++d)
+		{
+			gradient[d] = 0;
+		}
+		for (int i = 0; i < octaves; i++)
+		{
+			for (int d = 0; d < N; ++d)
+			{
+				p[d] = in[d] * frequency;
+			}
+			sum += simplexNoiseDerivative<T, N>(p, perm, octaveGradient) * amplitude;
+			for (int d = 0; d < N; ++d)
+			{
+				gradient[d] += octaveGradient[d] * (amplitude * frequency);
+			}
+			frequency *= lacunarity;
+			amplitude *= gain;
+		}
+		return sum;
+	}
+
+	/*
+		Name		turbulence
+		Syntax		SimplexNoise::turbulence<T, N>(const T* in, const int* perm, int octaves, T lacunarity, T gain)
+		Brief		N dimensional abs fBm - turbulence
+	*/
+	template <typename T, int N>
+	T turbulence(const T* in, const int* perm, int octaves, T lacunarity, T gain)
+	{
+		T frequency = 1;
+		T amplitude = 1;
+		T sum = 0;
+		T p[N];
+		for (int i = 0; i < octaves; i++)
+		{
+			for (int d = 0; d < N; ++d)
+			{
+				p[d] = in[d] * frequency;
+			}
+			sum += std::abs(simplexNoise<T, N>(p, perm)) * amplitude;
+			frequency *= lacunarity;
+			amplitude *= gain;
+		}
+		return sum;
+	}
+
+	/*
+		Name		ridge
+		Syntax		SimplexNoise::ridge<T>(T h, T offset)
+		Brief		Generates a ridge value from the given noise (height) and offset
+	*/
+	template <typename T>
+	inline T ridge(T h, T offset)
+	{
+		h = offset - std::abs(h);
+		return h * h;
+	}
+
+	/*
+		Name		ridgedMultifractal
+		Syntax		SimplexNoise::ridgedMultifractal<T, N>(const T* in, const int* perm, int octaves,
+															T lacunarity, T gain, T offset)
+		Brief		N dimensional gradiated and ridged multifractal noise
+	*/
+	template <typename T, int N>
+	T ridgedMultifractal(const T* in, const int* perm, int octaves, T lacunarity, T gain, T offset)
+	{
+		T frequency = 1;
+		T amplitude = T(0.5);
+		T previous = 1;
+		T sum = 0;
+		T p[N];
+		for (int i = 0; i < octaves; i++)
+		{
+			for (int d = 0; d < N; ++d)
+			{
+				p[d] = in[d] * frequency;
+			}
+			T n = ridge<T>(simplexNoise<T, N>(p, perm), offset);
+			sum += n * amplitude * previous;
+			previous = n;
+			frequency *= lacunarity;
+			amplitude *= gain;
+		}
+		return sum;
+	}
+};
+
+#endif // SIMPLEXNOISEKERNELS_H
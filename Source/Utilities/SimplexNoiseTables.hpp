@@ -0,0 +1,24 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*	
+	Name		Simplex Noise Tables
+	Brief		Gradient and permutation tables shared by the CPU simplex noise
+				implementations, defined once in SimplexNoiseTables.cpp
+*/
+
+#ifndef SIMPLEXNOISETABLES_H
+#define SIMPLEXNOISETABLES_H
+
+namespace SimplexNoise
+{
+	// Gradients for 2D/3D (the 12 cube edges) and 4D (the 32 hypercube edges)
+	extern const int grad3[12][3];
+	extern const int grad4[32][4];
+
+	// Ken Perlin's reference permutation, used when a generator has seed 0
+	extern const int p[256];
+};
+
+#endif // SIMPLEXNOISETABLES_H
@@ -0,0 +1,99 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Slice Scheduler
+	Brief		Definition of SliceScheduler Class
+*/
+
+#include <chrono>
+
+#include "Utilities/SliceScheduler.hpp"
+
+/*
+	Name		SliceScheduler::SliceScheduler
+	Syntax		SliceScheduler()
+	Brief		SliceScheduler constructor
+*/
+SliceScheduler::SliceScheduler()
+: finished_(0)
+{
+
+}
+
+/*
+	Name		SliceScheduler::add
+	Syntax		SliceScheduler::add(const char* name, const Slice& slice)
+	Param		const char* name - A name for the task, kept as given
+	Param		const Slice& slice - Called until it returns 1
+	Brief		Adds a task after the ones already waiting
+*/
+void SliceScheduler::add(const char* name, const Slice& slice)
+{
+	Task task;
+	task.name = name;
+	task.slice = slice;
+	task.progress = 0.0f;
+	tasks_.push_back(task);
+}
+
+/*
+	Name		SliceScheduler::run
+	Syntax		SliceScheduler::run(float budget)
+	Param		float budget - Milliseconds to spend
+	Return		float - The milliseconds spent
+	Brief		Runs slices until the budget is used up or every task has finished.
+				At least one slice is run, so the tasks always move on however small
+				the budget. A slice is never cut short, so the budget is overrun by
+				up to one slice.
+*/
+float SliceScheduler::run(float budget)
+{
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+	float spent = 0.0f;
+
+	while (!tasks_.empty())
+	{
+		Task& task = tasks_.front();
+		task.progress = task.slice();
+		if (task.progress >= 1.0f)
+		{
+			tasks_.pop_front();
+			++finished_;
+		}
+
+		spent = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+		if (spent >= budget)
+			break;
+	}
+
+	return spent;
+}
+
+/*
+	Name		SliceScheduler::clear
+	Syntax		SliceScheduler::clear()
+	Brief		Drops every task waiting, finished or not
+*/
+void SliceScheduler::clear()
+{
+	tasks_.clear();
+	finished_ = 0;
+}
+
+/*
+	Name		SliceScheduler::getProgress
+	Syntax		SliceScheduler::getProgress()
+	Return		float - How much of the tasks added since the last clear is done, from
+				0 to 1, counting each task the same
+*/
+float SliceScheduler::getProgress() const
+{
+	int count = finished_ + (int)tasks_.size();
+	if (count == 0)
+		return 1.0f;
+
+	return (finished_ + getCurrentProgress()) / count;
+}
@@ -0,0 +1,52 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Slice Scheduler
+	Brief		Declaration of SliceScheduler Class, which runs long tasks a slice at a
+				time on the thread calling run, for as many slices as fit in a time
+				budget. A task is a function that does a bounded piece of its work
+				each call and keeps its place between calls, so a frame spends no
+				more than the budget on it however big the task is. Tasks run one
+				after another in the order they were added.
+*/
+
+#ifndef SLICESCHEDULER_H
+#define SLICESCHEDULER_H
+
+#include <deque>
+#include <functional>
+
+class SliceScheduler
+{
+public:
+	// Runs the next slice of a task and returns how much of the task is done,
+	// 1 once it has finished
+	typedef std::function<float()> Slice;
+
+	SliceScheduler();
+
+	void add(const char* name, const Slice& slice);
+	float run(float budget);
+	void clear();
+
+	bool isIdle() const { return tasks_.empty(); };
+	const char* getCurrent() const { return tasks_.empty() ? 0 : tasks_.front().name; };
+	int getNumFinished() const { return finished_; };
+	float getCurrentProgress() const { return tasks_.empty() ? 0.0f : tasks_.front().progress; };
+	float getProgress() const;
+
+private:
+	struct Task
+	{
+		const char* name;
+		Slice slice;
+		float progress;
+	};
+
+	std::deque<Task> tasks_;
+	int finished_;			// Tasks finished since the last clear
+};
+
+#endif // SLICESCHEDULER_H
@@ -0,0 +1,143 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Stage Task
+	Brief		Definition of StageTask Class
+*/
+
+#include <memory>
+#include <utility>
+
+#include "Utilities/StageTask.hpp"
+
+/*
+	Name		StageTask::StageTask
+	Syntax		StageTask()
+	Brief		An empty task, already finished
+*/
+StageTask::StageTask()
+{
+
+}
+
+/*
+	Name		StageTask::StageTask
+	Syntax		StageTask(std::coroutine_handle<promise_type> handle)
+	Param		std::coroutine_handle<promise_type> handle - The suspended coroutine,
+				owned by the task from now on
+*/
+StageTask::StageTask(std::coroutine_handle<promise_type> handle)
+: handle_(handle)
+{
+
+}
+
+/*
+	Name		StageTask::StageTask
+	Syntax		StageTask(StageTask&& other)
+	Param		StageTask&& other - A task, left empty
+*/
+StageTask::StageTask(StageTask&& other)
+: handle_(other.handle_)
+{
+	other.handle_ = std::coroutine_handle<promise_type>();
+}
+
+/*
+	Name		StageTask::operator=
+	Syntax		StageTask::operator=(StageTask&& other)
+	Param		StageTask&& other - A task, left empty
+	Return		StageTask& - This task, having destroyed the coroutine it held
+*/
+StageTask& StageTask::operator=(StageTask&& other)
+{
+	if (this != &other)
+	{
+		if (handle_)
+			handle_.destroy();
+		handle_ = other.handle_;
+		other.handle_ = std::coroutine_handle<promise_type>();
+	}
+	return *this;
+}
+
+/*
+	Name		StageTask::~StageTask
+	Syntax		~StageTask()
+	Brief		Destroys the coroutine, finished or not. An unfinished stage leaves
+				the work it has done so far.
+*/
+StageTask::~StageTask()
+{
+	if (handle_)
+		handle_.destroy();
+}
+
+/*
+	Name		StageTask::resume
+	Syntax		StageTask::resume()
+	Return		bool - False once the stage has finished
+	Brief		Runs the stage until it next yields or finishes
+*/
+bool StageTask::resume()
+{
+	if (isFinished())
+		return false;
+
+	handle_.resume();
+	return !handle_.done();
+}
+
+/*
+	Name		StageTask::run
+	Syntax		StageTask::run()
+	Brief		Runs the rest of the stage without stopping, as on a worker
+*/
+void StageTask::run()
+{
+	bool isRunning = true;
+	while (isRunning)
+	{
+		isRunning = resume();
+	}
+}
+
+/*
+	Name		StageTask::run
+	Syntax		StageTask::run(const std::atomic<bool>& isCancelled)
+	Param		const std::atomic<bool>& isCancelled - Checked after each yield
+	Brief		Runs the rest of the stage, stopping at the next yield once the flag
+				is set. A stage stopped early leaves the work done so far.
+*/
+void StageTask::run(const std::atomic<bool>& isCancelled)
+{
+	bool isRunning = true;
+	while (isRunning && !isCancelled)
+	{
+		isRunning = resume();
+	}
+}
+
+/*
+	Name		StageTask::toSlice
+	Syntax		StageTask::toSlice(StageTask&& task)
+	Param		StageTask&& task - The task, taken over by the slice
+	Return		SliceScheduler::Slice - Resumes the task once each call. Only reports
+				1 once the coroutine has returned, so the scheduler never drops it
+				before the code after its last yield has run.
+*/
+SliceScheduler::Slice StageTask::toSlice(StageTask&& task)
+{
+	// Slices are copied, so the task is shared between the copies
+	std::shared_ptr<StageTask> shared(new StageTask(std::move(task)));
+	return [shared]() -> float
+	{
+		if (!shared->resume())
+			return 1.0f;
+
+		float progress = shared->getProgress();
+		return progress < 0.99f ? progress : 0.99f;
+	};
+}
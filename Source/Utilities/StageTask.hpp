@@ -0,0 +1,64 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Stage Task
+	Brief		Declaration of StageTask Class, a generation stage written as a C++20
+				coroutine. The stage is written as one loop and co_yields its progress
+				after each bounded piece of work, keeping its locals between resumes,
+				so it can be run across frames without being turned into a state
+				machine by hand. It starts suspended and may be resumed from any
+				thread, one at a time.
+*/
+
+#ifndef STAGETASK_H
+#define STAGETASK_H
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+
+#include "Utilities/SliceScheduler.hpp"
+
+class StageTask
+{
+public:
+	/*
+		Name		promise_type
+		Brief		The coroutine's side of the task, holding the progress last yielded
+	*/
+	struct promise_type
+	{
+		float progress;
+
+		StageTask get_return_object() { return StageTask(std::coroutine_handle<promise_type>::from_promise(*this)); };
+		std::suspend_always initial_suspend() { progress = 0.0f; return std::suspend_always(); };
+		std::suspend_always final_suspend() noexcept { progress = 1.0f; return std::suspend_always(); };
+		std::suspend_always yield_value(float value) { progress = value; return std::suspend_always(); };
+		void return_void() {};
+		void unhandled_exception() { std::terminate(); };
+	};
+
+	StageTask();
+	StageTask(StageTask&& other);
+	StageTask& operator=(StageTask&& other);
+	~StageTask();
+
+	bool resume();
+	void run();
+	void run(const std::atomic<bool>& isCancelled);
+	bool isFinished() const { return !handle_ || handle_.done(); };
+	float getProgress() const { return handle_ ? handle_.promise().progress : 1.0f; };
+
+	static SliceScheduler::Slice toSlice(StageTask&& task);
+
+private:
+	explicit StageTask(std::coroutine_handle<promise_type> handle);
+	StageTask(const StageTask&);
+	StageTask& operator=(const StageTask&);
+
+	std::coroutine_handle<promise_type> handle_;
+};
+
+#endif // STAGETASK_H
@@ -0,0 +1,214 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Task Graph
+	Brief		Definition of TaskGraph Class
+*/
+
+#include "Utilities/TaskGraph.hpp"
+
+/*
+	Name		TaskGraph::TaskGraph
+	Syntax		TaskGraph(WorkerPool* pool)
+	Param		WorkerPool* pool - Pool to run the nodes on, or 0 to run each one as
+				it is started, in the order they were added
+	Brief		TaskGraph constructor
+*/
+TaskGraph::TaskGraph(WorkerPool* pool)
+: pool_(pool), isCancelled_(false)
+{
+
+}
+
+/*
+	Name		TaskGraph::~TaskGraph
+	Syntax		~TaskGraph()
+	Brief		Waits for any nodes still running, as their actions may use the owner
+*/
+TaskGraph::~TaskGraph()
+{
+	wait();
+}
+
+/*
+	Name		TaskGraph::addNode
+	Syntax		TaskGraph::addNode(const char* name, unsigned int reads, unsigned int writes,
+								   const std::function<void()>& action, unsigned int flags)
+	Param		const char* name - A name for the node, kept as given
+	Param		unsigned int reads - The resources the action reads
+	Param		unsigned int writes - The resources the action changes
+	Param		const std::function<void()>& action - The node's work
+	Param		unsigned int flags - NodeFlags
+	Return		Node - The node, numbered in the order they were added
+	Brief		Adds a node after the ones already in the graph. Every node is added
+				before any is started.
+*/
+TaskGraph::Node TaskGraph::addNode(const char* name, unsigned int reads, unsigned int writes,
+	const std::function<void()>& action, unsigned int flags)
+{
+	NodeInfo info;
+	info.name = name;
+	info.reads = reads;
+	info.writes = writes;
+	info.flags = flags;
+	info.action = action;
+	info.isStarted = false;
+
+	for (size_t i = 0; i < nodes_.size(); ++i)
+	{
+		if ((nodes_[i].writes & (reads | writes)) || (nodes_[i].reads & writes))
+			info.dependencies.push_back((Node)i);
+	}
+
+	nodes_.push_back(info);
+	return (Node)nodes_.size() - 1;
+}
+
+/*
+	Name		TaskGraph::start
+	Syntax		TaskGraph::start(Node node)
+	Param		Node node - The node to start
+	Brief		Starts the node, and any of its dependencies not yet started, without
+				waiting for it. A node run on the calling thread waits for its
+				dependencies and runs before start returns.
+*/
+void TaskGraph::start(Node node)
+{
+	NodeInfo& info = nodes_[node];
+	if (info.isStarted)
+		return;
+
+	std::vector<WorkerPool::JobHandle> dependencies;
+	for (size_t i = 0; i < info.dependencies.size(); ++i)
+	{
+		start(info.dependencies[i]);
+		dependencies.push_back(nodes_[info.dependencies[i]].job);
+	}
+
+	info.isStarted = true;
+	if (!pool_)
+	{
+		if (!isCancelled_)
+			info.action();
+	}
+	else if (info.flags & NODE_CALLER_THREAD)
+	{
+		for (size_t i = 0; i < dependencies.size(); ++i)
+		{
+			pool_->wait(dependencies[i]);
+		}
+		if (!isCancelled_)
+			info.action();
+	}
+	else
+	{
+		std::function<void()> action = info.action;
+		std::atomic<bool>* isCancelled = &isCancelled_;
+		info.job = pool_->submit([action, isCancelled]
+		{
+			if (!*isCancelled)
+				action();
+		}, dependencies);
+	}
+}
+
+/*
+	Name		TaskGraph::run
+	Syntax		TaskGraph::run(Node node)
+	Param		Node node - The node to run
+	Brief		Starts the node and returns once it has finished. Nodes it does not
+				depend on are left alone.
+*/
+void TaskGraph::run(Node node)
+{
+	start(node);
+	if (pool_)
+		pool_->wait(nodes_[node].job);
+}
+
+/*
+	Name		TaskGraph::runAll
+	Syntax		TaskGraph::runAll()
+	Brief		Starts every node not yet started and returns once all have finished
+*/
+void TaskGraph::runAll()
+{
+	for (size_t i = 0; i < nodes_.size(); ++i)
+	{
+		start((Node)i);
+	}
+	wait();
+}
+
+/*
+	Name		TaskGraph::wait
+	Syntax		TaskGraph::wait()
+	Brief		Returns once every node started has finished
+*/
+void TaskGraph::wait()
+{
+	if (!pool_)
+		return;
+
+	for (size_t i = 0; i < nodes_.size(); ++i)
+	{
+		pool_->wait(nodes_[i].job);
+	}
+}
+
+/*
+	Name		TaskGraph::cancel
+	Syntax		TaskGraph::cancel()
+	Brief		Stops the nodes started from running their actions, without waiting.
+				Actions already running stop early only if they check getCancelled.
+*/
+void TaskGraph::cancel()
+{
+	isCancelled_ = true;
+}
+
+/*
+	Name		TaskGraph::rewind
+	Syntax		TaskGraph::rewind()
+	Brief		Waits for the nodes started, then marks every node as not started so
+				the graph can be run again
+*/
+void TaskGraph::rewind()
+{
+	wait();
+	isCancelled_ = false;
+
+	for (size_t i = 0; i < nodes_.size(); ++i)
+	{
+		nodes_[i].isStarted = false;
+		nodes_[i].job.reset();
+	}
+}
+
+/*
+	Name		TaskGraph::isIdle
+	Syntax		TaskGraph::isIdle()
+	Return		bool - True if every node started has finished
+*/
+bool TaskGraph::isIdle() const
+{
+	for (size_t i = 0; i < nodes_.size(); ++i)
+	{
+		if (!WorkerPool::isFinished(nodes_[i].job))
+			return false;
+	}
+	return true;
+}
+
+/*
+	Name		TaskGraph::isFinished
+	Syntax		TaskGraph::isFinished(Node node)
+	Param		Node node - A node
+	Return		bool - True once the node has been started and has finished
+*/
+bool TaskGraph::isFinished(Node node) const
+{
+	return nodes_[node].isStarted && WorkerPool::isFinished(nodes_[node].job);
+}
@@ -0,0 +1,83 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Task Graph
+	Brief		Declaration of TaskGraph Class, a fixed set of nodes run as jobs on a
+				WorkerPool. Each node declares the resources it reads and writes as
+				bits. It depends on every node added before it that writes something
+				it uses, or reads something it writes, so nodes with nothing in
+				common run at the same time and the rest run in the order they were
+				added. A node's results are the same whatever ran beside it.
+*/
+
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "Utilities/WorkerPool.hpp"
+
+class TaskGraph
+{
+public:
+	typedef int Node;
+
+	enum NodeFlags
+	{
+		NODE_CALLER_THREAD = 1		// Runs on the thread that starts it, not a worker
+	};
+
+	explicit TaskGraph(WorkerPool* pool = 0);
+	~TaskGraph();
+
+	Node addNode(const char* name, unsigned int reads, unsigned int writes,
+				 const std::function<void()>& action, unsigned int flags = 0);
+
+	void start(Node node);
+	void run(Node node);
+	void runAll();
+	void wait();
+	void cancel();
+	void rewind();
+	bool isIdle() const;
+	const std::atomic<bool>& getCancelled() const { return isCancelled_; };
+
+	WorkerPool* getPool() const { return pool_; };
+	int getNumNodes() const { return (int)nodes_.size(); };
+	const char* getName(Node node) const { return nodes_[node].name; };
+	const std::vector<Node>& getDependencies(Node node) const { return nodes_[node].dependencies; };
+	bool isStarted(Node node) const { return nodes_[node].isStarted; };
+	bool isFinished(Node node) const;
+
+private:
+	TaskGraph(const TaskGraph&);
+	TaskGraph& operator=(const TaskGraph&);
+
+	/*
+		Name		NodeInfo
+		Brief		A node and, once started, the job running it. Nodes run on the
+					calling thread have no job.
+	*/
+	struct NodeInfo
+	{
+		const char* name;
+		unsigned int reads;
+		unsigned int writes;
+		unsigned int flags;
+		std::function<void()> action;
+		std::vector<Node> dependencies;
+
+		bool isStarted;
+		WorkerPool::JobHandle job;
+	};
+
+	WorkerPool* pool_;
+	std::vector<NodeInfo> nodes_;
+	std::atomic<bool> isCancelled_;
+};
+
+#endif // TASKGRAPH_H
@@ -0,0 +1,248 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Vertex Cache
+	Brief		Definition of the vertex cache functions. The optimiser is Tom Forsyth's
+				linear-speed vertex cache optimisation: each vertex is scored by its
+				position in a modelled LRU cache and how few triangles still use it,
+				and the next triangle is the highest scoring one using a cached vertex.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Utilities/VertexCache.hpp"
+
+namespace
+{
+	const float CACHE_DECAY_POWER = 1.5f;
+	const float LAST_TRIANGLE_SCORE = 0.75f;
+	const float VALENCE_BOOST_SCALE = 2.0f;
+	const float VALENCE_BOOST_POWER = 0.5f;
+
+	/*
+		Name		remap
+		Syntax		remap(const unsigned int* indices, int indexCount, std::vector<int>& local)
+		Param		const unsigned int* indices - An index list
+		Param		int indexCount - The number of indices in the list
+		Param		std::vector<int>& local - Receives each index numbered from 0 in order
+					of value, so sparse lists only need per vertex data for the
+					vertices they use
+		Return		int - The number of distinct vertices in the list
+	*/
+	int remap(const unsigned int* indices, int indexCount, std::vector<int>& local)
+	{
+		std::vector<unsigned int> vertices(indices, indices + indexCount);
+		std::sort(vertices.begin(), vertices.end());
+		vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+		local.resize(indexCount);
+		for (int i = 0; i < indexCount; ++i)
+		{
+			local[i] = (int)(std::lower_bound(vertices.begin(), vertices.end(), indices[i]) - vertices.begin());
+		}
+		return (int)vertices.size();
+	}
+
+	float vertexScore(int cachePosition, int remaining)
+	{
+		// No triangles left to draw, so never worth choosing
+		if (remaining == 0)
+			return -1.0f;
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			// The last triangle's vertices score less so it is not drawn again
+			// with a strip-like order that wastes the rest of the cache
+			if (cachePosition < 3)
+			{
+				score = LAST_TRIANGLE_SCORE;
+			}
+			else
+			{
+				float scale = 1.0f / (VertexCache::MODEL_CACHE_SIZE - 3);
+				score = powf(1.0f - (cachePosition - 3) * scale, CACHE_DECAY_POWER);
+			}
+		}
+
+		// Favour vertices with few triangles left so they are finished off
+		score += VALENCE_BOOST_SCALE * powf((float)remaining, -VALENCE_BOOST_POWER);
+		return score;
+	}
+}
+
+/*
+	Name		VertexCache::optimise
+	Syntax		VertexCache::optimise(unsigned int* indices, int indexCount)
+	Param		unsigned int* indices - A triangle list, reordered in place
+	Param		int indexCount - The number of indices in the list
+	Brief		Reorders the triangles for the post-transform vertex cache. Each
+				triangle keeps its winding.
+*/
+void VertexCache::optimise(unsigned int* indices, int indexCount)
+{
+	int triangleCount = indexCount / 3;
+	if (triangleCount < 2)
+		return;
+
+	std::vector<int> local;
+	int vertexCount = remap(indices, indexCount, local);
+
+	// The triangles each vertex is in, the first remaining[v] of them not drawn yet
+	std::vector<int> remaining(vertexCount, 0);
+	for (int i = 0; i < indexCount; ++i)
+	{
+		++remaining[local[i]];
+	}
+	std::vector<int> firstTriangle(vertexCount + 1, 0);
+	for (int v = 0; v < vertexCount; ++v)
+	{
+		firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+	}
+	std::vector<int> vertexTriangles(indexCount);
+	std::vector<int> filled(firstTriangle.begin(), firstTriangle.end() - 1);
+	for (int i = 0; i < indexCount; ++i)
+	{
+		vertexTriangles[filled[local[i]]++] = i / 3;
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (int v = 0; v < vertexCount; ++v)
+	{
+		vertexScores[v] = vertexScore(-1, remaining[v]);
+	}
+
+	std::vector<float> triangleScores(triangleCount);
+	std::vector<char> isDrawn(triangleCount, 0);
+	for (int t = 0; t < triangleCount; ++t)
+	{
+		triangleScores[t] = vertexScores[local[t * 3]] + vertexScores[local[t * 3 + 1]] + vertexScores[local[t * 3 + 2]];
+	}
+
+	std::vector<unsigned int> ordered(indexCount);
+	std::vector<int> cache;
+	std::vector<int> newCache;
+	cache.reserve(MODEL_CACHE_SIZE + 3);
+	newCache.reserve(MODEL_CACHE_SIZE + 3);
+
+	int best = (int)(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+	int scan = 0;
+
+	for (int drawn = 0; drawn < triangleCount; ++drawn)
+	{
+		// Nothing in the cache is worth drawing, so take the next triangle not drawn
+		if (best < 0)
+		{
+			while (isDrawn[scan])
+			{
+				++scan;
+			}
+			best = scan;
+		}
+
+		isDrawn[best] = 1;
+		for (int k = 0; k < 3; ++k)
+		{
+			ordered[drawn * 3 + k] = indices[best * 3 + k];
+
+			// Move the triangle past the vertex's remaining ones
+			int v = local[best * 3 + k];
+			int* triangles = &vertexTriangles[firstTriangle[v]];
+			int* last = triangles + remaining[v] - 1;
+			*std::find(triangles, last + 1, best) = *last;
+			*last = best;
+			--remaining[v];
+		}
+
+		// The triangle's vertices go to the front of the cache
+		newCache.clear();
+		for (int k = 0; k < 3; ++k)
+		{
+			newCache.push_back(local[best * 3 + k]);
+		}
+		for (size_t c = 0; c < cache.size(); ++c)
+		{
+			if (std::find(newCache.begin(), newCache.begin() + 3, cache[c]) == newCache.begin() + 3)
+				newCache.push_back(cache[c]);
+		}
+
+		// Vertices pushed out of the cache
+		for (size_t c = MODEL_CACHE_SIZE; c < newCache.size(); ++c)
+		{
+			cachePosition[newCache[c]] = -1;
+			vertexScores[newCache[c]] = vertexScore(-1, remaining[newCache[c]]);
+		}
+		if (newCache.size() > (size_t)MODEL_CACHE_SIZE)
+			newCache.resize(MODEL_CACHE_SIZE);
+
+		for (size_t c = 0; c < newCache.size(); ++c)
+		{
+			cachePosition[newCache[c]] = (int)c;
+			vertexScores[newCache[c]] = vertexScore((int)c, remaining[newCache[c]]);
+		}
+
+		// Rescore the triangles left on the cached vertices and pick the best
+		best = -1;
+		float bestScore = -1.0f;
+		for (size_t c = 0; c < newCache.size(); ++c)
+		{
+			int v = newCache[c];
+			for (int n = 0; n < remaining[v]; ++n)
+			{
+				int t = vertexTriangles[firstTriangle[v] + n];
+				float score = vertexScores[local[t * 3]] + vertexScores[local[t * 3 + 1]] + vertexScores[local[t * 3 + 2]];
+				triangleScores[t] = score;
+				if (score > bestScore)
+				{
+					bestScore = score;
+					best = t;
+				}
+			}
+		}
+
+		cache.swap(newCache);
+	}
+
+	std::copy(ordered.begin(), ordered.end(), indices);
+}
+
+/*
+	Name		VertexCache::measure
+	Syntax		VertexCache::measure(const unsigned int* indices, int indexCount, int cacheSize)
+	Param		const unsigned int* indices - A triangle list
+	Param		int indexCount - The number of indices in the list
+	Param		int cacheSize - Entries in the FIFO cache to simulate
+	Return		CacheStats - How many vertices the list transforms
+*/
+VertexCache::CacheStats VertexCache::measure(const unsigned int* indices, int indexCount, int cacheSize)
+{
+	std::vector<int> local;
+	int vertexCount = remap(indices, indexCount, local);
+
+	// The miss count when each vertex last entered the cache. A FIFO vertex is
+	// still cached until cacheSize more misses have pushed it out.
+	std::vector<int> entered(vertexCount, -1);
+
+	CacheStats stats;
+	stats.triangles = indexCount / 3;
+	stats.vertices = vertexCount;
+	stats.misses = 0;
+	for (int i = 0; i < indexCount; ++i)
+	{
+		int v = local[i];
+		if (entered[v] < 0 || stats.misses - entered[v] >= cacheSize)
+		{
+			entered[v] = stats.misses;
+			++stats.misses;
+		}
+	}
+
+	stats.acmr = stats.triangles > 0 ? (float)stats.misses / stats.triangles : 0.0f;
+	stats.atvr = stats.vertices > 0 ? (float)stats.misses / stats.vertices : 0.0f;
+	return stats;
+}
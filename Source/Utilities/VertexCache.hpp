@@ -0,0 +1,40 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Vertex Cache
+	Brief		Declaration of the vertex cache functions, which reorder triangle lists
+				so the GPU's post-transform cache reuses more vertices and measure how
+				well a list uses the cache
+*/
+
+#ifndef VERTEXCACHE_H
+#define VERTEXCACHE_H
+
+namespace VertexCache
+{
+	// Entries of the cache the optimiser models, larger than the hardware's so
+	// the order suits any cache up to this size
+	const int MODEL_CACHE_SIZE = 32;
+
+	/*
+		Name		CacheStats
+		Brief		How a list uses a FIFO cache. ACMR is the vertices transformed per
+					triangle, 0.5 at best for a large grid and 3 at worst. ATVR is the
+					vertices transformed per vertex referenced, 1 at best.
+	*/
+	struct CacheStats
+	{
+		int triangles;
+		int vertices;
+		int misses;
+		float acmr;
+		float atvr;
+	};
+
+	void optimise(unsigned int* indices, int indexCount);
+	CacheStats measure(const unsigned int* indices, int indexCount, int cacheSize);
+};
+
+#endif // VERTEXCACHE_H
@@ -0,0 +1,418 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Worker Pool
+	Brief		Definition of WorkerPool Class
+*/
+
+#include "Utilities/WorkerPool.hpp"
+
+namespace
+{
+	// The pool a worker thread belongs to and the queue it owns
+	thread_local const WorkerPool* workerPool = 0;
+	thread_local int workerQueue = 0;
+
+	/*
+		Name		ParallelLoop
+		Brief		The state of one parallelFor, shared with its helper jobs so a
+					helper that only starts after the loop has returned still has
+					something to look at
+	*/
+	struct ParallelLoop
+	{
+		const std::function<void(int)>* task;	// Only used while chunks are left
+		int count;
+		int grain;
+		int chunks;
+		std::atomic<int> next;
+
+		std::mutex mutex;						// Guards finished
+		std::condition_variable done;
+		int finished;
+	};
+
+	/*
+		Name		runChunks
+		Syntax		runChunks(ParallelLoop& loop)
+		Param		ParallelLoop& loop - The loop to work on
+		Brief		Claims and runs chunks until there are none left, then counts
+					them as finished. The thread finishing the last chunk wakes the
+					loop's caller.
+	*/
+	void runChunks(ParallelLoop& loop)
+	{
+		int completed = 0;
+		for (int chunk = loop.next.fetch_add(1); chunk < loop.chunks; chunk = loop.next.fetch_add(1))
+		{
+			int end = (chunk + 1) * loop.grain < loop.count ? (chunk + 1) * loop.grain : loop.count;
+			for (int i = chunk * loop.grain; i < end; ++i)
+			{
+				(*loop.task)(i);
+			}
+			++completed;
+		}
+
+		if (completed == 0)
+			return;
+
+		std::lock_guard<std::mutex> lock(loop.mutex);
+		loop.finished += completed;
+		if (loop.finished == loop.chunks)
+			loop.done.notify_all();
+	}
+}
+
+/*
+	Name		WorkerPool::WorkerPool
+	Syntax		WorkerPool(int workers)
+	Param		int workers - Number of threads to start, the caller is an extra one.
+				-1 uses one less than the number of hardware threads.
+	Brief		Starts the worker threads, which sleep until given jobs
+*/
+WorkerPool::WorkerPool(int workers)
+: queued_(0), waiting_(0), quit_(false)
+{
+	if (workers < 0)
+	{
+		int hardware = (int)std::thread::hardware_concurrency();
+		workers = (hardware > 1) ? hardware - 1 : 0;
+	}
+
+	for (int i = 0; i <= workers; ++i)
+	{
+		queues_.push_back(std::unique_ptr<Queue>(new Queue));
+	}
+
+	for (int i = 0; i < workers; ++i)
+	{
+		threads_.push_back(std::thread(&WorkerPool::workerMain, this, i + 1));
+	}
+}
+
+/*
+	Name		WorkerPool::~WorkerPool
+	Syntax		~WorkerPool()
+	Brief		Wakes and joins the worker threads. Jobs still queued are not run.
+*/
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex_);
+		quit_ = true;
+	}
+	wake_.notify_all();
+
+	for (size_t i = 0; i < threads_.size(); ++i)
+	{
+		threads_[i].join();
+	}
+}
+
+/*
+	Name		WorkerPool::instance
+	Syntax		WorkerPool::instance()
+	Brief		The pool shared by the engine, created on first use
+*/
+WorkerPool* WorkerPool::instance()
+{
+	static WorkerPool pool;
+	return &pool;
+}
+
+/*
+	Name		WorkerPool::parallelFor
+	Syntax		WorkerPool::parallelFor(int count, const std::function<void(int)>& task)
+	Param		int count - The number of iterations
+	Param		const std::function<void(int)>& task - Called once with each index in [0, count)
+	Brief		Runs the iterations one at a time across the pool, see below
+*/
+void WorkerPool::parallelFor(int count, const std::function<void(int)>& task)
+{
+	parallelFor(count, 1, task);
+}
+
+/*
+	Name		WorkerPool::parallelFor
+	Syntax		WorkerPool::parallelFor(int count, int grain, const std::function<void(int)>& task)
+	Param		int count - The number of iterations
+	Param		int grain - The number of consecutive iterations claimed at once, enough
+				that claiming them costs little beside running them
+	Param		const std::function<void(int)>& task - Called once with each index in [0, count)
+	Brief		Runs the iterations across the workers and the calling thread, returning
+				once all have finished. Iterations are claimed in index order but may
+				complete in any order, so each must only write its own output. Loops
+				may be nested, the inner loop is shared with any idle workers. The
+				calling thread only ever runs this loop's iterations, so a frame
+				calling it is not held up by whatever else is queued.
+*/
+void WorkerPool::parallelFor(int count, int grain, const std::function<void(int)>& task)
+{
+	if (count <= 0)
+		return;
+	if (grain < 1)
+		grain = 1;
+
+	int chunks = (count + grain - 1) / grain;
+	if (threads_.empty() || chunks == 1)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			task(i);
+		}
+		return;
+	}
+
+	// Helpers and the caller claim chunks until there are none left, so a
+	// helper that starts late just finds nothing to do
+	std::shared_ptr<ParallelLoop> loop(new ParallelLoop);
+	loop->task = &task;
+	loop->count = count;
+	loop->grain = grain;
+	loop->chunks = chunks;
+	loop->next = 0;
+	loop->finished = 0;
+
+	int helperCount = chunks - 1 < (int)threads_.size() ? chunks - 1 : (int)threads_.size();
+	for (int i = 0; i < helperCount; ++i)
+	{
+		submit([loop]() { runChunks(*loop); });
+	}
+
+	runChunks(*loop);
+
+	// Sleep until the helpers finish the chunks they claimed rather than running
+	// other jobs, which could be long and unrelated to this loop
+	std::unique_lock<std::mutex> lock(loop->mutex);
+	loop->done.wait(lock, [&loop] { return loop->finished == loop->chunks; });
+}
+
+/*
+	Name		WorkerPool::submit
+	Syntax		WorkerPool::submit(const std::function<void()>& task)
+	Param		const std::function<void()>& task - The work to run
+	Return		JobHandle - The job, to wait on or to make other jobs depend on
+	Brief		Queues a job. With no workers it runs before submit returns.
+*/
+WorkerPool::JobHandle WorkerPool::submit(const std::function<void()>& task)
+{
+	return submit(task, std::vector<JobHandle>());
+}
+
+/*
+	Name		WorkerPool::submit
+	Syntax		WorkerPool::submit(const std::function<void()>& task,
+								   const std::vector<JobHandle>& dependencies)
+	Param		const std::function<void()>& task - The work to run
+	Param		const std::vector<JobHandle>& dependencies - Jobs that must finish first
+	Return		JobHandle - The job, to wait on or to make other jobs depend on
+	Brief		Queues a job to run once all its dependencies have finished. The job
+				that finishes last queues it.
+*/
+WorkerPool::JobHandle WorkerPool::submit(const std::function<void()>& task, const std::vector<JobHandle>& dependencies)
+{
+	JobHandle job(new Job);
+	job->task = task;
+	job->unfinished = 1;
+	job->finished = false;
+
+	for (size_t i = 0; i < dependencies.size(); ++i)
+	{
+		Job* dependency = dependencies[i].get();
+		if (!dependency)
+			continue;
+
+		std::lock_guard<std::mutex> lock(dependency->mutex);
+		if (!dependency->finished)
+		{
+			dependency->continuations.push_back(job);
+			++job->unfinished;
+		}
+	}
+
+	if (--job->unfinished == 0)
+		push(job);
+
+	return job;
+}
+
+/*
+	Name		WorkerPool::wait
+	Syntax		WorkerPool::wait(const JobHandle& job)
+	Param		const JobHandle& job - The job to wait for
+	Brief		Runs queued jobs until the job has finished, only sleeping when there
+				are none
+*/
+void WorkerPool::wait(const JobHandle& job)
+{
+	if (!job)
+		return;
+
+	while (!job->finished)
+	{
+		if (runOne())
+			continue;
+
+		std::unique_lock<std::mutex> lock(sleepMutex_);
+		++waiting_;
+		finished_.wait(lock, [this, &job] { return job->finished || queued_ > 0; });
+		--waiting_;
+	}
+}
+
+/*
+	Name		WorkerPool::isFinished
+	Syntax		WorkerPool::isFinished(const JobHandle& job)
+	Param		const JobHandle& job - A job
+	Return		bool - True once the job has run, or if there is no job
+*/
+bool WorkerPool::isFinished(const JobHandle& job)
+{
+	return !job || job->finished;
+}
+
+/*
+	Name		WorkerPool::workerMain
+	Syntax		WorkerPool::workerMain(int queue)
+	Param		int queue - The queue the worker owns
+	Brief		Worker thread loop, runs jobs and sleeps while there are none
+*/
+void WorkerPool::workerMain(int queue)
+{
+	workerPool = this;
+	workerQueue = queue;
+
+	for (;;)
+	{
+		if (runOne())
+			continue;
+
+		std::unique_lock<std::mutex> lock(sleepMutex_);
+		wake_.wait(lock, [this] { return quit_ || queued_ > 0; });
+		if (quit_)
+			return;
+	}
+}
+
+/*
+	Name		WorkerPool::getQueue
+	Syntax		WorkerPool::getQueue()
+	Return		int - The queue the calling thread pushes to and works from first
+*/
+int WorkerPool::getQueue() const
+{
+	return workerPool == this ? workerQueue : 0;
+}
+
+/*
+	Name		WorkerPool::push
+	Syntax		WorkerPool::push(const JobHandle& job)
+	Param		const JobHandle& job - A job with no unfinished dependencies
+	Brief		Queues the job on the calling thread's queue and wakes a worker
+*/
+void WorkerPool::push(const JobHandle& job)
+{
+	// Nothing else would run it
+	if (threads_.empty())
+	{
+		execute(job);
+		return;
+	}
+
+	Queue& queue = *queues_[getQueue()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+	++queued_;
+
+	std::lock_guard<std::mutex> lock(sleepMutex_);
+	wake_.notify_one();
+	if (waiting_ > 0)
+		finished_.notify_all();
+}
+
+/*
+	Name		WorkerPool::pop
+	Syntax		WorkerPool::pop()
+	Return		JobHandle - The newest job on the calling thread's queue, else the
+				oldest on another's, else none
+*/
+WorkerPool::JobHandle WorkerPool::pop()
+{
+	JobHandle job;
+	if (queued_ <= 0)
+		return job;
+
+	int own = getQueue();
+	int count = (int)queues_.size();
+	for (int i = 0; i < count; ++i)
+	{
+		Queue& queue = *queues_[(own + i) % count];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty())
+			continue;
+
+		if (i == 0)
+		{
+			job = queue.jobs.back();
+			queue.jobs.pop_back();
+		}
+		else
+		{
+			job = queue.jobs.front();
+			queue.jobs.pop_front();
+		}
+		--queued_;
+		break;
+	}
+	return job;
+}
+
+/*
+	Name		WorkerPool::runOne
+	Syntax		WorkerPool::runOne()
+	Return		bool - False if there was no job to run
+*/
+bool WorkerPool::runOne()
+{
+	JobHandle job = pop();
+	if (!job)
+		return false;
+
+	execute(job);
+	return true;
+}
+
+/*
+	Name		WorkerPool::execute
+	Syntax		WorkerPool::execute(const JobHandle& job)
+	Param		const JobHandle& job - A job with no unfinished dependencies
+	Brief		Runs the job, then queues the jobs only it was holding back
+*/
+void WorkerPool::execute(const JobHandle& job)
+{
+	job->task();
+	job->task = std::function<void()>();
+
+	std::vector<JobHandle> continuations;
+	{
+		std::lock_guard<std::mutex> lock(job->mutex);
+		job->finished = true;
+		continuations.swap(job->continuations);
+	}
+
+	for (size_t i = 0; i < continuations.size(); ++i)
+	{
+		if (--continuations[i]->unfinished == 0)
+			push(continuations[i]);
+	}
+
+	if (waiting_ > 0)
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex_);
+		finished_.notify_all();
+	}
+}
@@ -0,0 +1,100 @@
+/*
+	Created 	Elinor Townsend 2012
+*/
+
+/*
+	Name		Worker Pool
+	Brief		Declaration of WorkerPool Class, the work-stealing job system the engine
+				shares. Each worker thread has its own deque of jobs, running the
+				newest of its own and stealing the oldest of the others' when it runs
+				out. Threads outside the pool share one more deque. A thread waiting
+				on a job runs jobs until it finishes, so the calling thread joins in
+				and jobs may wait on jobs without deadlocking. parallelFor is the
+				exception, its caller runs only the loop's own iterations.
+*/
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool
+{
+public:
+	struct Job;
+	typedef std::shared_ptr<Job> JobHandle;
+
+	explicit WorkerPool(int workers = -1);
+	~WorkerPool();
+
+	static WorkerPool* instance();
+
+	int getNumThreads() const { return (int)threads_.size() + 1; };
+
+	void parallelFor(int count, const std::function<void(int)>& task);
+	void parallelFor(int count, int grain, const std::function<void(int)>& task);
+
+	JobHandle submit(const std::function<void()>& task);
+	JobHandle submit(const std::function<void()>& task, const std::vector<JobHandle>& dependencies);
+	void wait(const JobHandle& job);
+	static bool isFinished(const JobHandle& job);
+
+	/*
+		Name		Job
+		Brief		A task and the jobs waiting for it. A job is queued once every job
+					it depends on has finished.
+	*/
+	struct Job
+	{
+		std::function<void()> task;
+		std::atomic<int> unfinished;		// Dependencies still running, +1 while submitting
+		std::atomic<bool> finished;
+
+		std::mutex mutex;					// Guards continuations against finishing
+		std::vector<JobHandle> continuations;
+	};
+
+private:
+	WorkerPool(const WorkerPool&);
+	WorkerPool& operator=(const WorkerPool&);
+
+	/*
+		Name		Queue
+		Brief		A deque of ready jobs. The owner works from the back, thieves
+					from the front.
+	*/
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<JobHandle> jobs;
+	};
+
+	void workerMain(int queue);
+	int getQueue() const;
+	void push(const JobHandle& job);
+	JobHandle pop();
+	bool runOne();
+	void execute(const JobHandle& job);
+
+	std::vector<std::thread> threads_;
+
+	// queues_[0] is shared by threads outside the pool, worker i owns queues_[i + 1]
+	std::vector<std::unique_ptr<Queue> > queues_;
+	std::atomic<int> queued_;
+
+	// Sleeping workers wait on wake_, threads in wait on finished_
+	std::mutex sleepMutex_;
+	std::condition_variable wake_;
+	std::condition_variable finished_;
+	std::atomic<int> waiting_;
+	bool quit_;
+};
+
+#endif // WORKERPOOL_H